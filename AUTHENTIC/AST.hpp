@@ -75,10 +75,16 @@ struct LoopStmt : Stmt {
 struct FunctionDecl : Stmt { 
     std::string name; 
     std::string params;
+    std::vector<std::string> paramNames;
+    // C++ types filled in by TypeInference; "" leaves a parameter generic
+    // and the return type deduced
+    std::vector<std::string> paramTypes;
+    std::string returnType;
     NodePtr body; 
     void print(int d = 0) const override {
         indent(d); std::cout << "FunctionDecl: " << name;
         if (!params.empty()) std::cout << " (" << params << ")";
+        if (!returnType.empty()) std::cout << " -> " << returnType;
         std::cout << "\n";
         body->print(d + 1);
     }
@@ -125,6 +131,16 @@ struct BinaryExpr : Expr {
     }
 };
 
+// -x, !x (logical not) and ~x (bitwise not)
+struct UnaryExpr : Expr {
+    NodePtr operand;
+    std::string op;
+    void print(int d = 0) const override {
+        indent(d); std::cout << "UnaryExpr " << op << "\n";
+        operand->print(d + 1);
+    }
+};
+
 struct VarDecl : Stmt {
     std::string name, type;
     NodePtr initializer;
@@ -288,6 +304,13 @@ struct ReadStmt : Stmt {
     }
 };
 
+struct FlushStmt : Stmt {
+    std::string handle;  // Empty = standard output
+    void print(int d = 0) const override {
+        indent(d); std::cout << "FlushStmt: " << (handle.empty() ? "stdout" : handle) << "\n";
+    }
+};
+
 struct CloseStmt : Stmt {
     std::string handle;
     void print(int d = 0) const override {
@@ -298,6 +321,7 @@ struct CloseStmt : Stmt {
 struct InputStmt : Stmt {
     std::string prompt;
     std::string varName;
+    std::string type; // C++ type of a variable this statement declares
     void print(int d = 0) const override {
         indent(d); std::cout << "InputStmt: " << varName << " (prompt: \"" << prompt << "\")\n";
     }
@@ -307,8 +331,11 @@ struct InputStmt : Stmt {
 struct SerializeStmt : Stmt {
     NodePtr data;
     std::string format;
+    std::string target;      // Optional: variable receiving the encoded bytes
     void print(int d = 0) const override {
-        indent(d); std::cout << "SerializeStmt: format=" << format << "\n";
+        indent(d); std::cout << "SerializeStmt: format=" << format;
+        if (!target.empty()) std::cout << " -> " << target;
+        std::cout << "\n";
         if (data) data->print(d + 1);
     }
 };
@@ -316,8 +343,12 @@ struct SerializeStmt : Stmt {
 struct DeserializeStmt : Stmt {
     NodePtr source;
     std::string format;
+    std::string targetType;  // Struct name to decode into
+    std::string target;
     void print(int d = 0) const override {
-        indent(d); std::cout << "DeserializeStmt: format=" << format << "\n";
+        indent(d); std::cout << "DeserializeStmt: format=" << format;
+        if (!target.empty()) std::cout << " -> " << targetType << " " << target;
+        std::cout << "\n";
         if (source) source->print(d + 1);
     }
 };
@@ -325,8 +356,11 @@ struct DeserializeStmt : Stmt {
 struct CompressStmt : Stmt {
     NodePtr data;
     std::string algorithm;
+    std::string target;  // New string variable, or a file handle from `open`
     void print(int d = 0) const override {
-        indent(d); std::cout << "CompressStmt: algorithm=" << algorithm << "\n";
+        indent(d); std::cout << "CompressStmt: algorithm=" << algorithm;
+        if (!target.empty()) std::cout << " -> " << target;
+        std::cout << "\n";
         if (data) data->print(d + 1);
     }
 };
@@ -334,8 +368,11 @@ struct CompressStmt : Stmt {
 struct DecompressStmt : Stmt {
     NodePtr data;
     std::string algorithm;
+    std::string target;  // New string variable, or a file handle from `open`
     void print(int d = 0) const override {
-        indent(d); std::cout << "DecompressStmt: algorithm=" << algorithm << "\n";
+        indent(d); std::cout << "DecompressStmt: algorithm=" << algorithm;
+        if (!target.empty()) std::cout << " -> " << target;
+        std::cout << "\n";
         if (data) data->print(d + 1);
     }
 };
@@ -692,6 +729,26 @@ struct StringCallExpr : Expr {
     }
 };
 
+// List literal: [1, 2, 3]
+struct ListExpr : Expr {
+    std::vector<NodePtr> elements;
+    // C++ element type filled in by TypeInference; "" lets the emitter deduce it
+    std::string elementType;
+    void print(int d = 0) const override {
+        indent(d); std::cout << "List (" << elements.size() << ")\n";
+        for (auto& element : elements) element->print(d + 1);
+    }
+};
+
+// Missing operand of an operator section: (* 2), (% 2 == 0), (+).
+// Slot 0 is the left operand, slot 1 the right one in (op).
+struct PlaceholderExpr : Expr {
+    int slot = 0;
+    void print(int d = 0) const override {
+        indent(d); std::cout << "Placeholder " << slot << "\n";
+    }
+};
+
 // STANDARD LIBRARY: Collection Functions
 struct CollectionCallExpr : Expr {
     std::string function; // "push", "pop", "shift", "unshift", "slice", "map", "filter", "reduce", "sort", "reverse"
@@ -12,15 +12,23 @@
 #include <unordered_map>
 #include <vector>
 #include <cctype>
+#include <cmath>
 #include <iomanip>
 #include <memory>
 #include <algorithm>
+#include <chrono>
+#include <csignal>
 #include <sstream>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
 
 // Modular imports
 #include "AST.hpp"
 #include "Parser.hpp"
 #include "CodeEmitter.hpp"
+#include "TypeInference.hpp"
+#include "ProcessRunner.hpp"
 #include "MachineCodeEmitter.hpp"
 #include "BinaryEmitter.hpp"
 
@@ -380,7 +388,7 @@ private:
 
     const std::unordered_set<std::string> keywords = {
         "Print","ret","loop","if","else","Fn","call","let","while","break","continue",
-        "switch","case","default","overlay","open","write","writeln","read","close",
+        "switch","case","default","overlay","open","write","writeln","read","flush","close",
         "mutate","scale","bounds","checkpoint","vbreak","channel","send","recv","sync",
         "schedule","input","true","false","struct","enum","union","typedef","const",
         "volatile","static","extern","inline","auto","void","int","float","double",
@@ -550,6 +558,14 @@ enum class CompilationMode {
     CIAM_AOT         // NEW: Direct machine code emission (no C++)
 };
 
+// How far the driver takes a program; running it is opt-in (--run)
+enum class BuildStage {
+    Emit,     // --emit-only: write the C++ (or the AOT binary) and stop
+    Compile,  // --compile-only: object files, no link
+    Link,     // --no-run (default): a finished executable
+    Run       // --run: execute it under ProcessLimits
+};
+
 struct PlatformInfo {
     Platform platform;
     ExecutableFormat format;
@@ -557,6 +573,7 @@ struct PlatformInfo {
     std::string standard;
     std::string extension;
     std::string linkerFlags;
+    std::string runtimeDir;  // Location of Runtime*.hpp for generated C++
     CompilationMode mode;
 };
 
@@ -596,6 +613,10 @@ static PlatformInfo detectPlatform() {
     info.linkerFlags = "";
     info.mode = CompilationMode::Legacy_CPP;
 #endif
+
+    // Generated C++ includes the runtime headers shipped next to the transpiler
+    const char* runtimeEnv = std::getenv("CASE_RUNTIME_DIR");
+    info.runtimeDir = (runtimeEnv && *runtimeEnv) ? runtimeEnv : ".";
     
     return info;
 }
@@ -618,6 +639,102 @@ static std::string getFormatName(ExecutableFormat format) {
     }
 }
 
+// -----------------------------------------------------------------------------
+// CHILD PROCESSES
+// -----------------------------------------------------------------------------
+
+// Compiler output is captured, not streamed; pass it on as the compiler wrote it
+static void printDiagnostics(const ProcessResult& result) {
+    std::cerr << result.output << result.errors;
+}
+
+// A program in the current directory, run without a PATH lookup
+static std::string localExecutable(const std::string& name) {
+#ifdef _WIN32
+    return name;
+#else
+    return name.find('/') == std::string::npos ? "./" + name : name;
+#endif
+}
+
+// Runs a compiled program on the terminal, under `limits`, and reports how
+// it ended
+static ProcessResult runProgram(const std::string& executable, const ProcessLimits& limits) {
+    std::cout << "\n\033[1;36m=== Running " << executable << " ===\033[0m\n\n";
+    std::cout.flush();  // the child writes to the same terminal
+    ProcessResult result = runLimited({localExecutable(executable)}, limits);
+    std::cout << "\n";
+    if (!result.started) {
+        std::cerr << "\033[1;31m❌ Cannot start " << executable << "\033[0m\n";
+    } else if (result.timedOut) {
+        std::cout << "\033[1;33m⚠️  Program stopped after " << limits.wallSeconds << " s (--time-limit)\033[0m\n";
+    } else if (result.ok()) {
+        std::cout << "\033[1;32m✅ Program executed successfully\033[0m\n";
+    } else if (result.signal == SIGXCPU || (limits.cpuSeconds > 0 && result.signal == SIGKILL &&
+                                            result.cpuSeconds() >= limits.cpuSeconds)) {
+        std::cout << "\033[1;33m⚠️  Program used up its " << limits.cpuSeconds << " s of CPU time\033[0m\n";
+    } else if (result.signal != 0) {
+        std::cout << "\033[1;33m⚠️  Program killed by signal " << result.signal << "\033[0m\n";
+    } else {
+        std::cout << "\033[1;33m⚠️  Program exited with code: " << result.exitCode << "\033[0m\n";
+    }
+    if (result.started) std::cout << "Run: " << describeRun(result) << "\n";
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// RUNTIME PRECOMPILED HEADER (--pch)
+// -----------------------------------------------------------------------------
+
+// Build CaseRuntime.hpp into a precompiled header for this compiler and flag
+// set (a PCH is only valid for the flags it was built with), rebuilding it
+// when any runtime header is newer. Returns the flags that make a compile
+// pick it up, or "" to compile without it.
+static std::string ensureRuntimePch(const std::string& compiler, const std::string& flags,
+                                    const std::string& runtimeDir) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path header = fs::path(runtimeDir) / "CaseRuntime.hpp";
+    if (!fs::exists(header, ec)) return "";
+
+    bool clang = compiler.find("clang") != std::string::npos;
+    std::ostringstream key;
+    key << std::hex << std::hash<std::string>{}(compiler + " " + flags);
+    fs::path dir = fs::path(".case_pch") / key.str();
+    fs::path pch = dir / (clang ? "CaseRuntime.hpp.pch" : "CaseRuntime.hpp.gch");
+
+    bool stale = !fs::exists(pch, ec);
+    if (!stale) {
+        auto built = fs::last_write_time(pch, ec);
+        for (auto& entry : fs::directory_iterator(runtimeDir, ec)) {
+            std::string name = entry.path().filename().string();
+            bool runtimeHeader = entry.path().extension() == ".hpp" &&
+                (name.rfind("Runtime", 0) == 0 || name == "CaseRuntime.hpp");
+            if (runtimeHeader && entry.last_write_time(ec) > built) {
+                stale = true;
+                break;
+            }
+        }
+    }
+    if (stale) {
+        fs::create_directories(dir, ec);
+        CommandLine cmd{compiler};
+        appendFlags(cmd, flags);
+        cmd.insert(cmd.end(), {"-x", "c++-header", header.string(), "-o", pch.string()});
+        std::cout << "\033[1;36m[PCH]\033[0m " << formatCommand(cmd) << "\n";
+        ProcessResult built = runProcess(cmd);
+        printDiagnostics(built);
+        if (!built.ok()) {
+            fs::remove(pch, ec);
+            std::cerr << "\033[1;33m⚠️  Precompiled header build failed, compiling without it\033[0m\n";
+            return "";
+        }
+    }
+    // GCC looks for CaseRuntime.hpp.gch in each -I directory before the
+    // header itself, so the cache directory goes first on the include path
+    return clang ? "-include-pch " + pch.string() : "-I" + dir.string();
+}
+
 // -----------------------------------------------------------------------------
 // DIRECT NATIVE COMPILATION
 // -----------------------------------------------------------------------------
@@ -627,9 +744,139 @@ public:
     NativeCompiler() : platformInfo(detectPlatform()), ciamEnabled(false) {}
     
     void setCIAMEnabled(bool enabled) { ciamEnabled = enabled; }
+    void setPrecompiledRuntime(bool enabled) { precompiledRuntime = enabled; }
     void setCompilationMode(CompilationMode mode) { platformInfo.mode = mode; }
+    void setJobs(size_t count) { jobs = count; }
+    void setStage(BuildStage last) { stage = last; }
+    void setLinkTimeOptimization(bool enabled) { linkTimeOptimization = enabled; }
+    
+    // Wall time of the last compile and link, for the comparison report
+    double lastBuildSeconds() const { return buildSeconds; }
+    
+    // Writes the header and units to case_split/, compiles the units as
+    // concurrent child processes (at most setJobs() at a time) and links
+    // them once. With link-time optimization the link step still sees the
+    // whole program.
+    bool compileSplitToNative(SplitProgram& program, const std::string& outputName) {
+        namespace fs = std::filesystem;
+        auto start = std::chrono::steady_clock::now();
+        bool ciam = ciamEnabled;
+        std::cout << "\n\033[1;36m=== Split Native Compilation ===\033[0m\n";
+        std::cout << "Platform: " << getPlatformName(platformInfo.platform) << "\n";
+        
+        std::error_code ec;
+        fs::path dir = "case_split";
+        fs::create_directories(dir, ec);
+        if (!program.header.writeToFile((dir / "case_program.hpp").string())) {
+            std::cerr << "\033[1;31m❌ Cannot write " << (dir / "case_program.hpp").string() << "\033[0m\n";
+            return false;
+        }
+        
+        std::string flags = "-std=" + platformInfo.standard;
+        if (ciam) {
+            flags += " -O3 -march=native";
+            if (platformInfo.platform != Platform::Unknown) flags += " -ffast-math -funroll-loops";
+        } else {
+            flags += " -O2";
+        }
+        if (linkTimeOptimization) flags += " -flto";
+        std::string pchFlags = precompiledRuntime
+            ? ensureRuntimePch(platformInfo.compiler, flags, platformInfo.runtimeDir) : "";
+        
+        std::vector<CommandLine> compiles;
+        std::vector<std::string> objects;
+        for (size_t i = 0; i < program.units.size(); ++i) {
+            std::string unitName = "case_unit_" + std::to_string(i);
+            std::string source = (dir / (unitName + ".cpp")).string();
+            std::string object = (dir / (unitName + ".o")).string();
+            EmitBuffer file;
+            if (ciam) {
+                file << "// CIAM-Optimized Native Code\n";
+                file << "#pragma GCC optimize(\"O3\")\n";
+                file << "#pragma GCC optimize(\"unroll-loops\")\n";
+            }
+            file.append(std::move(program.units[i]));
+            if (!file.writeToFile(source)) {
+                std::cerr << "\033[1;31m❌ Cannot write " << source << "\033[0m\n";
+                return false;
+            }
+            CommandLine cmd{platformInfo.compiler};
+            appendFlags(cmd, flags);
+            appendFlags(cmd, pchFlags);
+            cmd.push_back("-I" + platformInfo.runtimeDir);
+            cmd.insert(cmd.end(), {"-c", source, "-o", object});
+            compiles.push_back(cmd);
+            objects.push_back(object);
+        }
+        if (stage == BuildStage::Emit) {
+            std::cout << "\033[1;32m✅ Wrote " << compiles.size() << " units to " << dir.string() << "\033[0m\n";
+            return true;
+        }
+        
+        std::cout << "Units: " << compiles.size() << ", jobs: " << jobs
+                  << (linkTimeOptimization ? ", link-time optimization" : "") << "\n";
+        auto compileStart = std::chrono::steady_clock::now();
+        std::vector<ProcessResult> results = runProcesses(compiles, jobs);
+        double compileWall = std::chrono::duration<double>(std::chrono::steady_clock::now() - compileStart).count();
+        double compileCpu = 0.0;
+        long peakKb = 0;
+        bool ok = true;
+        for (size_t i = 0; i < results.size(); ++i) {
+            compileCpu += results[i].cpuSeconds();
+            peakKb = std::max(peakKb, results[i].maxResidentKb);
+            printDiagnostics(results[i]);
+            std::cout << "  " << objects[i] << ": " << describeRun(results[i])
+                      << (results[i].ok() ? "" : "  FAILED") << "\n";
+            if (!results[i].ok()) {
+                ok = false;
+                std::cerr << "Command: " << formatCommand(compiles[i]) << "\n";
+            }
+        }
+        if (!ok) {
+            std::cerr << "\033[1;31m❌ Native compilation failed\033[0m\n";
+            return false;
+        }
+        if (stage == BuildStage::Compile) {
+            buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << std::fixed << std::setprecision(2) << "Compile: " << compileWall << " s wall, "
+                      << compileCpu << " s cpu over all units\n" << std::defaultfloat;
+            std::cout << "\033[1;32m✅ Object files in " << dir.string() << "\033[0m\n";
+            return true;
+        }
+        
+        std::string outputExe = outputName + (ciam ? "_ciam" : "") + platformInfo.extension;
+        CommandLine link{platformInfo.compiler};
+        appendFlags(link, flags);
+        link.insert(link.end(), objects.begin(), objects.end());
+        link.insert(link.end(), {"-o", outputExe});
+        appendFlags(link, platformInfo.linkerFlags);
+        if (platformInfo.platform == Platform::Windows) {
+            link.push_back("-Wl,--subsystem,console");
+        } else if (platformInfo.platform == Platform::Linux) {
+            link.push_back("-Wl,--strip-all");
+            if (ciam) link.insert(link.end(), {"-static-libgcc", "-static-libstdc++"});
+        } else if (platformInfo.platform == Platform::macOS) {
+            link.push_back("-Wl,-dead_strip");
+        }
+        ProcessResult linked = runProcess(link);
+        printDiagnostics(linked);
+        buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(2) << "Compile: " << compileWall << " s wall, " << compileCpu
+                  << " s cpu over all units, peak " << peakKb / 1024.0 << " MB per unit\n"
+                  << "Link: " << describeRun(linked) << "\n" << std::defaultfloat;
+        if (!linked.ok()) {
+            std::cerr << "Command: " << formatCommand(link) << "\n";
+            std::cerr << "\033[1;31m❌ Linking failed\033[0m\n";
+            return false;
+        }
+        std::cout << "\033[1;32m✅ Successfully compiled to " << outputExe << "\033[0m\n";
+        printBinaryInfo(outputExe);
+        return true;
+    }
     
- bool compileToNative(const std::string& cppSource, const std::string& outputName) {
+ // Takes the emitted program by reference and consumes it: its chunks are
+ // written to the .cpp file as they are, or spliced behind the CIAM header
+ bool compileToNative(EmitBuffer& cppSource, const std::string& outputName) {
         std::cout << "\n\033[1;36m=== Direct Native Compilation ===\033[0m\n";
         std::cout << "Platform: " << getPlatformName(platformInfo.platform) << "\n";
         std::cout << "Format: " << getFormatName(platformInfo.format) << "\n";
@@ -642,130 +889,151 @@ std::cout << "\033[1;35m[CIAM AOT]\033[0m Pure machine code emission (no C++ ste
       
         std::cout << "Compiler: " << platformInfo.compiler << "\n";
         
+        auto start = std::chrono::steady_clock::now();
+        bool ok;
    if (ciamEnabled) {
    std::cout << "\033[1;35m[CIAM Mode]\033[0m Direct C.A.S.E. to native machine code\n";
-            return compileCIAMDirectToNative(cppSource, outputName);
+            ok = compileCIAMDirectToNative(cppSource, outputName);
         } else {
-          return compileStandardToNative(cppSource, outputName);
+          ok = compileStandardToNative(cppSource, outputName);
         }
+        buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ok;
  }
     
 private:
     PlatformInfo platformInfo;
     bool ciamEnabled;
+    bool precompiledRuntime = false;
+    size_t jobs = 1;
+    BuildStage stage = BuildStage::Link;
+    bool linkTimeOptimization = false;
+    double buildSeconds = 0.0;
     
-    bool compileStandardToNative(const std::string& cppSource, const std::string& outputName) {
+    bool compileStandardToNative(EmitBuffer& cppSource, const std::string& outputName) {
   // Write C++ source to file
         std::string cppFile = "compiler.cpp";
-        std::ofstream out(cppFile);
-    out << cppSource;
-        out.close();
+        if (!cppSource.writeToFile(cppFile)) {
+            std::cerr << "\033[1;31m❌ Cannot write " << cppFile << "\033[0m\n";
+            return false;
+        }
+        if (stage == BuildStage::Emit) {
+            std::cout << "\033[1;32m✅ Wrote " << cppFile << "\033[0m\n";
+            return true;
+        }
         
-        // Build output executable name
-      std::string outputExe = outputName + platformInfo.extension;
+        // Build output executable name (an object file with --compile-only)
+      std::string outputExe = stage == BuildStage::Compile ? outputName + ".o" : outputName + platformInfo.extension;
         
   // Build compilation command
-      std::ostringstream cmd;
-        cmd << platformInfo.compiler << " "
-         << "-std=" << platformInfo.standard << " "
-            << "-O2 "
-    << cppFile << " "
-  << "-o " << outputExe;
+        std::string flags = "-std=" + platformInfo.standard + " -O2";
+        std::string pchFlags = precompiledRuntime
+            ? ensureRuntimePch(platformInfo.compiler, flags, platformInfo.runtimeDir) : "";
+      CommandLine cmd{platformInfo.compiler};
+        appendFlags(cmd, flags);
+        appendFlags(cmd, pchFlags);
+        cmd.push_back("-I" + platformInfo.runtimeDir);
+        if (stage == BuildStage::Compile) cmd.push_back("-c");
+        cmd.insert(cmd.end(), {cppFile, "-o", outputExe});
         
-        if (!platformInfo.linkerFlags.empty()) {
-            cmd << " " << platformInfo.linkerFlags;
-        }
-        
-  // Add platform-specific optimizations
-        if (platformInfo.platform == Platform::Windows) {
-    cmd << " -Wl,--subsystem,console";
-        } else if (platformInfo.platform == Platform::Linux) {
-   cmd << " -Wl,--strip-all";  // Strip symbols for smaller binary
-     } else if (platformInfo.platform == Platform::macOS) {
-        cmd << " -Wl,-dead_strip";  // Remove dead code
+  // Add platform-specific optimizations (link flags, so not for an object file)
+        if (stage != BuildStage::Compile) {
+            appendFlags(cmd, platformInfo.linkerFlags);
+            if (platformInfo.platform == Platform::Windows) {
+    cmd.push_back("-Wl,--subsystem,console");
+            } else if (platformInfo.platform == Platform::Linux) {
+   cmd.push_back("-Wl,--strip-all");  // Strip symbols for smaller binary
+            } else if (platformInfo.platform == Platform::macOS) {
+        cmd.push_back("-Wl,-dead_strip");  // Remove dead code
+            }
         }
-        
-        cmd << " 2>&1";
       
         std::cout << "\n\033[1;36m=== Compiling to Native Binary ===\033[0m\n";
-        std::cout << "Command: " << cmd.str() << "\n";
+        std::cout << "Command: " << formatCommand(cmd) << "\n";
         
         // Execute compilation
-        int result = system(cmd.str().c_str());
+        ProcessResult result = runProcess(cmd);
+        printDiagnostics(result);
      
-        if (result == 0) {
+        if (result.ok()) {
         std::cout << "\033[1;32m✅ Successfully compiled to " << outputExe << "\033[0m\n";
-            printBinaryInfo(outputExe);
+            if (stage != BuildStage::Compile) printBinaryInfo(outputExe);
+            std::cout << "Compiler: " << describeRun(result) << "\n";
    return true;
         } else {
- std::cerr << "\033[1;31m❌ Native compilation failed\033[0m\n";
+ std::cerr << "\033[1;31m❌ Native compilation failed\033[0m (" << describeRun(result) << ")\n";
        return false;
         }
     }
     
-    bool compileCIAMDirectToNative(const std::string& cppSource, const std::string& outputName) {
+    bool compileCIAMDirectToNative(EmitBuffer& cppSource, const std::string& outputName) {
         std::cout << "\n\033[1;35m=== CIAM Direct-to-Native Compilation ===\033[0m\n";
         std::cout << "Mode: Optimized direct compilation (bypassing intermediate steps)\n";
         
         // Write optimized C++ source
     std::string cppFile = "ciam_optimized.cpp";
-        std::ofstream out(cppFile);
+        EmitBuffer out;
 out << "// CIAM-Optimized Native Code\n";
         out << "#pragma GCC optimize(\"O3\")\n";
         out << "#pragma GCC optimize(\"unroll-loops\")\n";
-      out << cppSource;
-        out.close();
+      out.append(std::move(cppSource));
+        if (!out.writeToFile(cppFile)) {
+            std::cerr << "\033[1;31m❌ Cannot write " << cppFile << "\033[0m\n";
+            return false;
+        }
+        if (stage == BuildStage::Emit) {
+            std::cout << "\033[1;32m✅ Wrote " << cppFile << "\033[0m\n";
+            return true;
+        }
         
-        // Build output executable name
-        std::string outputExe = outputName + "_ciam" + platformInfo.extension;
+        // Build output executable name (an object file with --compile-only)
+        std::string outputExe = outputName + "_ciam" +
+            (stage == BuildStage::Compile ? std::string(".o") : platformInfo.extension);
         
         // Build aggressive optimization command
-        std::ostringstream cmd;
-        cmd << platformInfo.compiler << " "
-            << "-std=" << platformInfo.standard << " "
-            << "-O3 "         // Maximum optimization
- << "-march=native " // Optimize for current CPU
-            << "-flto ";        // Link-time optimization
+        std::string flags = "-std=" + platformInfo.standard
+            + " -O3"            // Maximum optimization
+            + " -march=native"  // Optimize for current CPU
+            + " -flto";         // Link-time optimization
+        if (platformInfo.platform != Platform::Unknown) {
+            flags += " -ffast-math -funroll-loops";
+        }
+        CommandLine cmd{platformInfo.compiler};
+        appendFlags(cmd, flags);
         
         // Platform-specific aggressive optimizations
-  if (platformInfo.platform == Platform::Windows) {
-    cmd << "-ffast-math "
-     << "-funroll-loops "
-     << "-Wl,--subsystem,console ";
+  if (stage == BuildStage::Compile) {
+            cmd.push_back("-c");
+  } else if (platformInfo.platform == Platform::Windows) {
+    cmd.push_back("-Wl,--subsystem,console");
   } else if (platformInfo.platform == Platform::Linux) {
-            cmd << "-ffast-math "
-    << "-funroll-loops "
-        << "-Wl,--strip-all "
-      << "-static-libgcc "
-       << "-static-libstdc++ ";
+            cmd.insert(cmd.end(), {"-Wl,--strip-all", "-static-libgcc", "-static-libstdc++"});
         } else if (platformInfo.platform == Platform::macOS) {
-            cmd << "-ffast-math "
-                << "-funroll-loops "
-   << "-Wl,-dead_strip ";
+            cmd.push_back("-Wl,-dead_strip");
         }
         
-   cmd << cppFile << " "
-  << "-o " << outputExe;
-        
-        if (!platformInfo.linkerFlags.empty()) {
-            cmd << " " << platformInfo.linkerFlags;
-     }
-        
-        cmd << " 2>&1";
+        if (precompiledRuntime) {
+            appendFlags(cmd, ensureRuntimePch(platformInfo.compiler, flags, platformInfo.runtimeDir));
+        }
+   cmd.push_back("-I" + platformInfo.runtimeDir);
+        cmd.insert(cmd.end(), {cppFile, "-o", outputExe});
+        if (stage != BuildStage::Compile) appendFlags(cmd, platformInfo.linkerFlags);
         
       std::cout << "CIAM Optimization: Maximum (O3 + LTO + CPU-specific)\n";
-        std::cout << "Command: " << cmd.str() << "\n";
+        std::cout << "Command: " << formatCommand(cmd) << "\n";
         
      // Execute compilation
-        int result = system(cmd.str().c_str());
+        ProcessResult result = runProcess(cmd);
+        printDiagnostics(result);
         
-        if (result == 0) {
+        if (result.ok()) {
          std::cout << "\033[1;35m✅ CIAM successfully compiled to " << outputExe << "\033[0m\n";
   std::cout << "\033[1;35m[CIAM]\033[0m Direct C.A.S.E. → Native machine code complete\n";
-            printBinaryInfo(outputExe);
+            if (stage != BuildStage::Compile) printBinaryInfo(outputExe);
+            std::cout << "Compiler: " << describeRun(result) << "\n";
             return true;
  } else {
-    std::cerr << "\033[1;31m❌ CIAM native compilation failed\033[0m\n";
+    std::cerr << "\033[1;31m❌ CIAM native compilation failed\033[0m (" << describeRun(result) << ")\n";
     return false;
      }
     }
@@ -807,27 +1075,44 @@ static std::string readFile(const std::string& path) {
     return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
 }
 
-static bool compileAndRunCpp(const std::string& cppFile, const std::string& outputExe) {
+static bool compileAndRunCpp(const std::string& cppFile, const std::string& outputExe, bool precompiledRuntime,
+                             BuildStage stage, const ProcessLimits& limits) {
+    if (stage == BuildStage::Emit) return true;
     std::cout << "\n\033[1;36m=== Compiling C++ ===\033[0m\n";
     
     // Build compile command with C++20
-  std::string compileCmd = "clang++ -std=c++20 -O2 " + cppFile + " -o " + outputExe;
-    std::cout << "Command: " << compileCmd << "\n";
+    std::string runtimeDir = detectPlatform().runtimeDir;
+    std::string flags = "-std=c++20 -O2";
+    std::string pchFlags = precompiledRuntime ? ensureRuntimePch("clang++", flags, runtimeDir) : "";
+  CommandLine compileCmd{"clang++"};
+    appendFlags(compileCmd, flags);
+    appendFlags(compileCmd, pchFlags);
+    compileCmd.push_back("-I" + runtimeDir);
+    if (stage == BuildStage::Compile) {
+        std::string object = cppFile.substr(0, cppFile.find_last_of('.')) + ".o";
+        compileCmd.insert(compileCmd.end(), {"-c", cppFile, "-o", object});
+    } else {
+        compileCmd.insert(compileCmd.end(), {cppFile, "-o", outputExe});
+    }
+    std::cout << "Command: " << formatCommand(compileCmd) << "\n";
     
     // Compile
-    int result = system(compileCmd.c_str());
+    ProcessResult result = runProcess(compileCmd);
+    printDiagnostics(result);
     
-    if (result == 0) {
-        std::cout << "\033[1;32m✅ Native binary created: " << outputExe << "\033[0m\n";
+    if (result.ok()) {
+        std::cout << "\033[1;32m✅ " << (stage == BuildStage::Compile ? "Object file" : "Native binary")
+                  << " created: " << compileCmd.back() << "\033[0m\n";
+        std::cout << "Compiler: " << describeRun(result) << "\n";
         
         // Execute
-   std::cout << "\n\033[1;36m=== Running " << outputExe << " ===\033[0m\n\n";
-        system(outputExe.c_str());
-        
-        std::cout << "\n\033[1;32m✅ Program executed\033[0m\n";
+        if (stage == BuildStage::Run) runProgram(outputExe, limits);
    return true;
-    } else {
+    } else if (!result.started) {
       std::cerr << "\033[1;31m❌ Compilation failed. Check clang++ availability.\033[0m\n";
+        return false;
+    } else {
+      std::cerr << "\033[1;31m❌ Compilation failed\033[0m (" << describeRun(result) << ")\n";
   std::cerr << "Check " << cppFile << " for syntax errors\n";
         return false;
     }
@@ -835,11 +1120,26 @@ static bool compileAndRunCpp(const std::string& cppFile, const std::string& outp
 
 int main(int argc, char** argv) {
   if (argc < 2) {
-        std::cerr << "Usage: transpiler <input.case> [--native] [--ciam-native] [--ciam-aot]\n";
+        std::cerr << "Usage: transpiler <input.case> [--native] [--ciam-native] [--ciam-aot] [--dump-asm] [--pch] [--parallel-emit]\n"
+                     "                  [--split-tu N] [--jobs N] [--lto|--no-lto] [--compare-tu]\n"
+                     "                  [--emit-only|--compile-only|--no-run|--run] [--time-limit S] [--memory-limit MB]\n";
         std::cerr << "Options:\n";
         std::cerr << "  --native   Direct compilation to native executable\n";
         std::cerr << "  --ciam-native  CIAM direct-to-native with maximum optimization\n";
         std::cerr << "  --ciam-aotCIAM AOT: Pure machine code emission (bypasses C++ entirely)\n";
+        std::cerr << "  --dump-asm       AOT: print a listing and write <exe>.map for perf\n";
+        std::cerr << "  --pch      Compile against a cached precompiled runtime header\n";
+        std::cerr << "  --parallel-emit  Generate C++ for each function on its own thread\n";
+        std::cerr << "  --split-tu N     Native: N translation units compiled concurrently, then linked\n";
+        std::cerr << "  --jobs N         Compiler processes run at once (default: CASE_JOBS or CPU count)\n";
+        std::cerr << "  --lto, --no-lto  Link-time optimization for split builds (default: on for CIAM)\n";
+        std::cerr << "  --compare-tu     With --split-tu, also build as one unit (<name>.single) and report both times\n";
+        std::cerr << "  --emit-only      Stop after writing the C++ (AOT: the executable)\n";
+        std::cerr << "  --compile-only   Stop after compiling to object files\n";
+        std::cerr << "  --no-run         Stop after linking (default)\n";
+        std::cerr << "  --run            Also run the program, within the limits below\n";
+        std::cerr << "  --time-limit S   Wall-clock and CPU seconds for --run (default 10, 0: none)\n";
+        std::cerr << "  --memory-limit MB  Address space for --run (default 1024, 0: none)\n";
     return 1;
     }
 
@@ -848,6 +1148,18 @@ int main(int argc, char** argv) {
         bool directNative = false;
  bool ciamNative = false;
   bool ciamAOT = false;
+        bool dumpAsm = false;
+        bool precompiledRuntime = false;
+        bool parallelEmit = false;
+        size_t splitUnits = 0;
+        size_t jobs = defaultJobCount();
+        int linkTimeOptimization = -1;  // -1: the mode's default
+        bool compareSingleUnit = false;
+        BuildStage stage = BuildStage::Link;
+        ProcessLimits runLimits;
+        runLimits.wallSeconds = 10;
+        runLimits.cpuSeconds = 10;
+        runLimits.memoryMb = 1024;
         
         // Parse command-line options
         for (int i = 2; i < argc; ++i) {
@@ -860,6 +1172,37 @@ int main(int argc, char** argv) {
          } else if (arg == "--ciam-aot") {
     ciamAOT = true;
 directNative = true;
+} else if (arg == "--dump-asm") {
+    dumpAsm = true;
+} else if (arg == "--pch") {
+    precompiledRuntime = true;
+} else if (arg == "--parallel-emit") {
+    parallelEmit = true;
+} else if (arg == "--split-tu" && i + 1 < argc) {
+    splitUnits = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+    directNative = true;
+} else if (arg == "--jobs" && i + 1 < argc) {
+    jobs = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+} else if (arg == "--lto") {
+    linkTimeOptimization = 1;
+} else if (arg == "--no-lto") {
+    linkTimeOptimization = 0;
+} else if (arg == "--compare-tu") {
+    compareSingleUnit = true;
+} else if (arg == "--emit-only") {
+    stage = BuildStage::Emit;
+} else if (arg == "--compile-only") {
+    stage = BuildStage::Compile;
+} else if (arg == "--no-run") {
+    stage = BuildStage::Link;
+} else if (arg == "--run") {
+    stage = BuildStage::Run;
+} else if (arg == "--time-limit" && i + 1 < argc) {
+    double seconds = std::max(0.0, std::strtod(argv[++i], nullptr));
+    runLimits.wallSeconds = seconds;
+    runLimits.cpuSeconds = static_cast<long>(std::ceil(seconds));
+} else if (arg == "--memory-limit" && i + 1 < argc) {
+    runLimits.memoryMb = std::max(0L, std::strtol(argv[++i], nullptr, 10));
 }
         }
  
@@ -905,6 +1248,10 @@ if (t.type == TokenType::EndOfFile) continue;
    Parser parser(tokens);
   NodePtr ast = parser.parse();
 
+        // Concrete C++ types for variables and function signatures
+        TypeInference typeInference;
+        typeInference.run(ast);
+
       std::cout << "\n\033[1;36m=== AST ===\033[0m\n";
     ast->print();
 
@@ -925,6 +1272,7 @@ if (t.type == TokenType::EndOfFile) continue;
             
         // Create machine code emitter
           MachineCodeEmitter emitter;
+        emitter.setListing(dumpAsm);
         std::vector<uint8_t> machineCode = emitter.emit(ast);
        
             std::cout << "\033[1;35m[CIAM]\033[0m Generated " << machineCode.size() 
@@ -934,46 +1282,88 @@ if (t.type == TokenType::EndOfFile) continue;
  PlatformInfo platform = detectPlatform();
     std::string exeName = baseName + "_aot" + platform.extension;
       
-    std::vector<uint8_t> emptyData;  // No data section for now
-            success = BinaryWriter::writeBinary(exeName, machineCode, emptyData);
+    std::vector<uint8_t> emptyData;  // No writable data yet
+    // Fix the segment addresses, then point the code's string references at them
+    ImageLayout layout = ImageLayout::of(machineCode.size(), emitter.rodata().size(), emptyData.size());
+    machineCode = emitter.link(layout.codeAddress(), layout.rodataAddress(), layout.bssAddress());
+            if (!emitter.unresolvedSymbols().empty() || !emitter.unsupportedLiterals().empty()) {
+                std::cerr << "\033[1;31m[CIAM AOT]\033[0m " << emitter.unresolvedSymbols().size()
+                          << " unresolved symbol(s), " << emitter.unsupportedLiterals().size()
+                          << " unsupported literal(s); no executable written\n";
+                success = false;
+            } else {
+            success = BinaryWriter::writeBinary(exeName, machineCode, emptyData, emitter.rodata(), emitter.bssSize());
+            }
       
             if (success) {
        std::cout << "\033[1;32m✅ Pure AOT executable created: " << exeName << "\033[0m\n";
         std::cout << "\033[1;35m[CIAM AOT]\033[0m Zero C++ code generated\n";
     std::cout << "\033[1;35m[CIAM AOT]\033[0m Zero external compiler invoked\n";
   std::cout << "\033[1;35m[CIAM AOT]\033[0m Direct machine code: " << machineCode.size() << " bytes\n";
+
+    // Listing on stdout; the symbol map beside the executable, for perf
+    // as /tmp/perf-<pid>.map
+    if (dumpAsm) {
+        std::cout << "\n\033[1;35m=== AOT Listing ===\033[0m\n";
+        emitter.writeListing(std::cout, layout.codeAddress());
+        if (emitter.writePerfMap(exeName + ".map", layout.codeAddress())) {
+            std::cout << "\033[1;35m[CIAM AOT]\033[0m Symbol map: " << exeName << ".map\n";
+        }
+    }
   
-    // Attempt to run
-       std::cout << "\n\033[1;36m=== Running " << exeName << " ===\033[0m\n\n";
-          #ifdef _WIN32
-          int runResult = system(exeName.c_str());
-     #else
-      std::string runCmd = "./" + exeName;
-      int runResult = system(runCmd.c_str());
-    #endif
-     
-        std::cout << "\n";
-          if (runResult == 0) {
- std::cout << "\033[1;32m✅ Program executed successfully\033[0m\n";
-  } else {
-  std::cout << "\033[1;33m⚠️  Program exited with code: " << runResult << "\033[0m\n";
-          }
+    // Run only when asked to
+       if (stage == BuildStage::Run) runProgram(exeName, runLimits);
        }
   }
         // Legacy paths: C++ generation
         else if (directNative) {
             // Code generation
          CodeEmitter emitter;
-     std::string cpp = emitter.emit(ast);
-      
-            std::cout << "\n\033[1;32m✅ Generated C++ code\033[0m\n";
-            
+            emitter.setPrecompiledRuntime(precompiledRuntime);
+            emitter.setParallelFunctions(parallelEmit);
        NativeCompiler nativeCompiler;
             nativeCompiler.setCIAMEnabled(ciamNative || ciamEnabled);
+            nativeCompiler.setPrecompiledRuntime(precompiledRuntime);
+            // AOT was handled above; this path always goes through C++
+            nativeCompiler.setCompilationMode(CompilationMode::Direct_Native);
+            nativeCompiler.setJobs(jobs);
+            nativeCompiler.setStage(stage);
+            nativeCompiler.setLinkTimeOptimization(
+                linkTimeOptimization < 0 ? (ciamNative || ciamEnabled) : linkTimeOptimization == 1);
        
+            if (splitUnits > 0) {
+                SplitProgram program;
+                emitter.emitSplit(ast, splitUnits, "case_program.hpp", program);
+                std::cout << "\n\033[1;32m✅ Generated C++ code (" << program.units.size()
+                          << " translation units)\033[0m\n";
+                success = nativeCompiler.compileSplitToNative(program, baseName);
+                
+                if (success && compareSingleUnit && stage >= BuildStage::Link) {
+                    double splitSeconds = nativeCompiler.lastBuildSeconds();
+                    CodeEmitter single;
+                    single.setPrecompiledRuntime(precompiledRuntime);
+                    EmitBuffer cpp;
+                    single.emit(ast, cpp);
+                    // Beside the split build, not over it: that is the one --run starts
+                    if (nativeCompiler.compileToNative(cpp, baseName + ".single")) {
+                        double singleSeconds = nativeCompiler.lastBuildSeconds();
+                        std::cout << "\n\033[1;36m=== Build Time ===\033[0m\n" << std::fixed << std::setprecision(2)
+                                  << "Single unit: " << singleSeconds << " s\n"
+                                  << "Split (" << program.units.size() << " units, " << jobs
+                                  << " jobs): " << splitSeconds << " s (" << singleSeconds / splitSeconds
+                                  << "x)\n" << std::defaultfloat;
+                    }
+                }
+            } else {
+     EmitBuffer cpp;
+            emitter.emit(ast, cpp);
+      
+            std::cout << "\n\033[1;32m✅ Generated C++ code\033[0m\n";
+            
             success = nativeCompiler.compileToNative(cpp, baseName);
+            }
  
-     if (success) {
+     if (success && stage == BuildStage::Run) {
      // Run the compiled program
        PlatformInfo platform = detectPlatform();
     std::string exeName = baseName;
@@ -982,27 +1372,24 @@ if (t.type == TokenType::EndOfFile) continue;
       }
            exeName += platform.extension;
     
-   std::cout << "\n\033[1;36m=== Running " << exeName << " ===\033[0m\n\n";
-       int runResult = system(exeName.c_str());
-         
-      std::cout << "\n";
-        if (runResult == 0) {
-           std::cout << "\033[1;32m✅ Program executed successfully\033[0m\n";
-                } else {
-        std::cout << "\033[1;33m⚠️  Program exited with code: " << runResult << "\033[0m\n";
-           }
+       runProgram(exeName, runLimits);
  }
         } else {
             // Standard compilation (backward compatibility)
   CodeEmitter emitter;
-  std::string cpp = emitter.emit(ast);
+            emitter.setPrecompiledRuntime(precompiledRuntime);
+            emitter.setParallelFunctions(parallelEmit);
+  EmitBuffer cpp;
+            emitter.emit(ast, cpp);
             
-       std::ofstream out("compiler.cpp");
-      out << cpp;
-    out.close();
+       if (!cpp.writeToFile("compiler.cpp")) {
+            std::cerr << "\033[1;31m❌ Cannot write compiler.cpp\033[0m\n";
+            success = false;
+        } else {
         std::cout << "\033[1;32m✅ Generated compiler.cpp\033[0m\n";
        
-            success = compileAndRunCpp("compiler.cpp", "program.exe");
+            success = compileAndRunCpp("compiler.cpp", "program.exe", precompiledRuntime, stage, runLimits);
+        }
   }
 
         errorReporter.printSummary();
@@ -160,8 +160,9 @@ writeU16(out, 6);// MajorOperatingSystemVersion
            uint32_t virtualAddr, uint32_t virtualSize,
     uint32_t rawSize, uint32_t rawOffset,
          uint32_t characteristics) {
+        // Fixed 8 bytes, zero padded; a full-length name has no terminator
         char nameField[8] = {0};
-        strncpy(nameField, name.c_str(), 8);
+        memcpy(nameField, name.data(), name.size() < sizeof(nameField) ? name.size() : sizeof(nameField));
         out.write(nameField, 8);
         
         writeU32(out, virtualSize);
@@ -197,26 +198,65 @@ writeU16(out, 6);// MajorOperatingSystemVersion
 // ELF (Executable and Linkable Format) - Linux
 // -----------------------------------------------------------------------------
 
+// Where ELFEmitter puts each segment. Every segment starts on its own page
+// so it gets its own protection, and its virtual address is the load base
+// plus its file offset, so code can reach rodata RIP-relative before the
+// file is written.
+struct ImageLayout {
+    static constexpr uint64_t BASE = 0x400000;
+    static constexpr uint64_t PAGE = 0x1000;
+
+    uint64_t codeOffset = PAGE;  // the first page holds the headers
+    uint64_t rodataOffset = 0;
+    uint64_t dataOffset = 0;
+    // The bss is not in the file: it extends the data segment in memory
+    uint64_t bssStart = 0;
+
+    uint64_t codeAddress() const { return BASE + codeOffset; }
+    uint64_t rodataAddress() const { return BASE + rodataOffset; }
+    uint64_t dataAddress() const { return BASE + dataOffset; }
+    uint64_t bssAddress() const { return dataAddress() + bssStart; }
+
+    static uint64_t pageAlign(uint64_t size) { return (size + PAGE - 1) & ~(PAGE - 1); }
+
+    static ImageLayout of(size_t codeSize, size_t rodataSize, size_t dataSize = 0) {
+        ImageLayout layout;
+        layout.rodataOffset = layout.codeOffset + pageAlign(codeSize);
+        layout.dataOffset = layout.rodataOffset + pageAlign(rodataSize);
+        layout.bssStart = (dataSize + 15) & ~uint64_t(15);
+        return layout;
+    }
+};
+
 class ELFEmitter {
 public:
     bool emitExecutable(const std::string& filename, const std::vector<uint8_t>& code,
-               const std::vector<uint8_t>& data) {
+               const std::vector<uint8_t>& data, const std::vector<uint8_t>& rodata = {},
+               uint64_t bssSize = 0) {
      std::cout << "\n\033[1;35m[ELF Emitter]\033[0m Creating Linux executable...\n";
         
         std::ofstream out(filename, std::ios::binary);
         if (!out) return false;
         
+        ImageLayout layout = ImageLayout::of(code.size(), rodata.size(), data.size());
+        std::vector<Segment> segments;
+        segments.push_back({5, layout.codeOffset, &code, code.size()});               // R+X
+        if (!rodata.empty()) segments.push_back({4, layout.rodataOffset, &rodata, rodata.size()});  // R
+        if (!data.empty() || bssSize > 0) {
+            segments.push_back({6, layout.dataOffset, &data, bssSize > 0 ? layout.bssStart + bssSize : data.size()});  // R+W
+        }
+
         // ELF Header
-        writeELFHeader(out);
+        writeELFHeader(out, layout.codeAddress(), static_cast<uint16_t>(segments.size()));
       
         // Program Headers
-        writeProgramHeaders(out, code, data);
-        
-        // Code section
-        out.write(reinterpret_cast<const char*>(code.data()), code.size());
+        for (auto& segment : segments) writeProgramHeader(out, segment);
         
-        // Data section
-        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        // Segments, each at the page-aligned offset its header gives
+        for (auto& segment : segments) {
+            padTo(out, segment.offset);
+            out.write(reinterpret_cast<const char*>(segment.bytes->data()), segment.bytes->size());
+        }
         
 out.close();
     
@@ -230,7 +270,14 @@ out.close();
     }
     
 private:
-    void writeELFHeader(std::ofstream& out) {
+    struct Segment {
+        uint32_t flags;
+        uint64_t offset;
+        const std::vector<uint8_t>* bytes;
+        uint64_t memorySize;  // past the file bytes the loader zero-fills
+    };
+
+    void writeELFHeader(std::ofstream& out, uint64_t entry, uint16_t segmentCount) {
         // ELF Magic
   out.write("\x7f""ELF", 4);
         
@@ -243,39 +290,35 @@ private:
         writeU16(out, 2);    // Executable file
         writeU16(out, 0x3E); // x86-64
      writeU32(out, 1);    // ELF version
-        writeU64(out, 0x400000 + 0x1000);  // Entry point
+        writeU64(out, entry);  // Entry point: start of the code
         writeU64(out, 64);   // Program header offset
         writeU64(out, 0);    // Section header offset (none for now)
         writeU32(out, 0);    // Flags
         writeU16(out, 64);   // ELF header size
         writeU16(out, 56);   // Program header entry size
-        writeU16(out, 2);    // Number of program headers
+        writeU16(out, segmentCount);  // Number of program headers
         writeU16(out, 0);  // Section header entry size
         writeU16(out, 0);    // Number of section headers
         writeU16(out, 0);    // Section name string table index
     }
     
-    void writeProgramHeaders(std::ofstream& out, const std::vector<uint8_t>& code,
-           const std::vector<uint8_t>& data) {
-        // Code segment (PT_LOAD)
- writeU32(out, 1);    // PT_LOAD
-        writeU32(out, 5);    // Flags: R+X
-        writeU64(out, 0x1000);  // Offset in file
-   writeU64(out, 0x400000 + 0x1000);  // Virtual address
-        writeU64(out, 0x400000 + 0x1000);  // Physical address
-        writeU64(out, code.size());         // Size in file
-        writeU64(out, code.size());         // Size in memory
-    writeU64(out, 0x1000);         // Alignment
-        
-        // Data segment (PT_LOAD)
-      writeU32(out, 1);    // PT_LOAD
-        writeU32(out, 6);    // Flags: R+W
-  writeU64(out, 0x1000 + code.size());  // Offset in file
-        writeU64(out, 0x400000 + 0x2000);     // Virtual address
-        writeU64(out, 0x400000 + 0x2000);     // Physical address
-        writeU64(out, data.size());   // Size in file
-     writeU64(out, data.size());           // Size in memory
-        writeU64(out, 0x1000);    // Alignment
+    void writeProgramHeader(std::ofstream& out, const Segment& segment) {
+        writeU32(out, 1);    // PT_LOAD
+        writeU32(out, segment.flags);
+        writeU64(out, segment.offset);                        // Offset in file
+        writeU64(out, ImageLayout::BASE + segment.offset);    // Virtual address
+        writeU64(out, ImageLayout::BASE + segment.offset);    // Physical address
+        writeU64(out, segment.bytes->size());                 // Size in file
+        writeU64(out, segment.memorySize);                    // Size in memory
+        writeU64(out, ImageLayout::PAGE);                     // Alignment
+    }
+
+    void padTo(std::ofstream& out, uint64_t offset) {
+        uint64_t at = static_cast<uint64_t>(out.tellp());
+        if (at < offset) {
+            std::vector<char> zeros(offset - at, 0);
+            out.write(zeros.data(), zeros.size());
+        }
     }
     
     void writeU8(std::ofstream& out, uint8_t val) {
@@ -359,20 +402,31 @@ private:
 
 class BinaryWriter {
 public:
+    // The PE and Mach-O writers have no read-only segment or bss yet; rodata
+    // goes ahead of the data there
     static bool writeBinary(const std::string& filename, 
            const std::vector<uint8_t>& code,
-  const std::vector<uint8_t>& data) {
+  const std::vector<uint8_t>& data,
+           const std::vector<uint8_t>& rodata = {},
+           uint64_t bssSize = 0) {
         #ifdef _WIN32
     PEEmitter emitter;
-   return emitter.emitExecutable(filename, code, data);
+   return emitter.emitExecutable(filename, code, concat(rodata, data));
    #elif __APPLE__
             MachOEmitter emitter;
-            return emitter.emitExecutable(filename, code, data);
+            return emitter.emitExecutable(filename, code, concat(rodata, data));
         #else
        ELFEmitter emitter;
-            return emitter.emitExecutable(filename, code, data);
+            return emitter.emitExecutable(filename, code, data, rodata, bssSize);
         #endif
     }
+
+private:
+    static std::vector<uint8_t> concat(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+        std::vector<uint8_t> joined(a);
+        joined.insert(joined.end(), b.begin(), b.end());
+        return joined;
+    }
 };
 
 #endif // BINARY_EMITTER_HPP
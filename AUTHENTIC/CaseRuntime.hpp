@@ -0,0 +1,38 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Precompiled Header
+//  Every runtime header plus the standard headers generated code may use.
+//  Generated programs include this instead of their own header set when the
+//  transpiler runs with --pch; it is then compiled once per compiler and
+//  flag set (see ensureRuntimePch in ActiveTranspiler_Modular.cpp) and
+//  reused by every later build.
+//
+//  By hand:
+//      g++     -std=c++17 -O2 -x c++-header CaseRuntime.hpp -o CaseRuntime.hpp.gch
+//      clang++ -std=c++17 -O2 -x c++-header CaseRuntime.hpp -o CaseRuntime.hpp.pch
+//=============================================================================
+
+#ifndef CASE_RUNTIME_HPP
+#define CASE_RUNTIME_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RuntimeCollections.hpp"
+#include "RuntimeCompress.hpp"
+#include "RuntimeIO.hpp"
+#include "RuntimeMatrix.hpp"
+#include "RuntimePrint.hpp"
+#include "RuntimeSerialize.hpp"
+#include "RuntimeSimd.hpp"
+#include "RuntimeString.hpp"
+#include "RuntimeThreadOutput.hpp"
+
+#endif // CASE_RUNTIME_HPP
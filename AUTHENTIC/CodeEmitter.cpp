@@ -3,48 +3,424 @@
 //=============================================================================
 
 #include "CodeEmitter.hpp"
+#include "RuntimeParallel.hpp"
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 
+void CodeEmitter::emit(NodePtr root, EmitBuffer& out) {
+    splitting = false;
+    Sections sections;
+    emitSections(root, sections);
+
+    emitIncludes(out);
+    out << "\n";
+    if (needsGlobalMutex) out << "static std::mutex global_mutex;\n\n";
+    out << "namespace " << PROGRAM_NAMESPACE << " {\n\n";
+    if (!sections.globals.empty()) sections.globals << "\n";
+    out.append(std::move(sections.globals));
+    out.append(std::move(sections.prototypes));
+    for (auto& def : sections.definitions) {
+        out.append(std::move(def.code));
+        if (usesSerialization) out.append(std::move(def.codecs));
+    }
+    out << "} // namespace " << PROGRAM_NAMESPACE << "\n\n";
+    emitMain(std::move(sections.body), sections.names, out);
+}
+
+void CodeEmitter::emitSplit(NodePtr root, size_t units, const std::string& headerName, SplitProgram& out) {
+    splitting = true;
+    Sections sections;
+    emitSections(root, sections);
+    splitting = false;
+
+    // Header: everything every unit needs to see
+    EmitBuffer& header = out.header;
+    header << "#pragma once\n";
+    emitIncludes(header);
+    header << "\n";
+    if (needsGlobalMutex) header << "inline std::mutex global_mutex;\n\n";
+    header << "namespace " << PROGRAM_NAMESPACE << " {\n\n";
+    for (auto& def : sections.definitions) {
+        if (def.fn) continue;
+        header.append(std::move(def.code));
+        if (usesSerialization) header.append(std::move(def.codecs));
+    }
+    if (!sections.globals.empty()) sections.globals << "\n";
+    header.append(std::move(sections.globals));
+    header.append(std::move(sections.prototypes));
+    for (auto& def : sections.definitions) {
+        if (def.fn && isGeneric(*def.fn)) header.append(std::move(def.code));
+    }
+    header << "} // namespace " << PROGRAM_NAMESPACE << "\n";
+
+    // Units: main() first, then the concrete functions in source order, cut
+    // into runs of roughly equal size
+    std::vector<Definition*> concrete;
+    size_t total = sections.body.size();
+    for (auto& def : sections.definitions) {
+        if (!def.fn || isGeneric(*def.fn)) continue;
+        concrete.push_back(&def);
+        total += def.code.size();
+    }
+    units = std::max<size_t>(1, std::min(units, concrete.size() + 1));
+    auto startUnit = [&]() -> EmitBuffer& {
+        out.units.emplace_back();
+        EmitBuffer& unit = out.units.back();
+        if (precompiledRuntime) unit << "#include \"CaseRuntime.hpp\"\n";
+        unit << "#include \"" << headerName << "\"\n\n";
+        return unit;
+    };
+    out.units.clear();
+    out.units.reserve(units);
+    EmitBuffer* unit = &startUnit();
+    size_t done = sections.body.size();
+    emitMain(std::move(sections.body), sections.names, *unit);
+    *unit << "\nnamespace " << PROGRAM_NAMESPACE << " {\n\n";
+    for (Definition* def : concrete) {
+        if (done >= total * out.units.size() / units && out.units.size() < units) {
+            unit = &startUnit();
+            *unit << "namespace " << PROGRAM_NAMESPACE << " {\n\n";
+        }
+        done += def->code.size();
+        unit->append(std::move(def->code));
+    }
+    for (auto& code : out.units) code << "} // namespace " << PROGRAM_NAMESPACE << "\n";
+}
+
+// Types, functions and top-level `let`s go to the program's namespace,
+// everything else runs in main() in source order. Headers are collected while
+// emitting, so a program only pays to compile the parts of the runtime it uses.
+void CodeEmitter::emitSections(NodePtr root, Sections& sections) {
+    std::vector<NodePtr> topLevel;
+    if (auto block = std::dynamic_pointer_cast<Block>(root)) {
+        topLevel = block->statements;
+    } else if (root) {
+        topLevel.push_back(root);
+    }
+
+    // Globals before any function is emitted, so every function sees them all
+    globalNames.clear();
+    globalScalars.clear();
+    std::unordered_set<const VarDecl*> globals;
+    for (auto& stmt : topLevel) {
+        auto varDecl = std::dynamic_pointer_cast<VarDecl>(stmt);
+        if (varDecl && emitGlobal(*varDecl, sections.globals)) {
+            globals.insert(varDecl.get());
+            sections.names.push_back(varDecl->name);
+        }
+    }
+
+    for (auto& stmt : topLevel) {
+        if (auto fn = std::dynamic_pointer_cast<FunctionDecl>(stmt)) {
+            emitFunctionPrototype(*fn, sections.prototypes);
+            sections.names.push_back(fn->name);
+        }
+    }
+    if (!sections.prototypes.empty()) sections.prototypes << "\n";
+
+    std::vector<std::shared_ptr<FunctionDecl>> functions;
+    std::vector<size_t> visibleStructs;
+    StructList structs;
+    for (auto& stmt : topLevel) {
+        if (auto fn = std::dynamic_pointer_cast<FunctionDecl>(stmt)) {
+            functions.push_back(fn);
+            visibleStructs.push_back(structs.size());
+        } else if (auto structDecl = std::dynamic_pointer_cast<StructDecl>(stmt)) {
+            structs.push_back(structDecl);
+        }
+    }
+    std::vector<EmitBuffer> functionCode;
+    if (parallelFunctions) functionCode = emitFunctionsParallel(functions, structs, visibleStructs);
+
+    size_t nextFunction = 0;
+    for (auto& stmt : topLevel) {
+        if (std::dynamic_pointer_cast<FunctionDecl>(stmt)) {
+            size_t i = nextFunction++;
+            sections.definitions.push_back(Definition{EmitBuffer(), functions[i], EmitBuffer()});
+            if (parallelFunctions) {
+                sections.definitions.back().code = std::move(functionCode[i]);
+            } else {
+                emitFunction(*functions[i], structs, visibleStructs[i], sections.definitions.back().code);
+            }
+        } else if (isDeclaration(stmt)) {
+            sections.definitions.push_back(Definition{EmitBuffer(), nullptr, EmitBuffer()});
+            Definition& def = sections.definitions.back();
+            emitNode(stmt, def.code);
+            if (auto structDecl = std::dynamic_pointer_cast<StructDecl>(stmt)) {
+                emitStructCodecs(*structDecl, def.codecs);
+            }
+        } else if (auto varDecl = std::dynamic_pointer_cast<VarDecl>(stmt); varDecl && globals.count(varDecl.get())) {
+            if (varDecl->initializer && !isConstantInitializer(varDecl->initializer)) {
+                sections.body << varDecl->name << " = ";
+                emitInitializer(*varDecl, sections.body);
+                sections.body << ";\n";
+            }
+        } else {
+            emitNode(stmt, sections.body);
+        }
+    }
+}
+
+void CodeEmitter::emitIncludes(EmitBuffer& out) {
+    if (precompiledRuntime) {
+        out << "#include \"CaseRuntime.hpp\"\n";
+        return;
+    }
+    for (auto& header : includes) {
+        if (header[0] == '<') out << "#include " << header << "\n";
+    }
+    for (auto& header : includes) {
+        if (header[0] != '<') out << "#include \"" << header << "\"\n";
+    }
+}
+
+// main() stays at global scope: GCC compiles it as code that runs once, which
+// keeps large programs quick to build. The using-directive brings in the
+// program's types; the globals and functions main() mentions are declared
+// again inside it, so they hide C library names such as index or exp. Only
+// those: a block of thousands of using-declarations takes minutes to compile.
+void CodeEmitter::emitMain(EmitBuffer&& body, const std::vector<std::string>& names, EmitBuffer& out) {
+    std::unordered_set<std::string> mentioned;
+    std::string text = body.str();
+    for (size_t i = 0; i < text.size();) {
+        if (!std::isalpha(static_cast<unsigned char>(text[i])) && text[i] != '_') {
+            ++i;
+            continue;
+        }
+        size_t start = i;
+        while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) ++i;
+        mentioned.insert(text.substr(start, i - start));
+    }
+
+    out << "int main() {\n";
+    out << "using namespace " << PROGRAM_NAMESPACE << ";\n";
+    for (auto& name : names) {
+        if (mentioned.erase(name)) out << "using " << PROGRAM_NAMESPACE << "::" << name << ";\n";
+    }
+    if (includes.count("RuntimePrint.hpp")) out << "CaseRuntime::initOutput();\n";
+    out.append(std::move(body));
+    out << "return 0;\n";
+    out << "}\n";
+}
+
 std::string CodeEmitter::emit(NodePtr root) {
-    std::ostringstream out;
-    out << "#include <iostream>\n";
-    out << "#include <string>\n";
-    out << "#include <cmath>\n";
-    out << "#include <fstream>\n";
-    out << "#include <queue>\n";
-    out << "#include <thread>\n";
-    out << "#include <future>\n";
-    out << "#include <vector>\n\n";
-    
-    emitNode(root, out);
+    EmitBuffer out;
+    emit(root, out);
     return out.str();
 }
 
-void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
+void CodeEmitter::setPrecompiledRuntime(bool enabled) {
+    precompiledRuntime = enabled;
+}
+
+void CodeEmitter::setParallelFunctions(bool enabled) {
+    parallelFunctions = enabled;
+}
+
+void CodeEmitter::require(const std::string& header) {
+    includes.insert(header);
+}
+
+// Parameters or a result TypeInference left open: a template or an `auto`
+// function, which has to be defined wherever it is called
+bool CodeEmitter::isGeneric(const FunctionDecl& fn) {
+    if (fn.returnType.empty() || fn.paramTypes.size() != fn.paramNames.size()) return true;
+    for (auto& type : fn.paramTypes) {
+        if (type.empty()) return true;
+    }
+    return false;
+}
+
+bool CodeEmitter::isDeclaration(NodePtr node) const {
+    return std::dynamic_pointer_cast<FunctionDecl>(node) || std::dynamic_pointer_cast<StructDecl>(node) ||
+           std::dynamic_pointer_cast<EnumDecl>(node) || std::dynamic_pointer_cast<UnionDecl>(node) ||
+           std::dynamic_pointer_cast<TypedefStmt>(node);
+}
+
+void CodeEmitter::emitInitializer(const VarDecl& decl, EmitBuffer& out) {
+    // map/filter/slice build a lazy view over their source; a named variable
+    // owns its elements, so the pipeline runs here, once
+    auto coll = std::dynamic_pointer_cast<CollectionCallExpr>(decl.initializer);
+    if (coll && (coll->function == "map" || coll->function == "filter" || coll->function == "slice")) {
+        out << "CaseRuntime::coll_collect(";
+        emitExpr(decl.initializer, out);
+        out << ")";
+    } else {
+        emitExpr(decl.initializer, out);
+    }
+}
+
+// Literals and builtin calls over them: safe to evaluate before main(), since
+// nothing main() does first can change the result
+bool CodeEmitter::isConstantInitializer(NodePtr expr) {
+    if (!expr) return true;
+    if (std::dynamic_pointer_cast<Literal>(expr) || std::dynamic_pointer_cast<PlaceholderExpr>(expr)) return true;
+    if (auto id = std::dynamic_pointer_cast<Identifier>(expr)) return id->name == "true" || id->name == "false";
+    auto all = [](const std::vector<NodePtr>& nodes) {
+        return std::all_of(nodes.begin(), nodes.end(), isConstantInitializer);
+    };
+    if (auto list = std::dynamic_pointer_cast<ListExpr>(expr)) return all(list->elements);
+    if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(expr)) {
+        return isConstantInitializer(bin->left) && isConstantInitializer(bin->right);
+    }
+    if (auto unary = std::dynamic_pointer_cast<UnaryExpr>(expr)) return isConstantInitializer(unary->operand);
+    if (auto math = std::dynamic_pointer_cast<MathCallExpr>(expr)) return math->function != "random" && all(math->args);
+    if (auto str = std::dynamic_pointer_cast<StringCallExpr>(expr)) return all(str->args);
+    if (auto coll = std::dynamic_pointer_cast<CollectionCallExpr>(expr)) {
+        return isConstantInitializer(coll->collection) && all(coll->args);
+    }
+    return false;
+}
+
+// A top-level `let` is visible to every function. A constant initializer runs
+// before main(); any other one is assigned in main() in source order, which
+// needs a type TypeInference could name. The rest (collections built from
+// other variables) stay locals of main().
+bool CodeEmitter::emitGlobal(const VarDecl& decl, EmitBuffer& out) {
+    bool typed = !decl.type.empty() && decl.type != "auto";
+    bool constant = decl.initializer && isConstantInitializer(decl.initializer);
+    if (!typed && !constant) return false;
+    if (decl.type == "std::string") require("<string>");
+    out << (splitting ? "inline " : "static ") << (typed ? decl.type : "auto") << " " << decl.name;
+    if (constant) {
+        out << " = ";
+        emitInitializer(decl, out);
+    } else {
+        out << "{}";
+    }
+    out << ";\n";
+    declaredNames.insert(decl.name);
+    globalNames.insert(decl.name);
+    if (typed) {
+        scalarNames.insert(decl.name);
+        globalScalars.insert(decl.name);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Functions
+// -----------------------------------------------------------------------------
+
+// Parameters and result take the types TypeInference found; a parameter it
+// could not pin down becomes a template parameter, an unknown result `auto`
+void CodeEmitter::emitFunctionSignature(const FunctionDecl& fn, EmitBuffer& out) {
+    const auto& params = fn.paramNames;
+    auto typeOf = [&](size_t i) { return i < fn.paramTypes.size() ? fn.paramTypes[i] : std::string(); };
+    bool generic = false;
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (!typeOf(i).empty()) continue;
+        out << (generic ? ", " : "template <") << "typename T" << i;
+        generic = true;
+    }
+    if (generic) out << ">\n";
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (typeOf(i) == "std::string") require("<string>");
+    }
+    if (fn.returnType == "std::string") require("<string>");
+
+    if (splitting && isGeneric(fn)) out << "inline ";
+    out << (fn.returnType.empty() ? "auto" : fn.returnType) << " " << fn.name << "(";
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (i > 0) out << ", ";
+        std::string type = typeOf(i);
+        out << (type.empty() ? "T" + std::to_string(i) : type) << " " << params[i];
+    }
+    out << ")";
+}
+
+// Declared up front so functions can call each other in any order
+void CodeEmitter::emitFunctionPrototype(const FunctionDecl& fn, EmitBuffer& out) {
+    emitFunctionSignature(fn, out);
+    out << ";\n";
+}
+
+// A function sees the top-level struct types declared before it and the
+// globals, nothing else the program has emitted so far, and its own locals
+// do not outlive it.
+// Each function is then independent of its neighbours, which is what lets
+// emitFunctionsParallel produce the same text as the serial walk.
+void CodeEmitter::emitFunction(const FunctionDecl& fn, const StructList& structs, size_t visible, EmitBuffer& out) {
+    auto savedStructs = std::move(structTypes);
+    auto savedHandles = std::move(fileHandles);
+    auto savedDeclared = std::move(declaredNames);
+    auto savedMatrices = std::move(matrixNames);
+    auto savedScalars = std::move(scalarNames);
+    structTypes.clear();
+    fileHandles.clear();
+    declaredNames = globalNames;
+    matrixNames.clear();
+    scalarNames = globalScalars;
+    for (size_t i = 0; i < visible; ++i) structTypes[structs[i]->name] = structs[i];
+
+    emitFunctionSignature(fn, out);
+    out << " {\n";
+    if (fn.body) emitNode(fn.body, out);
+    out << "}\n\n";
+
+    structTypes = std::move(savedStructs);
+    fileHandles = std::move(savedHandles);
+    declaredNames = std::move(savedDeclared);
+    matrixNames = std::move(savedMatrices);
+    scalarNames = std::move(savedScalars);
+}
+
+// One emitter per function; the headers they need and the global mutex and
+// serialization flags are merged back afterwards
+std::vector<EmitBuffer> CodeEmitter::emitFunctionsParallel(const std::vector<std::shared_ptr<FunctionDecl>>& functions,
+                                                           const StructList& structs,
+                                                           const std::vector<size_t>& visible) {
+    std::vector<EmitBuffer> code(functions.size());
+    std::vector<CodeEmitter> workers(functions.size());
+    CaseRuntime::ThreadPool::instance().run(functions.size(), [&](size_t i) {
+        workers[i].precompiledRuntime = precompiledRuntime;
+        workers[i].splitting = splitting;
+        workers[i].globalNames = globalNames;
+        workers[i].globalScalars = globalScalars;
+        workers[i].emitFunction(*functions[i], structs, visible[i], code[i]);
+    });
+    for (auto& worker : workers) {
+        includes.insert(worker.includes.begin(), worker.includes.end());
+        needsGlobalMutex = needsGlobalMutex || worker.needsGlobalMutex;
+        usesSerialization = usesSerialization || worker.usesSerialization;
+    }
+    return code;
+}
+
+void CodeEmitter::emitNode(NodePtr node, EmitBuffer& out) {
     if (auto block = std::dynamic_pointer_cast<Block>(node)) {
         for (auto& stmt : block->statements) {
             emitNode(stmt, out);
         }
     }
+    // Fn nested in a block: a local generic lambda
     else if (auto fn = std::dynamic_pointer_cast<FunctionDecl>(node)) {
-        out << "auto " << fn->name << "(";
-        if (!fn->params.empty()) {
-            out << fn->params;
+        const auto& params = fn->paramNames;
+        out << "auto " << fn->name << " = [&](";
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (i > 0) out << ", ";
+            out << "auto " << params[i];
         }
         out << ") {\n";
-        emitNode(fn->body, out);
-        out << "}\n\n";
+        if (fn->body) emitNode(fn->body, out);
+        out << "};\n";
     }
     else if (auto print = std::dynamic_pointer_cast<PrintStmt>(node)) {
-        out << "std::cout << ";
+        require("RuntimePrint.hpp");
+        out << "CaseRuntime::printLine(";
         emitExpr(print->expr, out);
-        out << " << std::endl;\n";
+        out << ");\n";
     }
     else if (auto varDecl = std::dynamic_pointer_cast<VarDecl>(node)) {
-        out << "auto " << varDecl->name;
+        if (isMatrixExpr(varDecl->initializer)) matrixNames.insert(varDecl->name);
+        declaredNames.insert(varDecl->name);
+        if (!varDecl->type.empty() && varDecl->type != "auto") scalarNames.insert(varDecl->name);
+        if (varDecl->type == "std::string") require("<string>");
+        out << (varDecl->type.empty() ? "auto" : varDecl->type) << " " << varDecl->name;
         if (varDecl->initializer) {
             out << " = ";
-            emitExpr(varDecl->initializer, out);
+            emitInitializer(*varDecl, out);
         }
         out << ";\n";
     }
@@ -111,16 +487,23 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << "}\n";
     }
     else if (auto threadStmt = std::dynamic_pointer_cast<ThreadStmt>(node)) {
+        require("<thread>");
+        require("RuntimeThreadOutput.hpp");
+        out << "CaseRuntime::flushThreadOutput();\n";
         out << "std::thread([&]() {\n";
         emitNode(threadStmt->block, out);
         out << "}).detach();\n";
     }
     else if (auto asyncStmt = std::dynamic_pointer_cast<AsyncStmt>(node)) {
+        require("<future>");
+        require("RuntimeThreadOutput.hpp");
+        out << "CaseRuntime::flushThreadOutput();\n";
         out << "std::async(std::launch::async, [&]() { return ";
         emitExpr(asyncStmt->expr, out);
         out << "; });\n";
     }
     else if (auto channelDecl = std::dynamic_pointer_cast<ChannelDecl>(node)) {
+        require("<queue>");
         out << "std::queue<" << channelDecl->channelType << "> " 
             << channelDecl->name << ";\n";
     }
@@ -134,9 +517,13 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << recvStmt->channel << ".pop();\n";
     }
     else if (auto structDecl = std::dynamic_pointer_cast<StructDecl>(node)) {
+        structTypes[structDecl->name] = structDecl;
         out << "struct " << structDecl->name << " {\n";
         for (auto& f : structDecl->fields) {
-            out << "  " << f.first << " " << f.second << ";\n";
+            std::string type = cppType(f.first);
+            if (type.find("std::string") != std::string::npos) require("<string>");
+            if (type.compare(0, 10, "std::array") == 0) require("<array>");
+            out << "  " << type << " " << f.second << ";\n";
         }
         out << "};\n";
     }
@@ -162,52 +549,100 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
     }
     // BATCH 2: File I/O & Input
     else if (auto openStmt = std::dynamic_pointer_cast<OpenStmt>(node)) {
-        out << "std::fstream " << openStmt->handle << "(\"" << openStmt->filename << "\", ";
-        if (openStmt->mode == "r") out << "std::ios::in";
-        else if (openStmt->mode == "w") out << "std::ios::out";
-        else if (openStmt->mode == "rw") out << "std::ios::in | std::ios::out";
-        else out << "std::ios::out";
-        out << ");\n";
+        // "r" is mmap-backed, "w" is a 1 MiB buffered writer, "rw" stays on fstream
+        fileHandles[openStmt->handle] = openStmt->mode;
+        require("RuntimeIO.hpp");
+        if (openStmt->mode == "r") {
+            out << "CaseRuntime::MappedReader " << openStmt->handle << "(\"" << openStmt->filename << "\");\n";
+        } else if (openStmt->mode == "rw") {
+            out << "std::fstream " << openStmt->handle << "(\"" << openStmt->filename
+                << "\", std::ios::in | std::ios::out);\n";
+        } else {
+            out << "CaseRuntime::BufferedWriter " << openStmt->handle << "(\"" << openStmt->filename << "\");\n";
+        }
     }
     else if (auto writeStmt = std::dynamic_pointer_cast<WriteStmt>(node)) {
-        out << writeStmt->handle << " << ";
+        require("RuntimeIO.hpp");
+        out << (writeStmt->newline ? "CaseRuntime::writeLine(" : "CaseRuntime::write(")
+            << writeStmt->handle << ", ";
         emitExpr(writeStmt->expr, out);
-        if (writeStmt->newline) out << " << std::endl";
-        out << ";\n";
+        out << ");\n";
     }
     else if (auto readStmt = std::dynamic_pointer_cast<ReadStmt>(node)) {
-        out << readStmt->handle << " >> " << readStmt->varName << ";\n";
+        require("RuntimeIO.hpp");
+        out << "CaseRuntime::read(" << readStmt->handle << ", " << readStmt->varName << ");\n";
+    }
+    else if (auto flushStmt = std::dynamic_pointer_cast<FlushStmt>(node)) {
+        if (flushStmt->handle.empty()) {
+            require("RuntimePrint.hpp");
+            out << "CaseRuntime::flushOutput();\n";
+        } else {
+            require("RuntimeIO.hpp");
+            out << "CaseRuntime::flush(" << flushStmt->handle << ");\n";
+        }
     }
     else if (auto closeStmt = std::dynamic_pointer_cast<CloseStmt>(node)) {
         out << closeStmt->handle << ".close();\n";
     }
     else if (auto inputStmt = std::dynamic_pointer_cast<InputStmt>(node)) {
-        out << "std::cout << \"" << inputStmt->prompt << "\";\n";
+        require("RuntimePrint.hpp");
+        if (!declaredNames.count(inputStmt->varName)) {
+            // Text unless TypeInference saw the value used as a number
+            std::string type = inputStmt->type.empty() ? "std::string" : inputStmt->type;
+            if (type == "std::string") require("<string>");
+            declaredNames.insert(inputStmt->varName);
+            out << type << " " << inputStmt->varName << "{};\n";
+        }
+        out << "CaseRuntime::print(\"" << inputStmt->prompt << "\");\n";
+        out << "CaseRuntime::flushOutput();\n";
         out << "std::cin >> " << inputStmt->varName << ";\n";
     }
     else if (auto serializeStmt = std::dynamic_pointer_cast<SerializeStmt>(node)) {
-        out << "// Serialize to " << serializeStmt->format << ": ";
-        emitExpr(serializeStmt->data, out);
-        out << "\n";
+        const char* encoder = (serializeStmt->format == "json")
+            ? "CaseRuntime::Serial::toJson(" : "CaseRuntime::Serial::encode(";
+        require("RuntimeSerialize.hpp");
+        usesSerialization = true;
+        if (serializeStmt->target.empty()) {
+            require("RuntimePrint.hpp");
+            out << "CaseRuntime::printLine(" << encoder;
+            emitExpr(serializeStmt->data, out);
+            out << "));\n";
+        } else {
+            out << "std::string " << serializeStmt->target << " = " << encoder;
+            emitExpr(serializeStmt->data, out);
+            out << ");\n";
+        }
     }
     else if (auto deserializeStmt = std::dynamic_pointer_cast<DeserializeStmt>(node)) {
-        out << "// Deserialize from " << deserializeStmt->format << ": ";
-        emitExpr(deserializeStmt->source, out);
-        out << "\n";
+        require("RuntimeSerialize.hpp");
+        usesSerialization = true;
+        if (deserializeStmt->target.empty() || !structTypes.count(deserializeStmt->targetType)) {
+            out << "// Deserialize from " << deserializeStmt->format << " needs a struct type and target: ";
+            emitExpr(deserializeStmt->source, out);
+            out << "\n";
+        } else if (deserializeStmt->format == "json") {
+            out << deserializeStmt->targetType << " " << deserializeStmt->target << "{};\n";
+            out << "CaseRuntime::Serial::fromJson(";
+            emitExpr(deserializeStmt->source, out);
+            out << ", " << deserializeStmt->target << ");\n";
+        } else {
+            // Binary decode is zero-copy: string fields view the source buffer
+            out << deserializeStmt->targetType << "View " << deserializeStmt->target << "{};\n";
+            out << "CaseRuntime::Serial::decode(";
+            emitExpr(deserializeStmt->source, out);
+            out << ", " << deserializeStmt->target << ");\n";
+        }
     }
     else if (auto compressStmt = std::dynamic_pointer_cast<CompressStmt>(node)) {
-        out << "// Compress with " << compressStmt->algorithm << ": ";
-        emitExpr(compressStmt->data, out);
-        out << "\n";
+        emitCodecCall("compress", compressStmt->data, compressStmt->algorithm, compressStmt->target, out);
     }
     else if (auto decompressStmt = std::dynamic_pointer_cast<DecompressStmt>(node)) {
-        out << "// Decompress with " << decompressStmt->algorithm << ": ";
-        emitExpr(decompressStmt->data, out);
-        out << "\n";
+        emitCodecCall("decompress", decompressStmt->data, decompressStmt->algorithm, decompressStmt->target, out);
     }
     // BATCH 3: Security & Monitoring
     else if (auto sanitizeStmt = std::dynamic_pointer_cast<SanitizeStmt>(node)) {
         if (sanitizeStmt->type == "mem") {
+            require("<cstring>");
             out << "// Memory sanitization: ";
             emitExpr(sanitizeStmt->target, out);
             out << "\nstd::memset(&";
@@ -244,35 +679,73 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << "\n";
     }
     else if (auto matrixStmt = std::dynamic_pointer_cast<MatrixStmt>(node)) {
-        out << "std::vector<std::vector<double>> " << matrixStmt->matrixName;
-        out << "(" << matrixStmt->rows << ", std::vector<double>(" << matrixStmt->cols << "));\n";
+        matrixNames.insert(matrixStmt->matrixName);
+        require("RuntimeMatrix.hpp");
+        out << "CaseRuntime::Matrix " << matrixStmt->matrixName << "(" << matrixStmt->rows << ", " << matrixStmt->cols;
+        if (!matrixStmt->elements.empty()) {
+            out << ", {";
+            for (size_t i = 0; i < matrixStmt->elements.size(); ++i) {
+                if (i > 0) out << ", ";
+                emitExpr(matrixStmt->elements[i], out);
+            }
+            out << "}";
+        }
+        out << ");\n";
     }
     // BATCH 4: Data Manipulation
     else if (auto mutateStmt = std::dynamic_pointer_cast<MutateStmt>(node)) {
+        // Matrix targets reuse their storage: m = a * b and m = m + x run in place
+        auto bin = std::dynamic_pointer_cast<BinaryExpr>(mutateStmt->transformation);
+        if (matrixNames.count(mutateStmt->varName) && bin && isMatrixExpr(bin->left) && isMatrixExpr(bin->right)) {
+            auto left = std::dynamic_pointer_cast<Identifier>(bin->left);
+            auto right = std::dynamic_pointer_cast<Identifier>(bin->right);
+            const std::string& target = mutateStmt->varName;
+            require("RuntimeMatrix.hpp");
+            if (bin->op == "*" && left && right && left->name != target && right->name != target) {
+                out << "CaseRuntime::matmulInto(" << target << ", " << left->name << ", " << right->name << ");\n";
+                return;
+            }
+            if (bin->op == "+" && left && left->name == target) {
+                out << "CaseRuntime::addInto(" << target << ", ";
+                emitExpr(bin->right, out);
+                out << ");\n";
+                return;
+            }
+        }
         out << "// Mutate " << mutateStmt->varName << " with transformation\n";
-        out << mutateStmt->varName << " = ";
+        // A scalar is just reassigned; no runtime header needed
+        if (matrixNames.count(mutateStmt->varName) || scalarNames.count(mutateStmt->varName)) {
+            out << mutateStmt->varName << " = ";
+            emitExpr(mutateStmt->transformation, out);
+            out << ";\n";
+            return;
+        }
+        // The lambda parameter shadows the target, so on a collection the
+        // expression is applied to each element
+        require("RuntimeSimd.hpp");
+        out << "CaseRuntime::mutateInPlace(" << mutateStmt->varName << ", [&](auto "
+            << mutateStmt->varName << ") { return ";
         emitExpr(mutateStmt->transformation, out);
-        out << ";\n";
+        out << "; });\n";
     }
     else if (auto scaleStmt = std::dynamic_pointer_cast<ScaleStmt>(node)) {
+        require("RuntimeSimd.hpp");
         out << "// Scale operation\n";
+        out << "CaseRuntime::scaleInPlace(";
         emitExpr(scaleStmt->target, out);
-        out << " *= ";
-        emitExpr(scaleStmt->factor, out);
-        out << ";\n";
+        out << ", ";
+        if (scaleStmt->factor) emitExpr(scaleStmt->factor, out);
+        else out << "1";
+        out << ");\n";
     }
     else if (auto boundsStmt = std::dynamic_pointer_cast<BoundsStmt>(node)) {
+        require("RuntimeSimd.hpp");
         out << "// Bounds check for " << boundsStmt->varName << "\n";
-        out << "if (" << boundsStmt->varName << " < ";
-        emitExpr(boundsStmt->min, out);
-        out << ") " << boundsStmt->varName << " = ";
+        out << "CaseRuntime::clampInPlace(" << boundsStmt->varName << ", ";
         emitExpr(boundsStmt->min, out);
-        out << ";\n";
-        out << "if (" << boundsStmt->varName << " > ";
-        emitExpr(boundsStmt->max, out);
-        out << ") " << boundsStmt->varName << " = ";
+        out << ", ";
         emitExpr(boundsStmt->max, out);
-        out << ";\n";
+        out << ");\n";
     }
     else if (auto checkpointStmt = std::dynamic_pointer_cast<CheckpointStmt>(node)) {
         out << "// Checkpoint: " << checkpointStmt->name << "\n";
@@ -284,6 +757,8 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
     }
     // BATCH 5: Advanced Concurrency
     else if (auto syncStmt = std::dynamic_pointer_cast<SyncStmt>(node)) {
+        require("<mutex>");
+        needsGlobalMutex = true;
         out << "{\n";
         out << "    std::lock_guard<std::mutex> lock(global_mutex);\n";
         out << "    // Synchronized block for: ";
@@ -296,7 +771,13 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << "}\n";
     }
     else if (auto parallelStmt = std::dynamic_pointer_cast<ParallelStmt>(node)) {
+        require("<thread>");
+        require("<vector>");
+        require("RuntimeThreadOutput.hpp");
+        // Earlier Print lines go out before the tasks' own; a task's buffer
+        // is flushed when its thread exits, so before the join returns
         out << "{\n";
+        out << "    CaseRuntime::flushThreadOutput();\n";
         out << "    std::vector<std::thread> threads;\n";
         for (size_t i = 0; i < parallelStmt->tasks.size(); ++i) {
             out << "    threads.emplace_back([&]() {\n";
@@ -307,6 +788,7 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << "}\n";
     }
     else if (auto batchStmt = std::dynamic_pointer_cast<BatchStmt>(node)) {
+        require("<algorithm>");
         out << "// Batch processing: " << batchStmt->dataSource << " (size=" << batchStmt->batchSize << ")\n";
         out << "for (size_t batch_start = 0; batch_start < " << batchStmt->dataSource << ".size(); batch_start += " << batchStmt->batchSize << ") {\n";
         out << "    size_t batch_end = std::min(batch_start + " << batchStmt->batchSize << ", " << batchStmt->dataSource << ".size());\n";
@@ -314,6 +796,7 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << "}\n";
     }
     else if (auto scheduleStmt = std::dynamic_pointer_cast<ScheduleStmt>(node)) {
+        require("<future>");
         out << "// Schedule task: " << scheduleStmt->when << "\n";
         out << "std::async(std::launch::deferred, [&]() {\n";
         emitNode(scheduleStmt->task, out);
@@ -426,22 +909,64 @@ void CodeEmitter::emitNode(NodePtr node, std::ostringstream& out) {
         out << "// Receive network data\n";
         out << "auto " << recvStmt->resultVar << " = " << recvStmt->handle << ".receive();\n";
     }
+    // Expression evaluated for its effect: sort nums [end]
+    else if (std::dynamic_pointer_cast<Expr>(node)) {
+        emitExpr(node, out);
+        out << ";\n";
+    }
 }
 
-void CodeEmitter::emitExpr(NodePtr node, std::ostringstream& out) {
+void CodeEmitter::emitExpr(NodePtr node, EmitBuffer& out) {
     if (auto lit = std::dynamic_pointer_cast<Literal>(node)) {
         out << lit->value;
     }
     else if (auto id = std::dynamic_pointer_cast<Identifier>(node)) {
         out << id->name;
     }
+    else if (auto list = std::dynamic_pointer_cast<ListExpr>(node)) {
+        require("<vector>");
+        if (list->elements.empty()) {
+            out << "std::vector<double>{}";
+            return;
+        }
+        if (!list->elementType.empty()) {
+            if (list->elementType == "std::string") require("<string>");
+            out << "std::vector<" << list->elementType << ">{";
+        } else {
+            out << "std::vector{";
+        }
+        for (size_t i = 0; i < list->elements.size(); ++i) {
+            if (i > 0) out << ", ";
+            // An integer variable in a list of doubles would be a narrowing
+            // conversion inside braces; literals convert exactly
+            bool widen = list->elementType == "double" &&
+                         !std::dynamic_pointer_cast<Literal>(list->elements[i]);
+            if (widen) out << "static_cast<double>(";
+            emitExpr(list->elements[i], out);
+            if (widen) out << ")";
+        }
+        out << "}";
+    }
+    else if (auto hole = std::dynamic_pointer_cast<PlaceholderExpr>(node)) {
+        if (hole->slot >= 0 && hole->slot < static_cast<int>(placeholderNames.size())) {
+            out << placeholderNames[hole->slot];
+        } else {
+            out << "it";
+        }
+    }
     else if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(node)) {
+        if (emitMatrixExpr(bin, out)) return;
         out << "(";
         emitExpr(bin->left, out);
         out << " " << bin->op << " ";
         emitExpr(bin->right, out);
         out << ")";
     }
+    else if (auto unary = std::dynamic_pointer_cast<UnaryExpr>(node)) {
+        out << "(" << unary->op;
+        emitExpr(unary->operand, out);
+        out << ")";
+    }
     else if (auto callExpr = std::dynamic_pointer_cast<CallExpr>(node)) {
         out << callExpr->callee << "(";
         for (size_t i = 0; i < callExpr->args.size(); ++i) {
@@ -452,6 +977,7 @@ void CodeEmitter::emitExpr(NodePtr node, std::ostringstream& out) {
     }
     // Standard Library: Math
     else if (auto mathCall = std::dynamic_pointer_cast<MathCallExpr>(node)) {
+        require("<cmath>");
         out << "std::" << mathCall->function << "(";
         for (size_t i = 0; i < mathCall->args.size(); ++i) {
             if (i > 0) out << ", ";
@@ -461,17 +987,13 @@ void CodeEmitter::emitExpr(NodePtr node, std::ostringstream& out) {
     }
     // Standard Library: Strings
     else if (auto strCall = std::dynamic_pointer_cast<StringCallExpr>(node)) {
-        if (strCall->function == "length" && !strCall->args.empty()) {
-            emitExpr(strCall->args[0], out);
-            out << ".length()";
-        } else {
-            out << "str_" << strCall->function << "(";
-            for (size_t i = 0; i < strCall->args.size(); ++i) {
-                if (i > 0) out << ", ";
-                emitExpr(strCall->args[i], out);
-            }
-            out << ")";
+        require("RuntimeString.hpp");
+        out << "CaseRuntime::str_" << strCall->function << "(";
+        for (size_t i = 0; i < strCall->args.size(); ++i) {
+            if (i > 0) out << ", ";
+            emitExpr(strCall->args[i], out);
         }
+        out << ")";
     }
     // Standard Library: Collections
     else if (auto collCall = std::dynamic_pointer_cast<CollectionCallExpr>(node)) {
@@ -484,17 +1006,242 @@ void CodeEmitter::emitExpr(NodePtr node, std::ostringstream& out) {
             if (!collCall->args.empty()) emitExpr(collCall->args[0], out);
             out << ")";
         } else {
-            out << "coll_" << collCall->function << "(";
+            require("RuntimeCollections.hpp");
+            // Which argument is a function, and the parameters its sections bind
+            const std::string& fn = collCall->function;
+            std::vector<std::string> params;
+            if (fn == "map" || fn == "filter") params = {"it"};
+            else if (fn == "reduce") params = {"acc", "it"};
+            else if (fn == "sort") params = {"a", "b"};
+
+            out << "CaseRuntime::coll_" << fn << "(";
             if (collCall->collection) {
                 emitExpr(collCall->collection, out);
                 if (!collCall->args.empty()) out << ", ";
             }
             for (size_t i = 0; i < collCall->args.size(); ++i) {
                 if (i > 0) out << ", ";
-                emitExpr(collCall->args[i], out);
+                if (i == 0 && !params.empty()) {
+                    emitCallable(collCall->args[i], params, out);
+                } else {
+                    emitExpr(collCall->args[i], out);
+                }
             }
             out << ")";
         }
     }
 }
 
+
+// -----------------------------------------------------------------------------
+// Function arguments of map/filter/reduce/sort
+// -----------------------------------------------------------------------------
+
+// A bare name is passed through as the function itself; anything else is an
+// expression over the parameters -- `(* 2)` or `(+)` fill the open operands
+// with them, and `it`/`acc`/`a`/`b` may be written out by name.
+void CodeEmitter::emitCallable(NodePtr fn, const std::vector<std::string>& params, EmitBuffer& out) {
+    if (std::dynamic_pointer_cast<Identifier>(fn)) {
+        emitExpr(fn, out);
+        return;
+    }
+    out << "[&](";
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (i > 0) out << ", ";
+        out << "const auto& " << params[i];
+    }
+    out << ") { return ";
+    // Slot 0 is the first parameter, slot 1 the second; with one parameter
+    // both name it, so map xs (*) squares
+    std::vector<std::string> saved = std::move(placeholderNames);
+    placeholderNames = params;
+    if (params.size() == 1) placeholderNames.push_back(params[0]);
+    emitExpr(fn, out);
+    placeholderNames = std::move(saved);
+    out << "; }";
+}
+
+// -----------------------------------------------------------------------------
+// Matrix expression lowering
+// -----------------------------------------------------------------------------
+
+bool CodeEmitter::isMatrixExpr(NodePtr expr) const {
+    if (auto id = std::dynamic_pointer_cast<Identifier>(expr)) {
+        return matrixNames.count(id->name) > 0;
+    }
+    if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(expr)) {
+        bool left = isMatrixExpr(bin->left);
+        bool right = isMatrixExpr(bin->right);
+        if (bin->op == "*") return left || right;
+        if (bin->op == "+" || bin->op == "-") return left && right;
+    }
+    return false;
+}
+
+// Lower matrix arithmetic to runtime kernels; false when `bin` is not a matrix op
+bool CodeEmitter::emitMatrixExpr(std::shared_ptr<BinaryExpr> bin, EmitBuffer& out) {
+    if (!isMatrixExpr(bin)) return false;
+    require("RuntimeMatrix.hpp");
+    auto product = [this](NodePtr n) {
+        auto b = std::dynamic_pointer_cast<BinaryExpr>(n);
+        return (b && b->op == "*" && isMatrixExpr(b->left) && isMatrixExpr(b->right)) ? b : nullptr;
+    };
+
+    if (bin->op == "+") {
+        // a * b + c accumulates into a copy of c inside the GEMM
+        auto mul = product(bin->left);
+        NodePtr addend = bin->right;
+        if (!mul) {
+            mul = product(bin->right);
+            addend = bin->left;
+        }
+        if (mul) {
+            out << "CaseRuntime::matmulAdd(";
+            emitExpr(mul->left, out);
+            out << ", ";
+            emitExpr(mul->right, out);
+            out << ", ";
+            emitExpr(addend, out);
+            out << ")";
+            return true;
+        }
+    }
+
+    const char* kernel = nullptr;
+    NodePtr first = bin->left, second = bin->right;
+    if (bin->op == "*") {
+        if (isMatrixExpr(bin->left) && isMatrixExpr(bin->right)) {
+            kernel = "CaseRuntime::matmul(";
+        } else {
+            kernel = "CaseRuntime::scale(";
+            if (!isMatrixExpr(first)) std::swap(first, second);
+        }
+    } else {
+        kernel = (bin->op == "+") ? "CaseRuntime::add(" : "CaseRuntime::sub(";
+    }
+    out << kernel;
+    emitExpr(first, out);
+    out << ", ";
+    emitExpr(second, out);
+    out << ")";
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// compress / decompress lowering
+// -----------------------------------------------------------------------------
+
+void CodeEmitter::emitCodecCall(const std::string& op, NodePtr data, const std::string& algorithm,
+                                const std::string& target, EmitBuffer& out) {
+    require("RuntimeCompress.hpp");
+    auto handle = fileHandles.find(target);
+    if (handle != fileHandles.end() && handle->second != "r" && handle->second != "rw") {
+        // Stream block by block into a buffered file; `data` may be a string or an "r" handle
+        out << "CaseRuntime::Compress::" << op << "Stream(";
+        emitExpr(data, out);
+        out << ", " << target << ", \"" << algorithm << "\");\n";
+        return;
+    }
+    if (target.empty()) {
+        require("RuntimePrint.hpp");
+        out << "CaseRuntime::print(CaseRuntime::Compress::" << op << "(";
+        emitExpr(data, out);
+        out << ", \"" << algorithm << "\"));\n";
+        return;
+    }
+    out << "std::string " << target << " = ";
+    out << "CaseRuntime::Compress::" << op << "(";
+    emitExpr(data, out);
+    out << ", \"" << algorithm << "\");\n";
+}
+
+// -----------------------------------------------------------------------------
+// Struct schema helpers (serialize / deserialize)
+// -----------------------------------------------------------------------------
+
+static bool splitArrayType(const std::string& caseType, std::string& element, std::string& count) {
+    size_t open = caseType.find('[');
+    if (open == std::string::npos || caseType.back() != ']') return false;
+    element = caseType.substr(0, open);
+    count = caseType.substr(open + 1, caseType.size() - open - 2);
+    return true;
+}
+
+std::string CodeEmitter::cppType(const std::string& caseType) const {
+    std::string element, count;
+    if (splitArrayType(caseType, element, count)) {
+        return "std::array<" + cppType(element) + ", " + count + ">";
+    }
+    if (caseType == "string") return "std::string";
+    return caseType;
+}
+
+std::string CodeEmitter::viewType(const std::string& caseType) const {
+    std::string element, count;
+    if (splitArrayType(caseType, element, count)) {
+        return "std::array<" + viewType(element) + ", " + count + ">";
+    }
+    if (caseType == "string") return "std::string_view";
+    if (structTypes.count(caseType)) return caseType + "View";
+    return cppType(caseType);
+}
+
+void CodeEmitter::emitStructCodecs(const StructDecl& decl, EmitBuffer& out) {
+    const std::string& name = decl.name;
+    const std::string view = name + "View";
+
+    // Zero-copy decode target: strings become views into the input buffer
+    out << "struct " << view << " {\n";
+    for (auto& f : decl.fields) {
+        out << "  " << viewType(f.first) << " " << f.second << ";\n";
+    }
+    out << "};\n";
+
+    // Both types encode, so a decoded view can be re-serialized or forwarded
+    for (const std::string* type : { &name, &view }) {
+        out << "inline size_t caseEncodedSize(const " << *type << "& v) {\n";
+        out << "  return 0";
+        for (auto& f : decl.fields) {
+            out << " + CaseRuntime::Serial::sizeOf(v." << f.second << ")";
+        }
+        out << ";\n}\n";
+
+        out << "inline void caseEncode(CaseRuntime::Serial::Writer& w, const " << *type << "& v) {\n";
+        for (auto& f : decl.fields) {
+            out << "  w.field(v." << f.second << ");\n";
+        }
+        if (decl.fields.empty()) out << "  (void)w; (void)v;\n";
+        out << "}\n";
+
+        out << "inline bool caseDecode(CaseRuntime::Serial::Reader& r, " << *type << "& v) {\n";
+        out << "  return true";
+        for (auto& f : decl.fields) {
+            out << " && r.field(v." << f.second << ")";
+        }
+        out << ";\n}\n";
+
+        out << "inline void caseToJson(CaseRuntime::Serial::JsonWriter& j, const " << *type << "& v) {\n";
+        out << "  j.beginObject();\n";
+        for (auto& f : decl.fields) {
+            out << "  j.key(\"" << f.second << "\"); j.value(v." << f.second << ");\n";
+        }
+        out << "  j.endObject();\n";
+        if (decl.fields.empty()) out << "  (void)v;\n";
+        out << "}\n";
+    }
+
+    out << "inline bool caseFromJson(CaseRuntime::Serial::JsonReader& j, " << name << "& v) {\n";
+    out << "  if (!j.beginObject()) return false;\n";
+    out << "  std::string_view k;\n";
+    out << "  while (j.nextKey(k)) {\n";
+    out << "    bool ok = ";
+    for (auto& f : decl.fields) {
+        out << "(k == \"" << f.second << "\") ? j.value(v." << f.second << ") : ";
+    }
+    out << "j.skipValue();\n";
+    out << "    if (!ok) return false;\n";
+    out << "  }\n";
+    if (decl.fields.empty()) out << "  (void)v;\n";
+    out << "  return j.ok();\n";
+    out << "}\n\n";
+}
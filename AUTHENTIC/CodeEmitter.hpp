@@ -4,14 +4,110 @@
 
 #pragma once
 #include "AST.hpp"
-#include <sstream>
+#include "EmitBuffer.hpp"
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// A program laid out for separate compilation: a header with the includes,
+// types, prototypes and generic (template / auto) functions, and source
+// files that include it, the first of which holds main()
+struct SplitProgram {
+    EmitBuffer header;
+    std::vector<EmitBuffer> units;
+};
 
 class CodeEmitter {
 public:
+    // Appends the program to `out`, which the caller can clear() and reuse;
+    // write it out with out.writeToFile()
+    void emit(NodePtr root, EmitBuffer& out);
     std::string emit(NodePtr root);
+    // Up to `units` source files, balanced by size; each includes `headerName`
+    void emitSplit(NodePtr root, size_t units, const std::string& headerName, SplitProgram& out);
+
+    // Include the umbrella CaseRuntime.hpp (built once as a precompiled
+    // header) instead of the per-program minimal header set
+    void setPrecompiledRuntime(bool enabled);
+
+    // Emit top-level functions on the runtime thread pool, each into its own
+    // buffer, and join them in source order. Output is identical to serial.
+    void setParallelFunctions(bool enabled);
 
 private:
-    void emitNode(NodePtr node, std::ostringstream& out);
-    void emitExpr(NodePtr expr, std::ostringstream& out);
+    // Everything the program declares lives here, so a top-level `let index`
+    // or `Fn exp` cannot collide with a C library name at global scope
+    static constexpr const char* PROGRAM_NAMESPACE = "case_program";
+    // Headers the emitted code needs: <std> names and runtime file names
+    std::set<std::string> includes;
+    bool precompiledRuntime = false;
+    bool parallelFunctions = false;
+    // Generic functions end up in a shared header and are emitted inline
+    bool splitting = false;
+    // `sync` blocks lock one program-wide mutex
+    bool needsGlobalMutex = false;
+    // serialize/deserialize appear somewhere; struct codecs are kept only then
+    bool usesSerialization = false;
+    // Struct schemas seen so far, used for serialize/deserialize lowering
+    std::unordered_map<std::string, std::shared_ptr<StructDecl>> structTypes;
+    // File handles from `open`, by name -> mode
+    std::unordered_map<std::string, std::string> fileHandles;
+    // Variables declared so far (let, input)
+    std::unordered_set<std::string> declaredNames;
+    // Variables holding a CaseRuntime::Matrix
+    std::unordered_set<std::string> matrixNames;
+    // Variables TypeInference typed as a bool, number or string
+    std::unordered_set<std::string> scalarNames;
+    // Top-level `let`s that live at namespace scope; every function starts
+    // out seeing these and nothing else of main()
+    std::unordered_set<std::string> globalNames;
+    std::unordered_set<std::string> globalScalars;
+    // Lambda parameter names the open slots of an operator section stand for
+    std::vector<std::string> placeholderNames;
+
+    // The program before it is laid out into one file or several
+    struct Definition {
+        EmitBuffer code;
+        std::shared_ptr<FunctionDecl> fn;  // null for struct/enum/union/typedef
+        EmitBuffer codecs;                 // a struct's View type and codec hooks
+    };
+    struct Sections {
+        EmitBuffer globals;                   // top-level lets, at namespace scope
+        EmitBuffer prototypes;
+        std::vector<Definition> definitions;  // source order
+        EmitBuffer body;                      // statements of main()
+        std::vector<std::string> names;       // globals and functions, in source order
+    };
+    void emitSections(NodePtr root, Sections& sections);
+    void emitIncludes(EmitBuffer& out);
+    void emitMain(EmitBuffer&& body, const std::vector<std::string>& names, EmitBuffer& out);
+    static bool isGeneric(const FunctionDecl& fn);
+
+    void require(const std::string& header);
+    bool isDeclaration(NodePtr node) const;
+    static bool isConstantInitializer(NodePtr expr);
+    // Declares a top-level `let` at namespace scope; false leaves it to main()
+    bool emitGlobal(const VarDecl& decl, EmitBuffer& out);
+    void emitInitializer(const VarDecl& decl, EmitBuffer& out);
+    void emitFunctionSignature(const FunctionDecl& fn, EmitBuffer& out);
+    void emitFunctionPrototype(const FunctionDecl& fn, EmitBuffer& out);
+    // Top-level structs in source order; a function sees the ones before it
+    using StructList = std::vector<std::shared_ptr<StructDecl>>;
+    void emitFunction(const FunctionDecl& fn, const StructList& structs, size_t visible, EmitBuffer& out);
+    std::vector<EmitBuffer> emitFunctionsParallel(const std::vector<std::shared_ptr<FunctionDecl>>& functions,
+                                                  const StructList& structs, const std::vector<size_t>& visible);
+    void emitNode(NodePtr node, EmitBuffer& out);
+    void emitExpr(NodePtr expr, EmitBuffer& out);
+
+    // C.A.S.E. field type -> C++ type (owning, and zero-copy view variant)
+    std::string cppType(const std::string& caseType) const;
+    std::string viewType(const std::string& caseType) const;
+    void emitStructCodecs(const StructDecl& decl, EmitBuffer& out);
+    bool isMatrixExpr(NodePtr expr) const;
+    bool emitMatrixExpr(std::shared_ptr<BinaryExpr> bin, EmitBuffer& out);
+    void emitCallable(NodePtr fn, const std::vector<std::string>& params, EmitBuffer& out);
+    void emitCodecCall(const std::string& op, NodePtr data, const std::string& algorithm,
+                       const std::string& target, EmitBuffer& out);
 };
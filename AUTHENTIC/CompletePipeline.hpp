@@ -90,7 +90,7 @@ bool enableDoziSecondSync;
         bool generateDebugInfo;
         bool dumpIR;
         bool dumpOptimizedIR;
-        bool dumpAsm;
+        bool dumpAsm;  // the AOT listing and perf map (--dump-asm)
    
     Configuration()
       : outputFilename("output.exe")
@@ -0,0 +1,173 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Emit Buffer
+//  Append-only output for CodeEmitter. Text goes into fixed 64 KiB chunks
+//  that are never moved or copied once written: growing the buffer adds a
+//  chunk, appending one buffer to another moves its chunks over, and the
+//  finished program goes from the chunks straight to a file descriptor.
+//  clear() keeps the chunks, so an emitter reuses its allocations across
+//  programs.
+//=============================================================================
+
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+class EmitBuffer {
+public:
+    static constexpr size_t CHUNK_SIZE = 1u << 16;
+
+    EmitBuffer() = default;
+    EmitBuffer(EmitBuffer&&) = default;
+    EmitBuffer& operator=(EmitBuffer&&) = default;
+    EmitBuffer(const EmitBuffer&) = delete;
+    EmitBuffer& operator=(const EmitBuffer&) = delete;
+
+    // Fast path: one memcpy while the text fits the current chunk
+    void write(std::string_view s) {
+        if (chunks.empty()) grow();
+        for (;;) {
+            Chunk& chunk = chunks[current];
+            size_t n = std::min(s.size(), CHUNK_SIZE - chunk.used);
+            std::memcpy(chunk.data.get() + chunk.used, s.data(), n);
+            chunk.used += n;
+            total += n;
+            if (n == s.size()) return;
+            s.remove_prefix(n);
+            grow();
+        }
+    }
+
+    void put(char c) {
+        if (chunks.empty() || chunks[current].used == CHUNK_SIZE) grow();
+        Chunk& chunk = chunks[current];
+        chunk.data[chunk.used++] = c;
+        ++total;
+    }
+
+    // Stream-style chaining, so emitter code reads `out << a << b`
+    EmitBuffer& operator<<(std::string_view s) { write(s); return *this; }
+    EmitBuffer& operator<<(const std::string& s) { write(s); return *this; }
+    EmitBuffer& operator<<(const char* s) { write(s); return *this; }
+    EmitBuffer& operator<<(char c) { put(c); return *this; }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                      !std::is_same<T, char>::value>>
+    EmitBuffer& operator<<(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        write(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+        return *this;
+    }
+
+    // Moves the other buffer's chunks to the end of this one; nothing is copied
+    // and `other` is left empty
+    void append(EmitBuffer&& other) {
+        if (other.total == 0) return;
+        if (total == 0) {
+            *this = std::move(other);
+        } else {
+            chunks.resize(current + 1);  // drop spare chunks kept by clear()
+            for (size_t i = 0; i <= other.current; ++i) chunks.push_back(std::move(other.chunks[i]));
+            current = chunks.size() - 1;
+            total += other.total;
+        }
+        other.chunks.clear();
+        other.current = 0;
+        other.total = 0;
+    }
+
+    // Empties the buffer but keeps its chunks for the next program
+    void clear() {
+        for (auto& chunk : chunks) chunk.used = 0;
+        current = 0;
+        total = 0;
+    }
+
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+
+    std::string str() const {
+        std::string text;
+        text.reserve(total);
+        forEachChunk([&](const char* data, size_t n) { text.append(data, n); });
+        return text;
+    }
+
+    bool writeTo(int fd) const {
+        bool ok = true;
+        forEachChunk([&](const char* data, size_t n) {
+            while (ok && n > 0) {
+#ifdef _WIN32
+                int written = ::_write(fd, data, static_cast<unsigned>(n));
+#else
+                ssize_t written = ::write(fd, data, n);
+                if (written < 0 && errno == EINTR) continue;
+#endif
+                if (written <= 0) {
+                    ok = false;
+                    break;
+                }
+                data += written;
+                n -= static_cast<size_t>(written);
+            }
+        });
+        return ok;
+    }
+
+    // Replaces `path` with the buffer contents
+    bool writeToFile(const std::string& path) const {
+#ifdef _WIN32
+        int fd = ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        if (fd < 0) return false;
+        bool ok = writeTo(fd);
+#ifdef _WIN32
+        ok = (::_close(fd) == 0) && ok;
+#else
+        ok = (::close(fd) == 0) && ok;
+#endif
+        return ok;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t used = 0;
+    };
+
+    std::vector<Chunk> chunks;
+    // Chunk being written; those after it are spares left by clear()
+    size_t current = 0;
+    size_t total = 0;
+
+    void grow() {
+        if (!chunks.empty() && current + 1 < chunks.size()) {
+            ++current;
+            return;
+        }
+        chunks.push_back(Chunk{std::unique_ptr<char[]>(new char[CHUNK_SIZE]), 0});
+        current = chunks.size() - 1;
+    }
+
+    template <typename Fn>
+    void forEachChunk(Fn&& fn) const {
+        for (size_t i = 0; i < chunks.size() && i <= current; ++i) {
+            if (chunks[i].used > 0) fn(chunks[i].data.get(), chunks[i].used);
+        }
+    }
+};
@@ -4,27 +4,414 @@
 //=============================================================================
 
 #include "MachineCodeEmitter.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <cstring>
+#include <unordered_set>
+
+// -----------------------------------------------------------------------------
+// CodeSection fixups
+// -----------------------------------------------------------------------------
+
+namespace {
+
+// One relocation as resolve() sees it
+struct Branch {
+    uint32_t offset = 0;      // instruction start as emitted
+    uint32_t length = 0;      // 5 (jmp, call) or 6 (jcc); 0 if not a branch
+    uint32_t target = 0;      // label offset as emitted
+    uint8_t condition = 0;    // jcc condition nibble
+    bool conditional = false;
+    bool relaxable = false;   // call has no rel8 form
+    bool resolved = false;
+    bool isShort = false;
+};
+
+void writeRel32(std::vector<uint8_t>& out, int32_t disp) {
+    uint32_t d = static_cast<uint32_t>(disp);
+    out.push_back(d & 0xFF);
+    out.push_back((d >> 8) & 0xFF);
+    out.push_back((d >> 16) & 0xFF);
+    out.push_back((d >> 24) & 0xFF);
+}
+
+// Decimal integers and true/false: the only literals a register holds.
+// A decimal or text value is not read as its leading digits or as 0.
+bool integerLiteral(const std::string& text, int64_t& value) {
+    if (text == "true" || text == "false") {
+        value = text == "true";
+        return true;
+    }
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    size_t used = 0;
+    try {
+        value = static_cast<int64_t>(std::stoull(text, &used));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return used == text.size();
+}
+
+} // namespace
+
+bool CIAM::CodeSection::resolve() {
+    unresolved.clear();
+    std::unordered_set<std::string> missing;
+
+    // relocations are recorded as code is appended, so already in offset order
+    std::vector<Branch> branches(relocations.size());
+    for (size_t i = 0; i < relocations.size(); ++i) {
+        Branch& b = branches[i];
+        b.offset = relocations[i].first;
+        uint8_t op = code[b.offset];
+        if (op == 0xE8) {
+            b.length = 5;
+        } else if (op == 0xE9) {
+            b.length = 5;
+            b.relaxable = true;
+        } else if (op == 0x0F && (code[b.offset + 1] & 0xF0) == 0x80) {
+            b.length = 6;
+            b.condition = code[b.offset + 1] & 0x0F;
+            b.conditional = true;
+            b.relaxable = true;
+        } else {
+            continue;
+        }
+        auto label = labels.find(relocations[i].second);
+        if (label != labels.end()) {
+            b.target = label->second;
+            b.resolved = true;
+        } else {
+            b.relaxable = false;
+            if (missing.insert(relocations[i].second).second) unresolved.push_back(relocations[i].second);
+        }
+    }
+
+    // shrunk[i]: bytes removed by the short branches among the first i
+    std::vector<uint32_t> shrunk(branches.size() + 1, 0);
+    auto moved = [&](uint32_t offset) {
+        auto before = std::lower_bound(branches.begin(), branches.end(), offset,
+                                       [](const Branch& b, uint32_t at) { return b.offset < at; });
+        return static_cast<int64_t>(offset) - shrunk[static_cast<size_t>(before - branches.begin())];
+    };
+
+    // Start with every branch long and shorten those that fit; shortening
+    // only ever brings targets closer, so this settles
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 0; i < branches.size(); ++i) {
+            shrunk[i + 1] = shrunk[i] + (branches[i].isShort ? branches[i].length - 2 : 0);
+        }
+        for (auto& b : branches) {
+            if (!b.relaxable || b.isShort) continue;
+            // A forward target moves back with the end of the branch itself
+            int64_t disp = moved(b.target) - (moved(b.offset) + 2);
+            if (b.target > b.offset) disp -= b.length - 2;
+            if (disp >= -128 && disp <= 127) {
+                b.isShort = true;
+                changed = true;
+            }
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(code.size() - shrunk.back());
+    uint32_t copied = 0;
+    for (auto& b : branches) {
+        if (b.length == 0) continue;
+        out.insert(out.end(), code.begin() + copied, code.begin() + b.offset);
+        copied = b.offset + b.length;
+        int64_t start = static_cast<int64_t>(out.size());
+        if (b.isShort) {
+            out.push_back(b.conditional ? static_cast<uint8_t>(0x70 | b.condition) : 0xEB);
+            out.push_back(static_cast<uint8_t>(static_cast<int8_t>(moved(b.target) - (start + 2))));
+            ++shortBranches;
+        } else {
+            out.insert(out.end(), code.begin() + b.offset, code.begin() + b.offset + b.length - 4);
+            writeRel32(out, b.resolved ? static_cast<int32_t>(moved(b.target) - (start + b.length)) : 0);
+        }
+    }
+    out.insert(out.end(), code.begin() + copied, code.end());
+
+    for (auto& label : labels) label.second = static_cast<uint32_t>(moved(label.second));
+    for (auto& reloc : relocations) reloc.first = static_cast<uint32_t>(moved(reloc.first));
+    for (auto& ref : dataReferences) ref.field = static_cast<uint32_t>(moved(ref.field));
+    for (auto& inst : listed) inst.offset = static_cast<uint32_t>(moved(inst.offset));
+    bytesSaved += shrunk.back();
+    code.swap(out);
+    return unresolved.empty();
+}
+
+void CIAM::CodeSection::link(uint64_t codeAddress, uint64_t rodataAddress, uint64_t bssAddress) {
+    for (auto& ref : dataReferences) {
+        uint64_t target = (ref.segment == Segment::Rodata ? rodataAddress : bssAddress) + ref.offset;
+        // RIP is the address of the next instruction, just past the field
+        int64_t disp = static_cast<int64_t>(target) - static_cast<int64_t>(codeAddress + ref.field + 4);
+        uint32_t d = static_cast<uint32_t>(static_cast<int32_t>(disp));
+        for (int i = 0; i < 4; ++i) code[ref.field + i] = static_cast<uint8_t>(d >> (8 * i));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Register allocation
+// -----------------------------------------------------------------------------
+
+namespace {
+
+// Virtual-register sets for liveness, one bit per register
+struct RegisterSet {
+    std::vector<uint64_t> words;
+
+    explicit RegisterSet(int registers = 0) : words((static_cast<size_t>(registers) + 63) / 64, 0) {}
+    void insert(int v) { words[static_cast<size_t>(v) >> 6] |= uint64_t(1) << (v & 63); }
+    void erase(int v) { words[static_cast<size_t>(v) >> 6] &= ~(uint64_t(1) << (v & 63)); }
+    bool contains(int v) const { return (words[static_cast<size_t>(v) >> 6] >> (v & 63)) & 1; }
+
+    // this |= other, reporting whether anything was added
+    bool merge(const RegisterSet& other) {
+        bool changed = false;
+        for (size_t i = 0; i < words.size(); ++i) {
+            uint64_t merged = words[i] | other.words[i];
+            changed |= merged != words[i];
+            words[i] = merged;
+        }
+        return changed;
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < words.size(); ++i) {
+            for (uint64_t w = words[i]; w; w &= w - 1) fn(static_cast<int>(i * 64 + __builtin_ctzll(w)));
+        }
+    }
+};
+
+bool endsBlock(CIAM::VOp op) {
+    return op == CIAM::VOp::Jump || op == CIAM::VOp::Branch || op == CIAM::VOp::Return;
+}
+
+const CIAM::Reg callerSavedPool[] = {CIAM::Reg::RSI, CIAM::Reg::RDI, CIAM::Reg::R8, CIAM::Reg::R9, CIAM::Reg::R10};
+const CIAM::Reg calleeSavedPool[] = {CIAM::Reg::RBX, CIAM::Reg::R12, CIAM::Reg::R13, CIAM::Reg::R14, CIAM::Reg::R15};
+
+} // namespace
+
+std::vector<RegisterAllocator::Interval> RegisterAllocator::buildIntervals(const CIAM::VFunction& fn) const {
+    const auto& code = fn.code;
+    const int n = static_cast<int>(code.size());
+
+    // Basic blocks: a label starts one, a jump or return ends one
+    std::vector<int> starts;
+    std::unordered_map<std::string, size_t> blockOf;
+    for (int i = 0; i < n; ++i) {
+        bool leader = i == 0 || code[i].op == CIAM::VOp::Label || endsBlock(code[i - 1].op);
+        if (leader && (starts.empty() || starts.back() != i)) starts.push_back(i);
+        if (code[i].op == CIAM::VOp::Label) blockOf[code[i].label] = starts.size() - 1;
+    }
+    const size_t blocks = starts.size();
+    auto blockEnd = [&](size_t b) { return b + 1 < blocks ? starts[b + 1] - 1 : n - 1; };
+
+    // Upward-exposed uses and definitions per block
+    std::vector<RegisterSet> uses(blocks, RegisterSet(fn.registers)), defs(blocks, RegisterSet(fn.registers));
+    std::vector<std::vector<size_t>> successors(blocks);
+    for (size_t b = 0; b < blocks; ++b) {
+        for (int i = starts[b]; i <= blockEnd(b); ++i) {
+            const CIAM::VInst& inst = code[i];
+            for (int v : {inst.a, inst.b}) {
+                if (v >= 0 && !defs[b].contains(v)) uses[b].insert(v);
+            }
+            for (int v : inst.args) {
+                if (!defs[b].contains(v)) uses[b].insert(v);
+            }
+            if (inst.dst >= 0) defs[b].insert(inst.dst);
+        }
+        const CIAM::VInst& last = code[blockEnd(b)];
+        if (last.op == CIAM::VOp::Jump || last.op == CIAM::VOp::Branch) {
+            auto target = blockOf.find(last.label);
+            if (target != blockOf.end()) successors[b].push_back(target->second);
+        }
+        bool fallsThrough = last.op != CIAM::VOp::Jump && last.op != CIAM::VOp::Return;
+        if (fallsThrough && b + 1 < blocks) successors[b].push_back(b + 1);
+    }
+
+    // live-in = uses | (live-out - defs), to a fixed point
+    std::vector<RegisterSet> liveIn(blocks, RegisterSet(fn.registers)), liveOut(blocks, RegisterSet(fn.registers));
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t b = blocks; b-- > 0;) {
+            for (size_t s : successors[b]) changed |= liveOut[b].merge(liveIn[s]);
+            RegisterSet in = liveOut[b];
+            for (size_t w = 0; w < in.words.size(); ++w) in.words[w] &= ~defs[b].words[w];
+            in.merge(uses[b]);
+            changed |= liveIn[b].merge(in);
+        }
+    }
+
+    // One interval per register, from its first to its last live point
+    std::vector<int> first(static_cast<size_t>(fn.registers), n), last(static_cast<size_t>(fn.registers), -1);
+    auto extend = [&](int v, int at) {
+        first[v] = std::min(first[v], at);
+        last[v] = std::max(last[v], at);
+    };
+    // The parameters all arrive on entry, so they are live together until
+    // the last of them is in place
+    int lastParam = -1;
+    while (lastParam + 1 < n && code[lastParam + 1].op == CIAM::VOp::Param) ++lastParam;
+    for (int i = 0; i <= lastParam; ++i) {
+        extend(code[i].dst, 0);
+        extend(code[i].dst, lastParam);
+    }
+    std::vector<int> calls;
+    for (size_t b = 0; b < blocks; ++b) {
+        liveIn[b].forEach([&](int v) { extend(v, starts[b]); });
+        liveOut[b].forEach([&](int v) { extend(v, blockEnd(b)); });
+        for (int i = starts[b]; i <= blockEnd(b); ++i) {
+            const CIAM::VInst& inst = code[i];
+            for (int v : {inst.a, inst.b, inst.dst}) {
+                if (v >= 0) extend(v, i);
+            }
+            for (int v : inst.args) extend(v, i);
+            if (inst.op == CIAM::VOp::Call) calls.push_back(i);
+        }
+    }
+
+    std::vector<Interval> intervals;
+    for (int v = 0; v < fn.registers; ++v) {
+        if (last[v] < 0) continue;
+        auto call = std::upper_bound(calls.begin(), calls.end(), first[v]);
+        intervals.push_back({v, first[v], last[v], call != calls.end() && *call < last[v]});
+    }
+    std::sort(intervals.begin(), intervals.end(),
+              [](const Interval& x, const Interval& y) { return x.start < y.start; });
+    return intervals;
+}
+
+RegisterAllocator::Result RegisterAllocator::allocate(const CIAM::VFunction& fn) const {
+    Result result;
+    result.locations.resize(static_cast<size_t>(fn.registers));
+
+    struct Active {
+        Interval interval;
+        CIAM::Reg reg;
+    };
+    std::vector<Active> active;  // by increasing end
+    std::vector<CIAM::Reg> free(std::begin(callerSavedPool), std::end(callerSavedPool));
+    free.insert(free.end(), std::begin(calleeSavedPool), std::end(calleeSavedPool));
+    bool usedCalleeSaved[16] = {};
+
+    auto spill = [&](int vreg) {
+        result.locations[vreg] = CIAM::Location{CIAM::Reg::NONE, result.spillSlots++};
+        ++result.spilled;
+    };
+    auto assign = [&](const Interval& interval, CIAM::Reg reg) {
+        result.locations[interval.vreg] = CIAM::Location{reg, -1};
+        if (isCalleeSaved(reg)) usedCalleeSaved[static_cast<uint8_t>(reg)] = true;
+        Active entry{interval, reg};
+        active.insert(std::upper_bound(active.begin(), active.end(), entry,
+                                       [](const Active& x, const Active& y) { return x.interval.end < y.interval.end; }),
+                      entry);
+    };
+
+    for (const Interval& interval : buildIntervals(fn)) {
+        // Registers whose values are dead by now; an interval that ends
+        // where this one starts is read by the instruction that writes this
+        while (!active.empty() && active.front().interval.end <= interval.start) {
+            free.push_back(active.front().reg);
+            active.erase(active.begin());
+        }
+
+        // Caller-saved first when nothing clobbers them during the interval
+        auto eligible = [&](CIAM::Reg reg) { return !interval.crossesCall || isCalleeSaved(reg); };
+        auto pick = free.end();
+        for (const CIAM::Reg* pool : {callerSavedPool, calleeSavedPool}) {
+            for (int i = 0; i < 5 && pick == free.end(); ++i) {
+                if (eligible(pool[i])) pick = std::find(free.begin(), free.end(), pool[i]);
+            }
+        }
+        if (pick != free.end()) {
+            CIAM::Reg reg = *pick;
+            free.erase(pick);
+            assign(interval, reg);
+            continue;
+        }
+
+        // Full: spill whichever of this and the active intervals it could
+        // take a register from ends last
+        auto victim = active.rend();
+        for (auto it = active.rbegin(); it != active.rend(); ++it) {
+            if (eligible(it->reg)) {
+                victim = it;
+                break;
+            }
+        }
+        if (victim != active.rend() && victim->interval.end > interval.end) {
+            CIAM::Reg reg = victim->reg;
+            spill(victim->interval.vreg);
+            active.erase(std::next(victim).base());
+            assign(interval, reg);
+        } else {
+            spill(interval.vreg);
+        }
+    }
+
+    for (CIAM::Reg reg : calleeSavedPool) {
+        if (usedCalleeSaved[static_cast<uint8_t>(reg)]) result.calleeSaved.push_back(reg);
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// Emission
+// -----------------------------------------------------------------------------
 
 std::vector<uint8_t> MachineCodeEmitter::emit(NodePtr root) {
     std::cout << "\n\033[1;35m[CIAM AOT]\033[0m Direct machine code emission started\n";
-    
-    // Emit entry point
-  section.emitLabel("_start");
-    
-    // Emit prologue
-    section.emitBytes(CIAM::X64Builder::PUSH_REG(CIAM::Reg::RBP).bytes);
-    auto movInst = CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RBP, 0);
-    // MOV RBP, RSP equivalent (simplified)
-    section.emitBytes({0x48, 0x89, 0xE5});  // mov rbp, rsp
-    
-  // Emit main code
+
+    // Lower the entry code, then each function it declares, to virtual code
+    std::vector<CIAM::VFunction> units(1);
+    units[0].name = "_start";
+    units[0].entry = true;
+    current = &units[0];
+    scopes.assign(1, {});
     emitNode(root);
-    
-    // Emit exit syscall
-    emitSystemExit(0);
+    for (size_t i = 0; i < functions.size(); ++i) {
+        units.emplace_back();
+        current = &units.back();
+        emitFunction(functions[i]);
+    }
+    current = nullptr;
+
+    // The exit path flushes output, so know before encoding whether any
+    // function prints
+    for (auto& unit : units) {
+        for (auto& inst : unit.code) {
+            if (inst.op == CIAM::VOp::PrintNumber) usesPrintNumber = true;
+            if (inst.op == CIAM::VOp::PrintNumber || inst.op == CIAM::VOp::PrintString) useOutput();
+            if (inst.op == CIAM::VOp::Input) useInput();
+        }
+    }
+
+    // Allocate and encode each one; the entry code comes first
+    for (auto& unit : units) encodeFunction(unit);
+    emitRuntime();
+
+    section.resolve();
+    // Variables nothing declared are unresolved as much as calls nothing defines
+    section.unresolved.insert(section.unresolved.end(), unknownVariables.begin(), unknownVariables.end());
+    for (auto& name : section.unresolved) {
+        std::cerr << "\033[1;31m[CIAM AOT]\033[0m Unresolved symbol: " << name << "\n";
+    }
+    for (auto& value : unsupported) {
+        std::cerr << "\033[1;31m[CIAM AOT]\033[0m Unsupported literal: " << value << " (integers only)\n";
+    }
+    std::cout << "\033[1;35m[CIAM AOT]\033[0m Registers: " << allocationStats.values << " values, "
+              << allocationStats.spilled << " spilled to " << allocationStats.spillSlots << " stack slots ("
+              << allocationStats.reloads << " reloads, " << allocationStats.stores << " stores)\n";
+    std::cout << "\033[1;35m[CIAM AOT]\033[0m Fixups: " << section.relocations.size() << " branches, "
+              << section.shortBranches << " relaxed to rel8 (" << section.bytesSaved << " bytes saved)\n";
     
     std::cout << "\033[1;35m[CIAM AOT]\033[0m Generated " << section.code.size() 
         << " bytes of machine code\n";
@@ -32,11 +419,28 @@ std::vector<uint8_t> MachineCodeEmitter::emit(NodePtr root) {
     return section.code;
 }
 
+int MachineCodeEmitter::lookupVariable(const std::string& name) const {
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+        auto found = scope->find(name);
+        if (found != scope->end()) return found->second;
+    }
+    return -1;
+}
+
+int MachineCodeEmitter::declareVariable(const std::string& name) {
+    int vreg = current->newRegister();
+    scopes.back()[name] = vreg;
+    return vreg;
+}
+
 void MachineCodeEmitter::emitNode(NodePtr node) {
+    if (node && node->line > 0) sourceLine = node->line;
     if (auto block = std::dynamic_pointer_cast<Block>(node)) {
+        scopes.emplace_back();
  for (auto& stmt : block->statements) {
     emitNode(stmt);
         }
+        scopes.pop_back();
     }
     else if (auto print = std::dynamic_pointer_cast<PrintStmt>(node)) {
         emitPrint(print->expr);
@@ -44,8 +448,12 @@ void MachineCodeEmitter::emitNode(NodePtr node) {
     else if (auto varDecl = std::dynamic_pointer_cast<VarDecl>(node)) {
         emitVarDecl(varDecl->name, varDecl->initializer);
     }
+    else if (auto mutate = std::dynamic_pointer_cast<MutateStmt>(node)) {
+        emitAssign(mutate->varName, mutate->transformation);
+    }
     else if (auto fn = std::dynamic_pointer_cast<FunctionDecl>(node)) {
- emitFunction(fn->name, fn->body);
+        // Lowered on its own once the entry code is done
+        functions.push_back(fn);
     }
     else if (auto ret = std::dynamic_pointer_cast<ReturnStmt>(node)) {
         emitReturn(ret->value);
@@ -57,218 +465,1416 @@ void MachineCodeEmitter::emitNode(NodePtr node) {
         emitWhileStmt(whileStmt->condition, whileStmt->block);
     }
     else if (auto call = std::dynamic_pointer_cast<CallExpr>(node)) {
-        // Emit function call
-      section.addRelocation(call->callee);
-     section.emitBytes(CIAM::X64Builder::CALL_REL32(0).bytes);
+        emitCall(call, false);
+    }
+    else if (auto input = std::dynamic_pointer_cast<InputStmt>(node)) {
+        emitInput(input);
     }
     // Add more node types as needed
 }
 
-CIAM::Reg MachineCodeEmitter::emitExpr(NodePtr expr) {
+int MachineCodeEmitter::emitExpr(NodePtr expr) {
     if (auto lit = std::dynamic_pointer_cast<Literal>(expr)) {
-        // Parse literal value
-        uint64_t value = 0;
-        try {
-       value = std::stoull(lit->value);
-        } catch (...) {
-            // Handle string literals differently
-            value = 0;
-        }
-        
-        CIAM::Reg reg = regAlloc.allocate("_temp" + std::to_string(labelCounter++));
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(reg, value).bytes);
-        return reg;
+        int64_t value = 0;
+        if (!integerLiteral(lit->value, value)) unsupported.push_back(lit->value);
+        CIAM::VInst& inst = append(CIAM::VOp::MovImm);
+        inst.dst = current->newRegister();
+        inst.imm = value;
+        return inst.dst;
     }
     else if (auto id = std::dynamic_pointer_cast<Identifier>(expr)) {
-  return regAlloc.getReg(id->name);
+        int vreg = lookupVariable(id->name);
+        if (vreg >= 0) return vreg;
+        int64_t value = 0;
+        bool constant = integerLiteral(id->name, value);
+        if (!constant && std::find(unknownVariables.begin(), unknownVariables.end(), id->name) == unknownVariables.end()) {
+            unknownVariables.push_back(id->name);
+        }
+        CIAM::VInst& inst = append(CIAM::VOp::MovImm);
+        inst.dst = current->newRegister();
+        inst.imm = value;
+        return inst.dst;
     }
     else if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(expr)) {
-        CIAM::Reg left = emitExpr(bin->left);
-CIAM::Reg right = emitExpr(bin->right);
-        
-  if (bin->op == "+") {
-    section.emitBytes(CIAM::X64Builder::ADD_REG_REG(left, right).bytes);
+        static const std::unordered_map<std::string, CIAM::VOp> arithmetic = {
+            {"+", CIAM::VOp::Add}, {"-", CIAM::VOp::Sub}, {"*", CIAM::VOp::Mul},
+            {"/", CIAM::VOp::Div}, {"%", CIAM::VOp::Mod}, {"&", CIAM::VOp::And},
+            {"|", CIAM::VOp::Or}, {"^", CIAM::VOp::Xor}, {"<<", CIAM::VOp::Shl},
+            {">>", CIAM::VOp::Sar}};
+        CIAM::VOp op;
+        CIAM::Cond cc = CIAM::Cond::E;
+        auto found = arithmetic.find(bin->op);
+  if (found != arithmetic.end()) {
+            op = found->second;
+        }
+        else if (comparison(bin->op, cc)) {
+            op = CIAM::VOp::SetCond;
         }
-      else if (bin->op == "-") {
-            section.emitBytes(CIAM::X64Builder::SUB_REG_REG(left, right).bytes);
+        else if (bin->op == "&&" || bin->op == "||") {
+            // 0 or 1 through the branches, so the right side only runs
+            // when it decides the result
+            int result = current->newRegister();
+            std::string done = generateLabel("logic");
+            append(CIAM::VOp::MovImm).dst = result;
+            emitBranch(expr, false, done);
+            CIAM::VInst& one = append(CIAM::VOp::MovImm);
+            one.dst = result;
+            one.imm = 1;
+            append(CIAM::VOp::Label).label = done;
+            return result;
         }
-        else if (bin->op == "*") {
-          section.emitBytes(CIAM::X64Builder::IMUL_REG_REG(left, right).bytes);
+        else {
+            // Not lowered: the left operand stands in for the result
+            int left = emitExpr(bin->left);
+            emitExpr(bin->right);
+            return left;
         }
-      
-     regAlloc.free(right);
-        return left;
+
+        CIAM::VInst& inst = appendBinary(op, bin->left, bin->right, cc);
+        inst.dst = current->newRegister();
+        return inst.dst;
+    }
+    else if (auto unary = std::dynamic_pointer_cast<UnaryExpr>(expr)) {
+        int32_t constant = 0;
+        if (unary->op == "-" && constantOperand(unary->operand, constant)) {
+            CIAM::VInst& inst = append(CIAM::VOp::MovImm);
+            inst.dst = current->newRegister();
+            inst.imm = -static_cast<int64_t>(constant);
+            return inst.dst;
+        }
+        int operand = emitExpr(unary->operand);
+        CIAM::VInst& inst = append(unary->op == "-" ? CIAM::VOp::Neg
+                                   : unary->op == "~" ? CIAM::VOp::Not : CIAM::VOp::SetCond);
+        inst.a = operand;
+        // !x is x == 0
+        inst.immediate = true;
+        inst.dst = current->newRegister();
+        return inst.dst;
+    }
+    else if (auto call = std::dynamic_pointer_cast<CallExpr>(expr)) {
+        return emitCall(call, true);
     }
     
-    return CIAM::Reg::RAX;
+    CIAM::VInst& inst = append(CIAM::VOp::MovImm);
+    inst.dst = current->newRegister();
+    return inst.dst;
 }
 
 void MachineCodeEmitter::emitPrint(NodePtr expr) {
     if (auto lit = std::dynamic_pointer_cast<Literal>(expr)) {
         // String literal
-      if (lit->value.front() == '"') {
-            std::string str = lit->value.substr(1, lit->value.length() - 2);
-            emitPrintString(str);
+      if (!lit->value.empty() && lit->value.front() == '"') {
+            // Read-only copy of the line, shared by every Print of the same text
+            std::string line = lit->value.substr(1, lit->value.length() - 2) + "\n";
+            CIAM::VInst& inst = append(CIAM::VOp::PrintString);
+            inst.imm = section.internString(line);
+            inst.length = static_cast<uint32_t>(line.size());
  return;
         }
     }
     
     // Numeric expression
-    CIAM::Reg reg = emitExpr(expr);
-    emitPrintNumber(reg);
-    regAlloc.free(reg);
+    append(CIAM::VOp::PrintNumber).a = emitExpr(expr);
+}
+
+void MachineCodeEmitter::emitVarDecl(const std::string& name, NodePtr initializer) {
+    if (!initializer) {
+        append(CIAM::VOp::MovImm).dst = declareVariable(name);
+        return;
+    }
+    int value = emitExpr(initializer);
+    if (std::dynamic_pointer_cast<Identifier>(initializer)) {
+        // A copy: the two variables change independently from here
+        CIAM::VInst& inst = append(CIAM::VOp::Mov);
+        inst.a = value;
+        inst.dst = declareVariable(name);
+    } else {
+        // The initializer's temporary becomes the variable
+        scopes.back()[name] = value;
+    }
+}
+
+void MachineCodeEmitter::emitAssign(const std::string& name, NodePtr value) {
+    int vreg = lookupVariable(name);
+    if (vreg < 0) vreg = declareVariable(name);
+    int result = emitExpr(value);
+    CIAM::VInst& last = current->code.back();
+    if (!std::dynamic_pointer_cast<Identifier>(value) && last.dst == result) {
+        // Compute straight into the variable rather than copying a temporary
+        last.dst = vreg;
+        return;
+    }
+    CIAM::VInst& inst = append(CIAM::VOp::Mov);
+    inst.a = result;
+    inst.dst = vreg;
+}
+
+void MachineCodeEmitter::emitFunction(std::shared_ptr<FunctionDecl> fn) {
+    current->name = fn->name;
+    sourceLine = fn->line;
+    scopes.assign(1, {});
+    for (size_t i = 0; i < fn->paramNames.size(); ++i) {
+        CIAM::VInst& inst = append(CIAM::VOp::Param);
+        inst.dst = declareVariable(fn->paramNames[i]);
+        inst.imm = static_cast<int64_t>(i);
+    }
+    emitNode(fn->body);
+}
+
+int MachineCodeEmitter::emitCall(std::shared_ptr<CallExpr> call, bool value) {
+    // Arguments left to right, all evaluated before the call moves them
+    std::vector<int> args;
+    for (auto& arg : call->args) args.push_back(emitExpr(arg));
+    CIAM::VInst& inst = append(CIAM::VOp::Call);
+    inst.label = call->callee;
+    inst.args = std::move(args);
+    if (value) inst.dst = current->newRegister();
+    return inst.dst;
+}
+
+void MachineCodeEmitter::emitInput(std::shared_ptr<InputStmt> input) {
+    // The prompt stays on the line the number is typed on
+    if (!input->prompt.empty()) {
+        CIAM::VInst& prompt = append(CIAM::VOp::PrintString);
+        prompt.imm = section.internString(input->prompt);
+        prompt.length = static_cast<uint32_t>(input->prompt.size());
+    }
+    int vreg = lookupVariable(input->varName);
+    if (vreg < 0) vreg = declareVariable(input->varName);
+    append(CIAM::VOp::Input).dst = vreg;
+}
+
+void MachineCodeEmitter::emitReturn(NodePtr value) {
+    int result = value ? emitExpr(value) : -1;
+    append(CIAM::VOp::Return).a = result;
+}
+
+bool MachineCodeEmitter::comparison(const std::string& op, CIAM::Cond& cc) {
+    static const std::unordered_map<std::string, CIAM::Cond> conditions = {
+        {"==", CIAM::Cond::E}, {"!=", CIAM::Cond::NE}, {"<", CIAM::Cond::L},
+        {"<=", CIAM::Cond::LE}, {">", CIAM::Cond::G}, {">=", CIAM::Cond::GE}};
+    auto found = conditions.find(op);
+    if (found == conditions.end()) return false;
+    cc = found->second;
+    return true;
+}
+
+bool MachineCodeEmitter::constantOperand(NodePtr expr, int32_t& value) {
+    auto lit = std::dynamic_pointer_cast<Literal>(expr);
+    int64_t parsed = 0;
+    if (!lit || !integerLiteral(lit->value, parsed) || parsed < 0 || parsed > INT32_MAX) return false;
+    value = static_cast<int32_t>(parsed);
+    return true;
+}
+
+CIAM::VInst& MachineCodeEmitter::appendBinary(CIAM::VOp op, NodePtr left, NodePtr right, CIAM::Cond cc) {
+    using CIAM::VOp;
+    int32_t constant = 0;
+    bool compares = op == VOp::SetCond || op == VOp::Branch;
+    bool commutes = op == VOp::Add || op == VOp::Mul || op == VOp::And || op == VOp::Or || op == VOp::Xor || compares;
+    if (commutes && !constantOperand(right, constant) && constantOperand(left, constant)) {
+        std::swap(left, right);
+        // a < b is b > a
+        if (compares && cc != CIAM::Cond::E && cc != CIAM::Cond::NE) {
+            static const std::unordered_map<int, CIAM::Cond> mirrored = {
+                {static_cast<int>(CIAM::Cond::L), CIAM::Cond::G}, {static_cast<int>(CIAM::Cond::G), CIAM::Cond::L},
+                {static_cast<int>(CIAM::Cond::LE), CIAM::Cond::GE}, {static_cast<int>(CIAM::Cond::GE), CIAM::Cond::LE}};
+            cc = mirrored.at(static_cast<int>(cc));
+        }
+    }
+
+    int a = emitExpr(left);
+    bool immediate = constantOperand(right, constant);
+    // Dividing by a literal 0 keeps its idiv, and its fault
+    if ((op == VOp::Div || op == VOp::Mod) && constant == 0) immediate = false;
+    int b = immediate ? -1 : emitExpr(right);
+
+    CIAM::VInst& inst = append(op);
+    inst.a = a;
+    inst.b = b;
+    inst.immediate = immediate;
+    inst.imm = constant;
+    inst.cond = cc;
+    return inst;
+}
+
+void MachineCodeEmitter::emitBranch(NodePtr condition, bool taken, const std::string& label) {
+    if (auto unary = std::dynamic_pointer_cast<UnaryExpr>(condition)) {
+        if (unary->op == "!") {
+            emitBranch(unary->operand, !taken, label);
+            return;
+        }
+    }
+
+    CIAM::Cond cc = CIAM::Cond::NE;
+    auto bin = std::dynamic_pointer_cast<BinaryExpr>(condition);
+    if (bin && (bin->op == "&&" || bin->op == "||")) {
+        // Short-circuit: the left side alone can decide. `a && b` is false
+        // as soon as a is, `a || b` true as soon as a is.
+        bool decides = bin->op == "||";
+        if (taken == decides) {
+            emitBranch(bin->left, taken, label);
+            emitBranch(bin->right, taken, label);
+        } else {
+            std::string skip = generateLabel("skip");
+            emitBranch(bin->left, decides, skip);
+            emitBranch(bin->right, taken, label);
+            append(CIAM::VOp::Label).label = skip;
+        }
+        return;
+    }
+    if (bin && comparison(bin->op, cc)) {
+        CIAM::VInst& branch = appendBinary(CIAM::VOp::Branch, bin->left, bin->right, cc);
+        branch.cond = taken ? branch.cond : CIAM::negate(branch.cond);
+        branch.label = label;
+        return;
+    }
+
+    // Any other value: true when non-zero
+    int value = emitExpr(condition);
+    CIAM::VInst& branch = append(CIAM::VOp::Branch);
+    branch.a = value;
+    branch.immediate = true;
+    branch.cond = taken ? cc : CIAM::negate(cc);
+    branch.label = label;
 }
 
-void MachineCodeEmitter::emitPrintString(const std::string& str) {
-    // Add string to data section
-    uint32_t dataOffset = static_cast<uint32_t>(section.data.size());
-    section.data.insert(section.data.end(), str.begin(), str.end());
-    section.data.push_back('\n');
-    section.data.push_back(0);
+void MachineCodeEmitter::emitIfStmt(NodePtr condition, NodePtr thenBlock, NodePtr elseBlock) {
+    std::string elseLabel = generateLabel("else");
+    std::string endLabel = generateLabel("endif");
+    
+    // Jump to else if condition is false
+    emitBranch(condition, false, elseLabel);
     
+    // Then block
+    emitNode(thenBlock);
+    if (elseBlock) append(CIAM::VOp::Jump).label = endLabel;
+    
+    // Else block
+    append(CIAM::VOp::Label).label = elseLabel;
+    if (elseBlock) {
+        emitNode(elseBlock);
+        append(CIAM::VOp::Label).label = endLabel;
+    }
+}
+
+void MachineCodeEmitter::emitWhileStmt(NodePtr condition, NodePtr block) {
+    std::string loopLabel = generateLabel("loop");
+    std::string testLabel = generateLabel("looptest");
+    
+    // Test at the bottom: each iteration ends in one cmp + jcc back to
+    // the body, and the entry jump is the only unconditional one
+    append(CIAM::VOp::Jump).label = testLabel;
+    append(CIAM::VOp::Label).label = loopLabel;
+  
+    // Loop body
+    emitNode(block);
+    
+    // The test belongs to the while line, not the body's last statement
+    if (condition->line > 0) sourceLine = condition->line;
+    append(CIAM::VOp::Label).label = testLabel;
+    emitBranch(condition, true, loopLabel);
+}
+
+// -----------------------------------------------------------------------------
+// Encoding
+// -----------------------------------------------------------------------------
+
+void MachineCodeEmitter::encodeFunction(const CIAM::VFunction& fn) {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+
+    RegisterAllocator::Result result = regAlloc.allocate(fn);
+    allocation = &result;
+    allocationStats.values += fn.registers;
+    allocationStats.spilled += result.spilled;
+    allocationStats.spillSlots += result.spillSlots;
+
+    bool calls = false;
+    bool stackParams = false;
+    std::vector<const CIAM::VInst*> params;
+    for (auto& inst : fn.code) {
+        calls |= inst.op == CIAM::VOp::Call;
+        if (inst.op == CIAM::VOp::Param) {
+            params.push_back(&inst);
+            stackParams |= inst.imm >= 6;
+        }
+    }
+
+    // rbp frame: the callee-saved registers in use, then the spill slots,
+    // padded so calls are made with rsp 16-byte aligned. The entry code
+    // never returns, so it has nothing to preserve. A leaf that needs no
+    // stack at all runs on the caller's frame.
+    beginSymbol(fn.name);
+    section.sourceLine = fn.code.empty() ? 0 : fn.code.front().line;
+    savedRegisters = fn.entry ? 0 : static_cast<int>(result.calleeSaved.size());
+    frameless = !fn.entry && !calls && !stackParams && savedRegisters == 0 && result.spillSlots == 0;
+    if (!frameless) {
+        int slots = result.spillSlots;
+        // On entry rsp is 8 past a 16-byte boundary after the call, 0 in _start
+        if ((savedRegisters + slots + (fn.entry ? 1 : 0)) % 2 != 0) ++slots;
+        emitInst(X64Builder::PUSH_REG(Reg::RBP));
+        emitInst(X64Builder::MOV_REG_REG(Reg::RBP, Reg::RSP));
+        for (int i = 0; i < savedRegisters; ++i) emitInst(X64Builder::PUSH_REG(result.calleeSaved[i]));
+        if (slots > 0) emitInst(X64Builder::LEA_REG_MEM(Reg::RSP, Reg::RSP, -8 * slots));
+    }
+    encodeParams(params);
+
+    returnLabel = generateLabel("return");
+    for (size_t i = 0; i < fn.code.size(); ++i) {
+        const CIAM::VInst& inst = fn.code[i];
+        section.sourceLine = inst.line;
+        // A return that falls into the epilogue needs no jump
+        if (inst.op == CIAM::VOp::Return && i + 1 == fn.code.size()) {
+            if (inst.a >= 0) {
+                Reg value = use(inst.a, Reg::RAX);
+                if (value != Reg::RAX) emitInst(X64Builder::MOV_REG_REG(Reg::RAX, value));
+            }
+            break;
+        }
+        encodeInst(inst);
+    }
+
+    section.emitLabel(returnLabel);
+    if (fn.entry) {
+        emitSystemExit(0);
+    } else if (frameless) {
+        emitInst(X64Builder::RET());
+    } else {
+        // Epilogue
+        if (savedRegisters > 0) {
+            emitInst(X64Builder::LEA_REG_MEM(Reg::RSP, Reg::RBP, -8 * savedRegisters));
+            for (int i = savedRegisters; i-- > 0;) emitInst(X64Builder::POP_REG(result.calleeSaved[i]));
+        } else {
+            emitInst(X64Builder::MOV_REG_REG(Reg::RSP, Reg::RBP));
+        }
+        emitInst(X64Builder::POP_REG(Reg::RBP));
+        emitInst(X64Builder::RET());
+    }
+    allocation = nullptr;
+    frameless = false;
+}
+
+void MachineCodeEmitter::encodeInst(const CIAM::VInst& inst) {
+    using CIAM::Reg;
+    using CIAM::VOp;
+    using CIAM::X64Builder;
+
+    switch (inst.op) {
+    case VOp::Label:
+        section.emitLabel(inst.label);
+        break;
+    case VOp::MovImm: {
+        Reg out = target(inst.dst, Reg::R11);
+        emitInst(X64Builder::MOV_REG_CONST(out, inst.imm));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::Mov: {
+        Reg out = target(inst.dst, Reg::R11);
+        Reg value = use(inst.a, out);
+        if (value != out) emitInst(X64Builder::MOV_REG_REG(out, value));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::Add:
+    case VOp::Sub:
+    case VOp::Mul:
+    case VOp::And:
+    case VOp::Or:
+    case VOp::Xor: {
+        if (inst.immediate) {
+            encodeImmediate(inst);
+            break;
+        }
+        // out = a; out op= b, without clobbering b when out is b's register
+        Reg right = use(inst.b, Reg::RAX);
+        Reg out = target(inst.dst, Reg::R11);
+        if (out == right && inst.a != inst.b) out = Reg::R11;
+        Reg left = use(inst.a, out);
+        if (left != out) emitInst(X64Builder::MOV_REG_REG(out, left));
+        switch (inst.op) {
+        case VOp::Add: emitInst(X64Builder::ADD_REG_REG(out, right)); break;
+        case VOp::Sub: emitInst(X64Builder::SUB_REG_REG(out, right)); break;
+        case VOp::Mul: emitInst(X64Builder::IMUL_REG_REG(out, right)); break;
+        case VOp::And: emitInst(X64Builder::AND_REG_REG(out, right)); break;
+        case VOp::Or: emitInst(X64Builder::OR_REG_REG(out, right)); break;
+        default: emitInst(X64Builder::XOR_REG_REG(out, right)); break;
+        }
+        if (allocation->locations[inst.dst].spilled()) {
+            store(inst.dst, out);
+        } else if (out != allocation->locations[inst.dst].reg) {
+            emitInst(X64Builder::MOV_REG_REG(allocation->locations[inst.dst].reg, out));
+        }
+        break;
+    }
+    case VOp::Shl:
+    case VOp::Sar: {
+        if (inst.immediate) {
+            encodeImmediate(inst);
+            break;
+        }
+        // The count goes in CL, read before out = a can overwrite b
+        Reg count = use(inst.b, Reg::RCX);
+        if (count != Reg::RCX) emitInst(X64Builder::MOV_REG_REG(Reg::RCX, count));
+        Reg out = target(inst.dst, Reg::R11);
+        Reg left = use(inst.a, out);
+        if (left != out) emitInst(X64Builder::MOV_REG_REG(out, left));
+        emitInst(inst.op == VOp::Shl ? X64Builder::SHL_REG_CL(out) : X64Builder::SAR_REG_CL(out));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::Div:
+    case VOp::Mod: {
+        if (inst.immediate) {
+            encodeDivideByConstant(inst);
+            break;
+        }
+        // idiv divides RDX:RAX: quotient in RAX, remainder in RDX
+        Reg divisor = use(inst.b, Reg::R11);
+        Reg dividend = use(inst.a, Reg::RAX);
+        if (dividend != Reg::RAX) emitInst(X64Builder::MOV_REG_REG(Reg::RAX, dividend));
+        emitInst(X64Builder::CQO());
+        emitInst(X64Builder::IDIV_REG(divisor));
+        Reg result = inst.op == VOp::Div ? Reg::RAX : Reg::RDX;
+        Reg out = target(inst.dst, result);
+        if (out != result) emitInst(X64Builder::MOV_REG_REG(out, result));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::Neg:
+    case VOp::Not: {
+        Reg out = target(inst.dst, Reg::R11);
+        Reg value = use(inst.a, out);
+        if (value != out) emitInst(X64Builder::MOV_REG_REG(out, value));
+        emitInst(inst.op == VOp::Neg ? X64Builder::NEG_REG(out) : X64Builder::NOT_REG(out));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::SetCond: {
+        // setcc needs a byte register; AL is always one without a REX
+        compare(inst);
+        emitInst(X64Builder::SETCC_REG8(inst.cond, Reg::RAX));
+        Reg out = target(inst.dst, Reg::RAX);
+        emitInst(X64Builder::MOVZX_REG_REG8(out, Reg::RAX));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::Branch:
+        // Adjacent cmp / test + jcc, which the CPU fuses into one uop
+        compare(inst);
+        emitJump(X64Builder::JCC_REL32(inst.cond, 0), inst.label);
+        break;
+    case VOp::Jump:
+        emitJump(X64Builder::JMP_REL32(0), inst.label);
+        break;
+    case VOp::Param:
+        // Moved into place by encodeParams
+        break;
+    case VOp::Call:
+        encodeCall(inst);
+        break;
+    case VOp::Input: {
+        emitJump(X64Builder::CALL_REL32(0), ".rt_read_i64");
+        Reg out = target(inst.dst, Reg::RAX);
+        if (out != Reg::RAX) emitInst(X64Builder::MOV_REG_REG(out, Reg::RAX));
+        store(inst.dst, out);
+        break;
+    }
+    case VOp::PrintNumber:
+        emitPrintNumber(use(inst.a, Reg::RAX));
+        break;
+    case VOp::PrintString:
+        emitPrintString(static_cast<uint32_t>(inst.imm), inst.length);
+        break;
+    case VOp::Return:
+        if (inst.a >= 0) {
+            Reg value = use(inst.a, Reg::RAX);
+            if (value != Reg::RAX) emitInst(X64Builder::MOV_REG_REG(Reg::RAX, value));
+        }
+        // Without a frame to tear down the epilogue is one byte
+        if (frameless) emitInst(X64Builder::RET());
+        else emitJump(X64Builder::JMP_REL32(0), returnLabel);
+        break;
+    }
+}
+
+void MachineCodeEmitter::encodeImmediate(const CIAM::VInst& inst) {
+    using CIAM::Reg;
+    using CIAM::VOp;
+    using CIAM::X64Builder;
+
+    Reg out = target(inst.dst, Reg::R11);
+    Reg left = use(inst.a, out);
+    int32_t constant = static_cast<int32_t>(inst.imm);
+    auto copy = [&] {
+        if (left != out) emitInst(X64Builder::MOV_REG_REG(out, left));
+    };
+    switch (inst.op) {
+    case VOp::Mul:
+        // Powers of two shift; 3, 5 and 9 are one lea; the rest imul
+        if (constant == 0) {
+            emitInst(X64Builder::XOR_REG32(out));
+        } else if ((constant & (constant - 1)) == 0) {
+            copy();
+            if (constant > 1) emitInst(X64Builder::SHL_REG_IMM(out, static_cast<uint8_t>(__builtin_ctz(constant))));
+        } else if (constant == 3 || constant == 5 || constant == 9) {
+            emitInst(X64Builder::LEA_REG_ADDR(out, {left, 0, left, static_cast<uint8_t>(constant - 1)}));
+        } else {
+            emitInst(X64Builder::IMUL_REG_REG_IMM(out, left, constant));
+        }
+        break;
+    case VOp::Add:
+    case VOp::Sub: {
+        // Literals are never negative, so the negation cannot overflow
+        int32_t addend = inst.op == VOp::Add ? constant : -constant;
+        if (left != out) {
+            emitInst(X64Builder::LEA_REG_ADD(out, left, addend));
+        } else if (addend != 0) {
+            emitInst(X64Builder::ADD_REG_IMM(out, addend));
+        }
+        break;
+    }
+    case VOp::And:
+        copy();
+        emitInst(X64Builder::AND_REG_IMM(out, constant));
+        break;
+    case VOp::Or:
+        copy();
+        emitInst(X64Builder::OR_REG_IMM(out, constant));
+        break;
+    case VOp::Xor:
+        copy();
+        emitInst(X64Builder::XOR_REG_IMM(out, constant));
+        break;
+    default:
+        // Shl / Sar: the count is taken mod 64, as the CPU does
+        copy();
+        if (inst.op == VOp::Shl) emitInst(X64Builder::SHL_REG_IMM(out, constant & 63));
+        else emitInst(X64Builder::SAR_REG_IMM(out, constant & 63));
+        break;
+    }
+    store(inst.dst, out);
+}
+
+namespace {
+
+// Multiplier and shift for signed 64-bit division by d >= 2 (Hacker's
+// Delight, 10-1): q = (mulhs(x, magic) [+ x when magic < 0]) >> shift,
+// plus 1 when x is negative
+struct Magic {
+    int64_t multiplier;
+    int shift;
+};
+
+Magic signedMagic(uint64_t d) {
+    const uint64_t two63 = uint64_t(1) << 63;
+    uint64_t anc = two63 - 1 - two63 % d;  // |nc|
+    uint64_t q1 = two63 / anc, r1 = two63 - q1 * anc;
+    uint64_t q2 = two63 / d, r2 = two63 - q2 * d;
+    int p = 63;
+    uint64_t delta;
+    do {
+        ++p;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            ++q1;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= d) {
+            ++q2;
+            r2 -= d;
+        }
+        delta = d - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    return {static_cast<int64_t>(q2 + 1), p - 64};
+}
+
+} // namespace
+
+void MachineCodeEmitter::encodeDivideByConstant(const CIAM::VInst& inst) {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+
+    // x stays out of RAX / RDX, which the sequences below need
+    Reg x = use(inst.a, Reg::R11);
+    Reg out = target(inst.dst, Reg::R11);
+    const int32_t d = static_cast<int32_t>(inst.imm);
+    const bool remainder = inst.op == CIAM::VOp::Mod;
+    auto result = [&](Reg value) {
+        if (value != out) emitInst(X64Builder::MOV_REG_REG(out, value));
+        store(inst.dst, out);
+    };
+    // out = x - RDX (or RAX): the remainder from the quotient times d
+    auto subtractFrom = [&](Reg product) {
+        if (x != out) emitInst(X64Builder::MOV_REG_REG(out, x));
+        emitInst(X64Builder::SUB_REG_REG(out, product));
+        store(inst.dst, out);
+    };
+
+    if (d == 1) {
+        if (remainder) emitInst(X64Builder::XOR_REG32(out));
+        result(remainder ? out : x);
+        return;
+    }
+
+    if ((d & (d - 1)) == 0) {
+        // Round toward zero: negative dividends are biased by d - 1 first
+        int k = __builtin_ctz(d);
+        emitInst(X64Builder::LEA_REG_ADD(Reg::RAX, x, d - 1));
+        emitInst(X64Builder::TEST_REG_REG(x, x));
+        emitInst(X64Builder::CMOVCC_REG_REG(CIAM::Cond::NS, Reg::RAX, x));
+        if (remainder) {
+            emitInst(X64Builder::AND_REG_IMM(Reg::RAX, -d));
+            subtractFrom(Reg::RAX);
+        } else {
+            emitInst(X64Builder::SAR_REG_IMM(Reg::RAX, static_cast<uint8_t>(k)));
+            result(Reg::RAX);
+        }
+        return;
+    }
+
+    Magic magic = signedMagic(static_cast<uint64_t>(d));
+    emitInst(X64Builder::MOV_REG_CONST(Reg::RAX, magic.multiplier));
+    emitInst(X64Builder::IMUL_REG(x));
+    if (magic.multiplier < 0) emitInst(X64Builder::ADD_REG_REG(Reg::RDX, x));
+    if (magic.shift > 0) emitInst(X64Builder::SAR_REG_IMM(Reg::RDX, static_cast<uint8_t>(magic.shift)));
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, x));
+    emitInst(X64Builder::SHR_REG_IMM(Reg::RAX, 63));
+    emitInst(X64Builder::ADD_REG_REG(Reg::RDX, Reg::RAX));
+    if (remainder) {
+        emitInst(X64Builder::IMUL_REG_REG_IMM(Reg::RDX, Reg::RDX, d));
+        subtractFrom(Reg::RDX);
+    } else {
+        result(Reg::RDX);
+    }
+}
+
+void MachineCodeEmitter::compare(const CIAM::VInst& inst) {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+
+    if (inst.immediate) {
+        Reg left = use(inst.a, Reg::R11);
+        // Against zero, test sets the flags every signed condition reads
+        if (inst.imm == 0) emitInst(X64Builder::TEST_REG_REG(left, left));
+        else emitInst(X64Builder::CMP_REG_IMM(left, static_cast<int32_t>(inst.imm)));
+        return;
+    }
+    Reg right = use(inst.b, Reg::RAX);
+    Reg left = use(inst.a, Reg::R11);
+    emitInst(X64Builder::CMP_REG_REG(left, right));
+}
+
+int MachineCodeEmitter::frameOffset(int slot) const {
+    // Below the saved rbp and the pushed callee-saved registers
+    return -8 * (savedRegisters + slot + 1);
+}
+
+CIAM::Reg MachineCodeEmitter::use(int vreg, CIAM::Reg scratch) {
+    const CIAM::Location& location = allocation->locations[vreg];
+    if (!location.spilled()) return location.reg;
+    emitInst(CIAM::X64Builder::MOV_REG_MEM(scratch, {CIAM::Reg::RBP, frameOffset(location.slot)}));
+    ++allocationStats.reloads;
+    return scratch;
+}
+
+CIAM::Reg MachineCodeEmitter::target(int vreg, CIAM::Reg scratch) const {
+    const CIAM::Location& location = allocation->locations[vreg];
+    return location.spilled() ? scratch : location.reg;
+}
+
+void MachineCodeEmitter::store(int vreg, CIAM::Reg reg) {
+    const CIAM::Location& location = allocation->locations[vreg];
+    if (!location.spilled()) return;
+    emitInst(CIAM::X64Builder::MOV_MEM_REG({CIAM::Reg::RBP, frameOffset(location.slot)}, reg));
+    ++allocationStats.stores;
+}
+
+const CIAM::Reg MachineCodeEmitter::argumentRegisters[6] = {CIAM::Reg::RDI, CIAM::Reg::RSI, CIAM::Reg::RDX,
+                                                             CIAM::Reg::RCX, CIAM::Reg::R8, CIAM::Reg::R9};
+
+void MachineCodeEmitter::emitParallelMove(std::vector<std::pair<CIAM::Reg, CIAM::Reg>> moves) {
+    // (destination, source) pairs with distinct destinations
+    moves.erase(std::remove_if(moves.begin(), moves.end(), [](const auto& m) { return m.first == m.second; }),
+                moves.end());
+    while (!moves.empty()) {
+        // A destination no pending move still reads can be written now
+        auto ready = std::find_if(moves.begin(), moves.end(), [&](const auto& m) {
+            return std::none_of(moves.begin(), moves.end(), [&](const auto& other) { return other.second == m.first; });
+        });
+        if (ready != moves.end()) {
+            emitInst(CIAM::X64Builder::MOV_REG_REG(ready->first, ready->second));
+            moves.erase(ready);
+            continue;
+        }
+        // Only cycles are left: park one destination's value in R11
+        CIAM::Reg parked = moves.front().first;
+        emitInst(CIAM::X64Builder::MOV_REG_REG(CIAM::Reg::R11, parked));
+        for (auto& m : moves) {
+            if (m.second == parked) m.second = CIAM::Reg::R11;
+        }
+    }
+}
+
+void MachineCodeEmitter::encodeParams(const std::vector<const CIAM::VInst*>& params) {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+
+    // Spilled register arguments are stored before the moves can overwrite
+    // them; the rest go register to register
+    std::vector<std::pair<Reg, Reg>> moves;
+    for (const CIAM::VInst* param : params) {
+        if (param->imm >= 6) continue;
+        Reg incoming = argumentRegisters[param->imm];
+        if (allocation->locations[param->dst].spilled()) store(param->dst, incoming);
+        else moves.push_back({allocation->locations[param->dst].reg, incoming});
+    }
+    emitParallelMove(std::move(moves));
+
+    // Stack arguments sit above the return address and the saved rbp
+    for (const CIAM::VInst* param : params) {
+        if (param->imm < 6) continue;
+        Reg out = target(param->dst, Reg::R11);
+        emitInst(X64Builder::MOV_REG_MEM(out, {Reg::RBP, static_cast<int32_t>(16 + 8 * (param->imm - 6))}));
+        store(param->dst, out);
+    }
+}
+
+void MachineCodeEmitter::encodeCall(const CIAM::VInst& inst) {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+
+    // Arguments past the sixth are pushed right to left, over a pad that
+    // keeps rsp 16-byte aligned at the call
+    const size_t count = inst.args.size();
+    const int pushed = count > 6 ? static_cast<int>(count - 6) : 0;
+    const int padding = pushed % 2;
+    if (padding) emitInst(X64Builder::LEA_REG_MEM(Reg::RSP, Reg::RSP, -8));
+    for (size_t i = count; i-- > 6;) emitInst(X64Builder::PUSH_REG(use(inst.args[i], Reg::R11)));
+
+    // Register arguments: the ones already in registers move together, then
+    // the spilled ones load straight into theirs
+    std::vector<std::pair<Reg, Reg>> moves;
+    for (size_t i = 0; i < count && i < 6; ++i) {
+        const CIAM::Location& location = allocation->locations[inst.args[i]];
+        if (!location.spilled()) moves.push_back({argumentRegisters[i], location.reg});
+    }
+    emitParallelMove(std::move(moves));
+    for (size_t i = 0; i < count && i < 6; ++i) {
+        if (allocation->locations[inst.args[i]].spilled()) use(inst.args[i], argumentRegisters[i]);
+    }
+
+    emitJump(X64Builder::CALL_REL32(0), inst.label);
+    if (pushed + padding > 0) emitInst(X64Builder::LEA_REG_MEM(Reg::RSP, Reg::RSP, 8 * (pushed + padding)));
+    if (inst.dst >= 0) {
+        Reg out = target(inst.dst, Reg::RAX);
+        if (out != Reg::RAX) emitInst(X64Builder::MOV_REG_REG(out, Reg::RAX));
+        store(inst.dst, out);
+    }
+}
+
+void MachineCodeEmitter::emitPrintString(uint32_t offset, uint32_t length) {
 #ifdef _WIN32
     // Windows: WriteFile system call (simplified)
     // This would require full Windows API integration
-    std::cout << "\033[1;33m[CIAM]\033[0m Windows print stub (string at data+" 
-  << dataOffset << ")\n";
+    std::cout << "\033[1;33m[CIAM]\033[0m Windows print stub (string at rodata+" 
+  << offset << ")\n";
 #else
-    // Linux: sys_write syscall
-    // mov rax, 1 (sys_write)
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RAX, 1).bytes);
-    
-    // mov rdi, 1 (stdout)
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RDI, 1).bytes);
-    
-    // lea rsi, [data + offset]
- section.emitBytes(CIAM::X64Builder::LEA_REG_MEM(CIAM::Reg::RSI, CIAM::Reg::RIP, dataOffset).bytes);
+    // Buffered: .rt_write copies the line into the output buffer
+    useOutput();
+
+    // lea rax, [rip + rodata + offset]
+ section.emitDataReference(CIAM::X64Builder::LEA_REG_MEM(CIAM::Reg::RAX, CIAM::Reg::RIP, 0),
+                           CIAM::CodeSection::Segment::Rodata, offset);
     
     // mov rdx, length
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RDX, str.length() + 1).bytes);
+    section.emit(CIAM::X64Builder::MOV_REG_CONST(CIAM::Reg::RDX, length));
     
-    // syscall
-    section.emitBytes(CIAM::X64Builder::SYSCALL().bytes);
+    emitJump(CIAM::X64Builder::CALL_REL32(0), ".rt_write");
 #endif
 }
 
 void MachineCodeEmitter::emitPrintNumber(CIAM::Reg reg) {
-    // Convert number to string and print
-    // This is simplified - full implementation would need conversion routine
-    std::cout << "\033[1;33m[CIAM]\033[0m Number print stub (from register)\n";
-    
 #ifdef _WIN32
     // Windows stub
+    std::cout << "\033[1;33m[CIAM]\033[0m Number print stub (from register)\n";
 #else
-    // Linux: Convert to ASCII and sys_write
-    // For now, just emit placeholder
-    section.emitBytes(CIAM::X64Builder::PUSH_REG(reg).bytes);
-    // ... conversion code would go here ...
-    section.emitBytes(CIAM::X64Builder::POP_REG(reg).bytes);
+    // Linux: .rt_print_i64 formats the value into the output buffer
+    usesPrintNumber = true;
+    useOutput();
+    if (reg != CIAM::Reg::RAX) emitInst(CIAM::X64Builder::MOV_REG_REG(CIAM::Reg::RAX, reg));
+    emitJump(CIAM::X64Builder::CALL_REL32(0), ".rt_print_i64");
 #endif
 }
 
 void MachineCodeEmitter::emitSystemExit(int code) {
 #ifdef _WIN32
     // Windows: ExitProcess
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RCX, code).bytes);
+    section.emit(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RCX, code));
     // Call ExitProcess (would need import table)
     std::cout << "\033[1;33m[CIAM]\033[0m Windows exit stub\n";
 #else
-    // Linux: sys_exit
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RAX, 60).bytes);  // sys_exit
-    section.emitBytes(CIAM::X64Builder::MOV_REG_IMM(CIAM::Reg::RDI, code).bytes); // exit code
-    section.emitBytes(CIAM::X64Builder::SYSCALL().bytes);
+    // Linux: flush buffered output, then sys_exit
+    if (usesOutput) emitJump(CIAM::X64Builder::CALL_REL32(0), ".rt_flush");
+    section.emit(CIAM::X64Builder::MOV_REG_CONST(CIAM::Reg::RAX, 60));  // sys_exit
+    section.emit(CIAM::X64Builder::MOV_REG_CONST(CIAM::Reg::RDI, code)); // exit code
+    section.emit(CIAM::X64Builder::SYSCALL());
 #endif
 }
 
-void MachineCodeEmitter::emitVarDecl(const std::string& name, NodePtr initializer) {
-    if (initializer) {
-        CIAM::Reg reg = emitExpr(initializer);
-        regAlloc.allocate(name);  // Associate variable with register
- } else {
-        regAlloc.allocate(name);
+// -----------------------------------------------------------------------------
+// AOT runtime
+// -----------------------------------------------------------------------------
+
+void MachineCodeEmitter::useOutput() {
+    if (usesOutput) return;
+    usesOutput = true;
+    outputCount = section.reserveBss(8);
+    outputBuffer = section.reserveBss(OUTPUT_BUFFER_SIZE, 16);
+}
+
+void MachineCodeEmitter::useInput() {
+    if (usesInput) return;
+    usesInput = true;
+    // Reading flushes the output first, so a prompt is seen
+    useOutput();
+    inputPosition = section.reserveBss(8);
+    inputLength = section.reserveBss(8);
+    inputBuffer = section.reserveBss(INPUT_BUFFER_SIZE, 16);
+}
+
+void MachineCodeEmitter::emitRuntime() {
+    if (!usesOutput) return;
+    section.sourceLine = 0;
+    emitRuntimeWrite();
+    emitRuntimeFlush();
+    emitRuntimeWriteAll();
+    if (usesPrintNumber) emitRuntimePrintNumber();
+    if (usesInput) {
+        emitRuntimeReadByte();
+        emitRuntimeReadNumber();
     }
 }
 
-void MachineCodeEmitter::emitFunction(const std::string& name, NodePtr body) {
-    section.emitLabel(name);
-    
-    // Function prologue
-    section.emitBytes(CIAM::X64Builder::PUSH_REG(CIAM::Reg::RBP).bytes);
-    section.emitBytes({0x48, 0x89, 0xE5});  // mov rbp, rsp
-    
-    emitNode(body);
-    
-    // Function epilogue (if no explicit return)
-    section.emitBytes({0x48, 0x89, 0xEC});  // mov rsp, rbp
- section.emitBytes(CIAM::X64Builder::POP_REG(CIAM::Reg::RBP).bytes);
-    section.emitBytes(CIAM::X64Builder::RET().bytes);
+void MachineCodeEmitter::emitRuntimeWrite() {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+    using Segment = CIAM::CodeSection::Segment;
+
+    beginSymbol(".rt_write");
+    emitInst(X64Builder::PUSH_REG(Reg::RSI));
+    emitInst(X64Builder::PUSH_REG(Reg::RDI));
+    emitInst(X64Builder::MOV_REG_REG(Reg::RSI, Reg::RAX));
+    section.emitDataReference(X64Builder::MOV_REG_MEM(Reg::RAX, {Reg::RIP}), Segment::Bss, outputCount);
+    emitInst(X64Builder::LEA_REG_ADDR(Reg::RCX, {Reg::RAX, 0, Reg::RDX}));
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RCX, OUTPUT_BUFFER_SIZE));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::BE, 0), ".rt_write_copy");
+    // Does not fit: flush, then buffer it unless it is bigger than the buffer
+    emitJump(X64Builder::CALL_REL32(0), ".rt_flush");
+    emitInst(X64Builder::XOR_REG32(Reg::RAX));
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RDX, OUTPUT_BUFFER_SIZE));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::BE, 0), ".rt_write_copy");
+    emitJump(X64Builder::CALL_REL32(0), ".rt_write_all");
+    emitJump(X64Builder::JMP_REL32(0), ".rt_write_done");
+
+    section.emitLabel(".rt_write_copy");
+    section.emitDataReference(X64Builder::LEA_REG_MEM(Reg::RDI, Reg::RIP, 0), Segment::Bss, outputBuffer);
+    emitInst(X64Builder::LEA_REG_ADDR(Reg::RDI, {Reg::RDI, 0, Reg::RAX}));
+    emitInst(X64Builder::MOV_REG_REG(Reg::RCX, Reg::RDX));
+    emitInst(X64Builder::REP_MOVSB());
+    emitInst(X64Builder::ADD_REG_REG(Reg::RAX, Reg::RDX));
+    section.emitDataReference(X64Builder::MOV_MEM_REG({Reg::RIP}, Reg::RAX), Segment::Bss, outputCount);
+
+    section.emitLabel(".rt_write_done");
+    emitInst(X64Builder::POP_REG(Reg::RDI));
+    emitInst(X64Builder::POP_REG(Reg::RSI));
+    emitInst(X64Builder::RET());
 }
 
-void MachineCodeEmitter::emitReturn(NodePtr value) {
-    if (value) {
-   CIAM::Reg reg = emitExpr(value);
-        if (reg != CIAM::Reg::RAX) {
-            // Move result to RAX (standard return register)
-         section.emitBytes({0x48, 0x89, 0xC0});  // Simplified mov
-        }
+void MachineCodeEmitter::emitRuntimeFlush() {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+    using Segment = CIAM::CodeSection::Segment;
+    // RDX too: .rt_write still needs its length afterwards
+    const Reg saved[] = {Reg::RDX, Reg::RSI, Reg::RDI};
+
+    beginSymbol(".rt_flush");
+    for (Reg reg : saved) emitInst(X64Builder::PUSH_REG(reg));
+    section.emitDataReference(X64Builder::LEA_REG_MEM(Reg::RSI, Reg::RIP, 0), Segment::Bss, outputBuffer);
+    section.emitDataReference(X64Builder::MOV_REG_MEM(Reg::RDX, {Reg::RIP}), Segment::Bss, outputCount);
+    emitJump(X64Builder::CALL_REL32(0), ".rt_write_all");
+    emitInst(X64Builder::XOR_REG32(Reg::RAX));
+    section.emitDataReference(X64Builder::MOV_MEM_REG({Reg::RIP}, Reg::RAX), Segment::Bss, outputCount);
+    for (auto it = std::rbegin(saved); it != std::rend(saved); ++it) emitInst(X64Builder::POP_REG(*it));
+    emitInst(X64Builder::RET());
+}
+
+void MachineCodeEmitter::emitRuntimeWriteAll() {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+
+    // Until RDX bytes are written; stops early on an error or a zero write
+    beginSymbol(".rt_write_all");
+    emitInst(X64Builder::TEST_REG_REG(Reg::RDX, Reg::RDX));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::LE, 0), ".rt_write_all_done");
+    emitInst(X64Builder::MOV_REG_CONST(Reg::RAX, 1));  // sys_write
+    emitInst(X64Builder::MOV_REG_CONST(Reg::RDI, 1));  // stdout
+    emitInst(X64Builder::SYSCALL());
+    emitInst(X64Builder::TEST_REG_REG(Reg::RAX, Reg::RAX));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::LE, 0), ".rt_write_all_done");
+    emitInst(X64Builder::ADD_REG_REG(Reg::RSI, Reg::RAX));
+    emitInst(X64Builder::SUB_REG_REG(Reg::RDX, Reg::RAX));
+    emitJump(X64Builder::JMP_REL32(0), ".rt_write_all");
+    section.emitLabel(".rt_write_all_done");
+    emitInst(X64Builder::RET());
+}
+
+void MachineCodeEmitter::emitRuntimePrintNumber() {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+    using Segment = CIAM::CodeSection::Segment;
+    const Reg saved[] = {Reg::RSI, Reg::RDI, Reg::R8, Reg::R9, Reg::R10};
+
+    // "00" "01" ... "99": two digits per table load
+    std::string pairs;
+    for (int i = 0; i < 100; ++i) {
+        pairs += static_cast<char>('0' + i / 10);
+        pairs += static_cast<char>('0' + i % 10);
     }
-    
-    // Epilogue
- section.emitBytes({0x48, 0x89, 0xEC});  // mov rsp, rbp
-    section.emitBytes(CIAM::X64Builder::POP_REG(CIAM::Reg::RBP).bytes);
-    section.emitBytes(CIAM::X64Builder::RET().bytes);
+    uint32_t digitPairs = section.internString(pairs);
+
+    // Digits are written backwards from the end of a 32-byte stack buffer:
+    // R8 is the first byte written so far, RAX the magnitude still to go
+    beginSymbol(".rt_print_i64");
+    for (Reg reg : saved) emitInst(X64Builder::PUSH_REG(reg));
+    emitInst(X64Builder::MOV_REG_REG(Reg::RDI, Reg::RAX));
+    emitInst(X64Builder::LEA_REG_MEM(Reg::RSP, Reg::RSP, -32));
+    emitInst(X64Builder::LEA_REG_MEM(Reg::R8, Reg::RSP, 31));
+    emitInst(X64Builder::MOV_MEM8_IMM({Reg::R8}, '\n'));
+
+    // Magnitude as unsigned, so INT64_MIN works too
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, Reg::RDI));
+    emitInst(X64Builder::XOR_REG32(Reg::R9));
+    emitInst(X64Builder::TEST_REG_REG(Reg::RDI, Reg::RDI));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::GE, 0), ".rt_print_i64_digits");
+    emitInst(X64Builder::SUB_REG_REG(Reg::R9, Reg::RAX));
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, Reg::R9));
+
+    section.emitLabel(".rt_print_i64_digits");
+    section.emitDataReference(X64Builder::LEA_REG_MEM(Reg::R10, Reg::RIP, 0), Segment::Rodata, digitPairs);
+
+    // Two digits per iteration: q = x / 100 as a multiply by the reciprocal,
+    // ((x >> 2) * 0x28F5C28F5C28F5C3) >> 66, with no divide instruction
+    section.emitLabel(".rt_print_i64_loop");
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RAX, 100));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::B, 0), ".rt_print_i64_last");
+    emitInst(X64Builder::MOV_REG_REG(Reg::RCX, Reg::RAX));
+    emitInst(X64Builder::SHR_REG_IMM(Reg::RAX, 2));
+    emitInst(X64Builder::MOV_REG_IMM(Reg::RDX, 0x28F5C28F5C28F5C3ull));
+    emitInst(X64Builder::MUL_REG(Reg::RDX));
+    emitInst(X64Builder::SHR_REG_IMM(Reg::RDX, 2));
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, Reg::RDX));
+    emitInst(X64Builder::IMUL_REG_REG_IMM(Reg::RDX, Reg::RDX, 100));
+    emitInst(X64Builder::SUB_REG_REG(Reg::RCX, Reg::RDX));  // x % 100
+    emitInst(X64Builder::MOVZX_REG_MEM16(Reg::RDX, {Reg::R10, 0, Reg::RCX, 2}));
+    emitInst(X64Builder::LEA_REG_MEM(Reg::R8, Reg::R8, -2));
+    emitInst(X64Builder::MOV_MEM16_REG({Reg::R8}, Reg::RDX));
+    emitJump(X64Builder::JMP_REL32(0), ".rt_print_i64_loop");
+
+    // Last one or two digits; a single digit drops the pair's leading '0'
+    section.emitLabel(".rt_print_i64_last");
+    emitInst(X64Builder::MOVZX_REG_MEM16(Reg::RDX, {Reg::R10, 0, Reg::RAX, 2}));
+    emitInst(X64Builder::LEA_REG_MEM(Reg::R8, Reg::R8, -2));
+    emitInst(X64Builder::MOV_MEM16_REG({Reg::R8}, Reg::RDX));
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RAX, 10));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::AE, 0), ".rt_print_i64_sign");
+    emitInst(X64Builder::LEA_REG_MEM(Reg::R8, Reg::R8, 1));
+
+    section.emitLabel(".rt_print_i64_sign");
+    emitInst(X64Builder::TEST_REG_REG(Reg::RDI, Reg::RDI));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::GE, 0), ".rt_print_i64_write");
+    emitInst(X64Builder::LEA_REG_MEM(Reg::R8, Reg::R8, -1));
+    emitInst(X64Builder::MOV_MEM8_IMM({Reg::R8}, '-'));
+
+    section.emitLabel(".rt_print_i64_write");
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, Reg::R8));
+    emitInst(X64Builder::LEA_REG_MEM(Reg::RDX, Reg::RSP, 32));
+    emitInst(X64Builder::SUB_REG_REG(Reg::RDX, Reg::RAX));
+    emitJump(X64Builder::CALL_REL32(0), ".rt_write");
+    emitInst(X64Builder::LEA_REG_MEM(Reg::RSP, Reg::RSP, 32));
+    for (auto it = std::rbegin(saved); it != std::rend(saved); ++it) emitInst(X64Builder::POP_REG(*it));
+    emitInst(X64Builder::RET());
 }
 
-void MachineCodeEmitter::emitIfStmt(NodePtr condition, NodePtr thenBlock, NodePtr elseBlock) {
-    CIAM::Reg condReg = emitExpr(condition);
+void MachineCodeEmitter::emitRuntimeReadByte() {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+    using Segment = CIAM::CodeSection::Segment;
 
-    // Compare with zero
-    section.emitBytes(CIAM::X64Builder::XOR_REG_REG(CIAM::Reg::R11).bytes);
-    section.emitBytes(CIAM::X64Builder::CMP_REG_REG(condReg, CIAM::Reg::R11).bytes);
-    
-    std::string elseLabel = generateLabel("else");
-    std::string endLabel = generateLabel("endif");
-    
-    // Jump to else if condition is zero (false)
-    section.addRelocation(elseLabel);
-    section.emitBytes(CIAM::X64Builder::JE_REL32(0).bytes);
-    
-    // Then block
-    emitNode(thenBlock);
-    section.addRelocation(endLabel);
-    section.emitBytes(CIAM::X64Builder::JMP_REL32(0).bytes);
-    
-    // Else block
-    section.emitLabel(elseLabel);
-    if (elseBlock) {
-        emitNode(elseBlock);
+    beginSymbol(".rt_read_byte");
+    section.emitDataReference(X64Builder::MOV_REG_MEM(Reg::RAX, {Reg::RIP}), Segment::Bss, inputPosition);
+    section.emitDataReference(X64Builder::MOV_REG_MEM(Reg::RCX, {Reg::RIP}), Segment::Bss, inputLength);
+    emitInst(X64Builder::CMP_REG_REG(Reg::RAX, Reg::RCX));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::B, 0), ".rt_read_byte_next");
+
+    // Buffer used up: refill it with read(0); nothing read is end of input
+    emitInst(X64Builder::PUSH_REG(Reg::RSI));
+    emitInst(X64Builder::PUSH_REG(Reg::RDI));
+    emitInst(X64Builder::XOR_REG32(Reg::RAX));  // sys_read
+    emitInst(X64Builder::XOR_REG32(Reg::RDI));  // stdin
+    section.emitDataReference(X64Builder::LEA_REG_MEM(Reg::RSI, Reg::RIP, 0), Segment::Bss, inputBuffer);
+    emitInst(X64Builder::MOV_REG_CONST(Reg::RDX, INPUT_BUFFER_SIZE));
+    emitInst(X64Builder::SYSCALL());
+    emitInst(X64Builder::POP_REG(Reg::RDI));
+    emitInst(X64Builder::POP_REG(Reg::RSI));
+    emitInst(X64Builder::TEST_REG_REG(Reg::RAX, Reg::RAX));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::G, 0), ".rt_read_byte_filled");
+    emitInst(X64Builder::MOV_REG_CONST(Reg::RAX, -1));
+    emitInst(X64Builder::RET());
+    section.emitLabel(".rt_read_byte_filled");
+    section.emitDataReference(X64Builder::MOV_MEM_REG({Reg::RIP}, Reg::RAX), Segment::Bss, inputLength);
+    emitInst(X64Builder::XOR_REG32(Reg::RAX));
+
+    section.emitLabel(".rt_read_byte_next");
+    section.emitDataReference(X64Builder::LEA_REG_MEM(Reg::RCX, Reg::RIP, 0), Segment::Bss, inputBuffer);
+    emitInst(X64Builder::MOVZX_REG_MEM8(Reg::RCX, {Reg::RCX, 0, Reg::RAX}));
+    emitInst(X64Builder::LEA_REG_MEM(Reg::RAX, Reg::RAX, 1));
+    section.emitDataReference(X64Builder::MOV_MEM_REG({Reg::RIP}, Reg::RAX), Segment::Bss, inputPosition);
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, Reg::RCX));
+    emitInst(X64Builder::RET());
+}
+
+void MachineCodeEmitter::emitRuntimeReadNumber() {
+    using CIAM::Reg;
+    using CIAM::X64Builder;
+    using Segment = CIAM::CodeSection::Segment;
+
+    // RDI accumulates the digits, RSI holds the sign character
+    beginSymbol(".rt_read_i64");
+    emitInst(X64Builder::PUSH_REG(Reg::RSI));
+    emitInst(X64Builder::PUSH_REG(Reg::RDI));
+    emitJump(X64Builder::CALL_REL32(0), ".rt_flush");
+    emitInst(X64Builder::XOR_REG32(Reg::RSI));
+    emitInst(X64Builder::XOR_REG32(Reg::RDI));
+
+    // Leading whitespace, as cin >> skips it
+    section.emitLabel(".rt_read_i64_space");
+    emitJump(X64Builder::CALL_REL32(0), ".rt_read_byte");
+    emitInst(X64Builder::TEST_REG_REG(Reg::RAX, Reg::RAX));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::S, 0), ".rt_read_i64_done");
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RAX, ' '));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::LE, 0), ".rt_read_i64_space");
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RAX, '-'));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::E, 0), ".rt_read_i64_sign");
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RAX, '+'));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::NE, 0), ".rt_read_i64_digit");
+    section.emitLabel(".rt_read_i64_sign");
+    emitInst(X64Builder::MOV_REG_REG(Reg::RSI, Reg::RAX));
+    emitJump(X64Builder::CALL_REL32(0), ".rt_read_byte");
+
+    // One unsigned compare rejects everything outside '0'..'9', end of input too
+    section.emitLabel(".rt_read_i64_digit");
+    emitInst(X64Builder::LEA_REG_MEM(Reg::RCX, Reg::RAX, -'0'));
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RCX, 9));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::A, 0), ".rt_read_i64_end");
+    emitInst(X64Builder::IMUL_REG_REG_IMM(Reg::RDI, Reg::RDI, 10));
+    emitInst(X64Builder::ADD_REG_REG(Reg::RDI, Reg::RCX));
+    emitJump(X64Builder::CALL_REL32(0), ".rt_read_byte");
+    emitJump(X64Builder::JMP_REL32(0), ".rt_read_i64_digit");
+
+    // The byte that ended the number is left for the next read
+    section.emitLabel(".rt_read_i64_end");
+    emitInst(X64Builder::TEST_REG_REG(Reg::RAX, Reg::RAX));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::S, 0), ".rt_read_i64_negate");
+    section.emitDataReference(X64Builder::MOV_REG_MEM(Reg::RCX, {Reg::RIP}), Segment::Bss, inputPosition);
+    emitInst(X64Builder::LEA_REG_MEM(Reg::RCX, Reg::RCX, -1));
+    section.emitDataReference(X64Builder::MOV_MEM_REG({Reg::RIP}, Reg::RCX), Segment::Bss, inputPosition);
+    section.emitLabel(".rt_read_i64_negate");
+    emitInst(X64Builder::CMP_REG_IMM(Reg::RSI, '-'));
+    emitJump(X64Builder::JCC_REL32(CIAM::Cond::NE, 0), ".rt_read_i64_done");
+    emitInst(X64Builder::NEG_REG(Reg::RDI));
+
+    section.emitLabel(".rt_read_i64_done");
+    emitInst(X64Builder::MOV_REG_REG(Reg::RAX, Reg::RDI));
+    emitInst(X64Builder::POP_REG(Reg::RDI));
+    emitInst(X64Builder::POP_REG(Reg::RSI));
+    emitInst(X64Builder::RET());
+}
+
+// -----------------------------------------------------------------------------
+// Listing
+// -----------------------------------------------------------------------------
+
+namespace {
+
+const char* const registerNames[4][16] = {
+    {"al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"},
+    {"ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w"},
+    {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+     "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"},
+    {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"}};
+const char* const conditionNames[16] = {"o", "no", "b", "ae", "e", "ne", "be", "a",
+                                        "s", "ns", "p", "np", "l", "ge", "le", "g"};
+
+std::string hex(uint64_t value) {
+    char text[24];
+    std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(value));
+    return text;
+}
+
+// Small values in decimal, the rest in hex
+std::string immediate(int64_t value) {
+    if (value > -10 && value < 10) return std::to_string(value);
+    return value < 0 ? "-" + hex(0 - static_cast<uint64_t>(value)) : hex(static_cast<uint64_t>(value));
+}
+
+// Decodes the instruction forms X64Builder produces, Intel syntax. A branch
+// leaves its operand out and reports the target offset instead.
+class Decoder {
+public:
+    Decoder(const uint8_t* bytes, size_t length, uint64_t address) : bytes(bytes), length(length), address(address) {}
+
+    // Empty when the instruction is not one X64Builder emits
+    std::string decode(bool& branch, int64_t& target) {
+        branch = false;
+        bool operand16 = false, repeat = false;
+        if (peek() == 0x66) operand16 = take();
+        if (peek() == 0xF3) repeat = take();
+        if ((peek() & 0xF0) == 0x40) rex = take();
+        const int width = (rex & 8) ? 3 : operand16 ? 1 : 2;
+        const uint8_t op = take();
+
+        static const char* const arithmetic[8] = {"add", "or", "adc", "sbb", "and", "sub", "xor", "cmp"};
+        static const char* const shifts[8] = {"rol", "ror", "rcl", "rcr", "shl", "shr", "sal", "sar"};
+        static const char* const unary[8] = {"test", "test", "not", "neg", "mul", "imul", "div", "idiv"};
+        switch (op) {
+        case 0x0F:
+            return decodeTwoByte(width, branch, target);
+        case 0x01: case 0x09: case 0x21: case 0x29: case 0x31: case 0x39: case 0x85: case 0x89: {
+            const char* name = op == 0x85 ? "test" : op == 0x89 ? "mov" : arithmetic[op >> 3];
+            int reg = modrm(width);
+            return std::string(name) + " " + rm + ", " + registerNames[width][reg];
+        }
+        case 0x8B: case 0x8D: {
+            int reg = modrm(width);
+            return std::string(op == 0x8B ? "mov " : "lea ") + registerNames[width][reg] + ", " + rm;
+        }
+        case 0x81: case 0x83: {
+            int digit = modrm(width, "qword ") & 7;
+            int64_t value = op == 0x83 ? static_cast<int8_t>(take()) : takeInt32();
+            return std::string(arithmetic[digit]) + " " + rm + ", " + immediate(value);
+        }
+        case 0x69: case 0x6B: {
+            int reg = modrm(width);
+            int64_t value = op == 0x6B ? static_cast<int8_t>(take()) : takeInt32();
+            return std::string("imul ") + registerNames[width][reg] + ", " + rm + ", " + immediate(value);
+        }
+        case 0xC1: case 0xD3: {
+            int digit = modrm(width, "qword ") & 7;
+            return std::string(shifts[digit]) + " " + rm + ", " + (op == 0xC1 ? std::to_string(take()) : "cl");
+        }
+        case 0xC6:
+            modrm(0, "byte ");
+            return "mov " + rm + ", " + std::to_string(take());
+        case 0xC7:
+            modrm(width, "qword ");
+            return "mov " + rm + ", " + immediate(takeInt32());
+        case 0xF7: {
+            int digit = modrm(width, "qword ") & 7;
+            return std::string(unary[digit]) + " " + rm;
+        }
+        case 0x99:
+            return width == 3 ? "cqo" : "cdq";
+        case 0xA4:
+            return repeat ? "rep movsb" : "movsb";
+        case 0xC3:
+            return "ret";
+        case 0xCD:
+            return "int " + hex(take());
+        case 0xE8: case 0xE9:
+            branch = true;
+            target = relative(takeInt32());
+            return op == 0xE8 ? "call" : "jmp";
+        case 0xEB:
+            branch = true;
+            target = relative(static_cast<int8_t>(take()));
+            return "jmp";
+        default:
+            break;
+        }
+        if (op >= 0x50 && op <= 0x5F) {
+            return std::string(op < 0x58 ? "push " : "pop ") + registerNames[3][(op & 7) | ((rex & 1) << 3)];
+        }
+        if (op >= 0xB8 && op <= 0xBF) {
+            int reg = (op & 7) | ((rex & 1) << 3);
+            uint64_t value = width == 3 ? takeUint64() : static_cast<uint32_t>(takeInt32());
+            return std::string(width == 3 ? "movabs " : "mov ") + registerNames[width][reg] + ", " + hex(value);
+        }
+        if (op >= 0x70 && op <= 0x7F) {
+            branch = true;
+            target = relative(static_cast<int8_t>(take()));
+            return std::string("j") + conditionNames[op & 0x0F];
+        }
+        return "";
+    }
+
+private:
+    const uint8_t* bytes;
+    size_t length;
+    uint64_t address;  // of the first byte
+    size_t at = 0;
+    uint8_t rex = 0;
+    std::string rm;    // the r/m operand modrm() decoded
+
+    uint8_t peek() const { return at < length ? bytes[at] : 0; }
+    uint8_t take() { return at < length ? bytes[at++] : 0; }
+    int32_t takeInt32() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(take()) << (8 * i);
+        return static_cast<int32_t>(value);
+    }
+    uint64_t takeUint64() {
+        uint64_t low = static_cast<uint32_t>(takeInt32());
+        return low | static_cast<uint64_t>(static_cast<uint32_t>(takeInt32())) << 32;
+    }
+    // Branch displacements count from the end of the instruction; the
+    // result is relative to its start
+    int64_t relative(int64_t disp) const { return static_cast<int64_t>(length) + disp; }
+
+    // Reads ModR/M (and SIB and displacement), leaving the r/m operand in
+    // `rm`; returns the reg field. `size` prefixes a memory operand whose
+    // width the other operand does not give.
+    int modrm(int width, const char* size = "") {
+        uint8_t byte = take();
+        int mod = byte >> 6;
+        int reg = ((byte >> 3) & 7) | ((rex & 4) << 1);
+        int base = byte & 7;
+        if (mod == 3) {
+            rm = registerNames[width][base | ((rex & 1) << 3)];
+            return reg;
+        }
+        std::string address;
+        bool ripRelative = false;
+        if (base == 4) {
+            uint8_t sib = take();
+            int index = ((sib >> 3) & 7) | ((rex & 2) << 2);
+            int scale = 1 << (sib >> 6);
+            address = registerNames[3][(sib & 7) | ((rex & 1) << 3)];
+            if (index != 4) {
+                address += std::string(" + ") + registerNames[3][index];
+                if (scale > 1) address += "*" + std::to_string(scale);
+            }
+        } else if (base == 5 && mod == 0) {
+            address = "rip";
+            ripRelative = true;
+        } else {
+            address = registerNames[3][base | ((rex & 1) << 3)];
+        }
+        int64_t disp = mod == 1 ? static_cast<int8_t>(take()) : (mod == 2 || ripRelative) ? takeInt32() : 0;
+        if (disp > 0) address += " + " + hex(static_cast<uint64_t>(disp));
+        if (disp < 0) address += " - " + hex(0 - static_cast<uint64_t>(disp));
+        rm = std::string(size) + "[" + address + "]";
+        // RIP counts from the next instruction; name the address it reaches
+        if (ripRelative) rm += " {" + hex(this->address + length + static_cast<uint64_t>(disp)) + "}";
+        return reg;
+    }
+
+    std::string decodeTwoByte(int width, bool& branch, int64_t& target) {
+        uint8_t op = take();
+        if (op == 0x05) return "syscall";
+        if (op >= 0x80 && op <= 0x8F) {
+            branch = true;
+            target = relative(takeInt32());
+            return std::string("j") + conditionNames[op & 0x0F];
+        }
+        if (op >= 0x90 && op <= 0x9F) {
+            modrm(0);
+            return std::string("set") + conditionNames[op & 0x0F] + " " + rm;
+        }
+        if (op >= 0x40 && op <= 0x4F) {
+            int reg = modrm(width);
+            return std::string("cmov") + conditionNames[op & 0x0F] + " " + registerNames[width][reg] + ", " + rm;
+        }
+        if (op == 0xAF) {
+            int reg = modrm(width);
+            return std::string("imul ") + registerNames[width][reg] + ", " + rm;
+        }
+        if (op == 0xB6 || op == 0xB7) {
+            int reg = modrm(op == 0xB6 ? 0 : 1, op == 0xB6 ? "byte " : "word ");
+            return std::string("movzx ") + registerNames[width][reg] + ", " + rm;
+        }
+        return "";
+    }
+};
+
+} // namespace
+
+void MachineCodeEmitter::writeListing(std::ostream& out, uint64_t codeAddress) const {
+    // Labels by offset; several can share one, as a return label does
+    // with the epilogue it names
+    std::vector<std::pair<uint32_t, std::string>> labels;
+    for (auto& label : section.labels) labels.push_back({label.second, label.first});
+    std::sort(labels.begin(), labels.end());
+    std::unordered_map<uint32_t, std::string> labelAt;
+    for (auto& label : labels) labelAt.emplace(label.first, label.second);
+
+    out << "; C.A.S.E. AOT listing: " << section.code.size() << " bytes at " << hex(codeAddress) << "\n";
+    auto label = labels.begin();
+    const auto& listed = section.listed;
+    for (size_t i = 0; i < listed.size(); ++i) {
+        uint32_t offset = listed[i].offset;
+        uint32_t end = i + 1 < listed.size() ? listed[i + 1].offset : static_cast<uint32_t>(section.code.size());
+        for (; label != labels.end() && label->first <= offset; ++label) out << label->second << ":\n";
+
+        std::string bytes;
+        char text[4];
+        for (uint32_t b = offset; b < end; ++b) {
+            std::snprintf(text, sizeof(text), "%02x ", section.code[b]);
+            bytes += text;
+        }
+        bool branch = false;
+        int64_t target = 0;
+        Decoder decoder(section.code.data() + offset, end - offset, codeAddress + offset);
+        std::string instruction = decoder.decode(branch, target);
+        if (instruction.empty()) {
+            instruction = std::string("(") + listed[i].mnemonic + ")";
+        } else if (branch) {
+            uint32_t destination = static_cast<uint32_t>(offset + target);
+            auto name = labelAt.find(destination);
+            instruction += " " + (name != labelAt.end() ? name->second : hex(codeAddress + destination));
+        }
+
+        char prefix[32];
+        std::snprintf(prefix, sizeof(prefix), "  %06x  ", offset);
+        out << prefix << bytes;
+        for (size_t pad = bytes.size(); pad < 33; ++pad) out << ' ';
+        out << instruction;
+        if (listed[i].line > 0) {
+            for (size_t pad = instruction.size(); pad < 40; ++pad) out << ' ';
+            out << " ; line " << listed[i].line;
+        }
+        out << "\n";
     }
-    
-    section.emitLabel(endLabel);
-    regAlloc.free(condReg);
 }
 
-void MachineCodeEmitter::emitWhileStmt(NodePtr condition, NodePtr block) {
-    std::string loopLabel = generateLabel("loop");
-    std::string endLabel = generateLabel("endloop");
-    
-    section.emitLabel(loopLabel);
-    
-    CIAM::Reg condReg = emitExpr(condition);
-    section.emitBytes(CIAM::X64Builder::XOR_REG_REG(CIAM::Reg::R11).bytes);
-    section.emitBytes(CIAM::X64Builder::CMP_REG_REG(condReg, CIAM::Reg::R11).bytes);
-    
- // Jump to end if condition is false
-    section.addRelocation(endLabel);
-    section.emitBytes(CIAM::X64Builder::JE_REL32(0).bytes);
-  
-    // Loop body
-    emitNode(block);
-    
-    // Jump back to loop start
-    section.addRelocation(loopLabel);
-    section.emitBytes(CIAM::X64Builder::JMP_REL32(0).bytes);
-    
-    section.emitLabel(endLabel);
-    regAlloc.free(condReg);
+bool MachineCodeEmitter::writePerfMap(const std::string& path, uint64_t codeAddress) const {
+    std::vector<std::pair<uint32_t, std::string>> starts;
+    for (auto& name : symbols) {
+        auto found = section.labels.find(name);
+        if (found != section.labels.end()) starts.push_back({found->second, name});
+    }
+    std::sort(starts.begin(), starts.end());
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        uint32_t end = i + 1 < starts.size() ? starts[i + 1].first : static_cast<uint32_t>(section.code.size());
+        std::fprintf(file, "%llx %x %s\n", static_cast<unsigned long long>(codeAddress + starts[i].first),
+                     end - starts[i].first, starts[i].second.c_str());
+    }
+    return std::fclose(file) == 0;
 }
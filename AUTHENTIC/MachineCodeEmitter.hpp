@@ -10,6 +10,7 @@
 #include "AST.hpp"
 #include <vector>
 #include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <unordered_map>
 #include <memory>
@@ -24,20 +25,43 @@ namespace CIAM {
 enum class Reg : uint8_t {
     RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
     R8, R9, R10, R11, R12, R13, R14, R15,
+    RIP = 0x10,  // Addressing only: LEA_REG_MEM base for [rip + disp32]
     NONE = 0xFF
 };
 
-// CIAM MACRO: Instruction encoding abstraction
+// CIAM MACRO: Condition codes, the low nibble of Jcc / SETcc / CMOVcc
+enum class Cond : uint8_t {
+    O = 0, NO, B, AE, E, NE, BE, A,
+    S, NS, P, NP, L, GE, LE, G
+};
+
+// The opposite condition: codes come in pairs differing in the low bit
+inline Cond negate(Cond cc) {
+    return static_cast<Cond>(static_cast<uint8_t>(cc) ^ 1);
+}
+
+// CIAM MACRO: Memory operand [base + index * scale + disp32]. A RIP base is
+// [rip + disp32]; CodeSection patches the displacement when it points into
+// a segment.
+struct Mem {
+    Reg base;
+    int32_t disp = 0;
+    Reg index = Reg::NONE;  // never RSP
+    uint8_t scale = 1;      // 1, 2, 4 or 8
+};
+
+// CIAM MACRO: Instruction encoding abstraction. Encoded inline: an x86-64
+// instruction is at most 15 bytes, so building one allocates nothing.
 struct Instruction {
-    std::vector<uint8_t> bytes;
-    std::string mnemonic;  // For debugging
+    static constexpr uint8_t MAX_LENGTH = 15;
+
+    uint8_t bytes[MAX_LENGTH];
+    uint8_t length = 0;
+    const char* mnemonic = "";  // static text, kept only for a listing
     
-    void emit_byte(uint8_t b) { bytes.push_back(b); }
+    void emit_byte(uint8_t b) { bytes[length++] = b; }
     void emit_dword(uint32_t d) {
-      bytes.push_back(d & 0xFF);
-  bytes.push_back((d >> 8) & 0xFF);
-        bytes.push_back((d >> 16) & 0xFF);
-    bytes.push_back((d >> 24) & 0xFF);
+        for (int i = 0; i < 4; ++i) bytes[length++] = static_cast<uint8_t>(d >> (8 * i));
     }
     void emit_qword(uint64_t q) {
         emit_dword(q & 0xFFFFFFFF);
@@ -47,11 +71,44 @@ struct Instruction {
 
 // CIAM MACRO: Platform-specific code section abstraction
 struct CodeSection {
+    enum class Segment : uint8_t { Rodata, Bss };
+
+    // A RIP-relative disp32 field in the code and the segment offset it reaches
+    struct DataReference {
+        uint32_t field;
+        Segment segment;
+        uint32_t offset;
+    };
+
     std::vector<uint8_t> code;
  std::vector<uint8_t> data;
+    // Read-only segment: string literals, each stored once
+    std::vector<uint8_t> rodata;
+    std::unordered_map<std::string, uint32_t> strings;
+    // Zero-filled writable memory placed after the data (runtime buffers)
+    uint32_t bssSize = 0;
     std::unordered_map<std::string, uint32_t> labels;
+    // Offset of the first byte of each jmp / jcc / call rel32 and its target
     std::vector<std::pair<uint32_t, std::string>> relocations;
-    
+    std::vector<DataReference> dataReferences;
+
+    // Set before emission to keep each instruction's offset, mnemonic and
+    // the source line it was emitted for (0: none)
+    struct ListedInstruction {
+        uint32_t offset;
+        const char* mnemonic;
+        int line;
+    };
+    bool listing = false;
+    int sourceLine = 0;
+    std::vector<ListedInstruction> listed;
+    uint64_t instructions = 0;  // emitted through emit()
+
+    // Filled in by resolve()
+    std::vector<std::string> unresolved;  // targets with no label, once each
+    uint32_t shortBranches = 0;           // jumps relaxed to the rel8 form
+    uint32_t bytesSaved = 0;
+
     uint32_t currentOffset() const { return static_cast<uint32_t>(code.size()); }
     
     void emitLabel(const std::string& name) {
@@ -61,10 +118,54 @@ struct CodeSection {
     void emitBytes(const std::vector<uint8_t>& bytes) {
         code.insert(code.end(), bytes.begin(), bytes.end());
     }
+
+    // Appends an encoded instruction straight onto the code
+    void emit(const Instruction& inst) {
+        if (listing) listed.push_back({currentOffset(), inst.mnemonic, sourceLine});
+        ++instructions;
+        code.insert(code.end(), inst.bytes, inst.bytes + inst.length);
+    }
     
+    // Offset of `bytes` in rodata, appending them the first time they are seen
+    uint32_t internString(const std::string& bytes) {
+        auto found = strings.find(bytes);
+        if (found != strings.end()) return found->second;
+        uint32_t offset = static_cast<uint32_t>(rodata.size());
+        rodata.insert(rodata.end(), bytes.begin(), bytes.end());
+        strings.emplace(bytes, offset);
+        return offset;
+    }
+
+    // Offset of `size` zeroed bytes in the bss, aligned to `align`
+    uint32_t reserveBss(uint32_t size, uint32_t align = 8) {
+        uint32_t offset = (bssSize + align - 1) & ~(align - 1);
+        bssSize = offset + size;
+        return offset;
+    }
+
+    // Emits an instruction whose last four bytes are a RIP-relative disp32,
+    // patched by link() to reach `offset` in `segment`
+    void emitDataReference(const Instruction& inst, Segment segment, uint32_t offset) {
+        emit(inst);
+        dataReferences.push_back({currentOffset() - 4, segment, offset});
+    }
+
+    // Call just before emitting the jmp / jcc / call it belongs to
     void addRelocation(const std::string& label) {
         relocations.push_back({currentOffset(), label});
     }
+
+    // Fixup pass, run once after emission. Jumps whose target lands within
+    // rel8 range are rewritten to the 2-byte short form (repeated until no
+    // more fit, since each one shrinks the code between others), then every
+    // rel32 / rel8 field is patched and labels and relocations are moved to
+    // their final offsets. False when some target has no label; those
+    // instructions keep a zero displacement and are listed in `unresolved`.
+    bool resolve();
+
+    // Patches the data references once the image layout has placed the
+    // segments at their virtual addresses; run after resolve()
+    void link(uint64_t codeAddress, uint64_t rodataAddress, uint64_t bssAddress);
 };
 
 // CIAM MACRO: x86-64 instruction builder
@@ -84,15 +185,61 @@ public:
         return inst;
   }
     
+    // CIAM: mov r32, imm32; writing the low half zeroes the upper one
+    static Instruction MOV_REG_IMM32(Reg dst, uint32_t imm) {
+        Instruction inst;
+        inst.mnemonic = "mov reg32, imm32";
+
+        if (static_cast<uint8_t>(dst) >= 8) inst.emit_byte(0x41);
+        inst.emit_byte(0xB8 | (static_cast<uint8_t>(dst) & 0x7));
+        inst.emit_dword(imm);
+
+        return inst;
+    }
+
+    // CIAM: mov r64, imm32 sign-extended
+    static Instruction MOV_REG_SIMM32(Reg dst, int32_t imm) {
+        Instruction inst;
+        inst.mnemonic = "mov reg, simm32";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(dst) >> 3) & 1));
+        inst.emit_byte(0xC7);
+        inst.emit_byte(0xC0 | (static_cast<uint8_t>(dst) & 0x7));
+        inst.emit_dword(static_cast<uint32_t>(imm));
+
+        return inst;
+    }
+
+    // CIAM: xor r32, r32, the zeroing idiom (clears the whole register)
+    static Instruction XOR_REG32(Reg reg) {
+        Instruction inst;
+        inst.mnemonic = "xor reg32, reg32";
+
+        if (static_cast<uint8_t>(reg) >= 8) inst.emit_byte(0x45);
+        inst.emit_byte(0x31);
+        inst.emit_byte(0xC0 | ((static_cast<uint8_t>(reg) & 0x7) << 3) | (static_cast<uint8_t>(reg) & 0x7));
+
+        return inst;
+    }
+
+    // CIAM: Shortest load of a constant: xor (2-3 bytes, clobbers the
+    // flags), mov r32 (5-6), sign-extended mov (7) or movabs (10)
+    static Instruction MOV_REG_CONST(Reg dst, int64_t value) {
+        if (value == 0) return XOR_REG32(dst);
+        if (value > 0 && value <= UINT32_MAX) return MOV_REG_IMM32(dst, static_cast<uint32_t>(value));
+        if (value >= INT32_MIN && value < 0) return MOV_REG_SIMM32(dst, static_cast<int32_t>(value));
+        return MOV_REG_IMM(dst, static_cast<uint64_t>(value));
+    }
+    
     // CIAM: ADD instruction abstraction
     static Instruction ADD_REG_REG(Reg dst, Reg src) {
         Instruction inst;
         inst.mnemonic = "add reg, reg";
         
-        // REX.W prefix
+        // REX.W, with REX.R for src (ModR/M reg) and REX.B for dst (r/m)
         inst.emit_byte(0x48 | 
-            ((static_cast<uint8_t>(dst) >> 3) & 1) << 2 |
-((static_cast<uint8_t>(src) >> 3) & 1));
+            ((static_cast<uint8_t>(src) >> 3) & 1) << 2 |
+((static_cast<uint8_t>(dst) >> 3) & 1));
         // ADD opcode
         inst.emit_byte(0x01);
         // ModR/M byte
@@ -109,8 +256,8 @@ public:
    inst.mnemonic = "sub reg, reg";
     
         inst.emit_byte(0x48 | 
-            ((static_cast<uint8_t>(dst) >> 3) & 1) << 2 |
-            ((static_cast<uint8_t>(src) >> 3) & 1));
+            ((static_cast<uint8_t>(src) >> 3) & 1) << 2 |
+            ((static_cast<uint8_t>(dst) >> 3) & 1));
         inst.emit_byte(0x29);
         inst.emit_byte(0xC0 | 
          ((static_cast<uint8_t>(src) & 0x7) << 3) |
@@ -203,6 +350,18 @@ public:
       
         return inst;
   }
+
+    // CIAM: Jcc for any condition
+    static Instruction JCC_REL32(Cond cc, int32_t offset) {
+        Instruction inst;
+        inst.mnemonic = "jcc rel32";
+
+        inst.emit_byte(0x0F);
+        inst.emit_byte(0x80 | static_cast<uint8_t>(cc));
+        inst.emit_dword(static_cast<uint32_t>(offset));
+
+        return inst;
+    }
     
   // CIAM: CMP instruction abstraction
     static Instruction CMP_REG_REG(Reg left, Reg right) {
@@ -210,8 +369,8 @@ public:
         inst.mnemonic = "cmp reg, reg";
         
         inst.emit_byte(0x48 | 
-((static_cast<uint8_t>(left) >> 3) & 1) << 2 |
-        ((static_cast<uint8_t>(right) >> 3) & 1));
+((static_cast<uint8_t>(right) >> 3) & 1) << 2 |
+        ((static_cast<uint8_t>(left) >> 3) & 1));
         inst.emit_byte(0x39);
         inst.emit_byte(0xC0 | 
   ((static_cast<uint8_t>(right) & 0x7) << 3) |
@@ -243,7 +402,8 @@ public:
         Instruction inst;
   inst.mnemonic = "xor reg, reg";
         
-        inst.emit_byte(0x48 | ((static_cast<uint8_t>(reg) >> 3) & 1) << 2);
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(reg) >> 3) & 1) << 2 |
+            ((static_cast<uint8_t>(reg) >> 3) & 1));
         inst.emit_byte(0x31);
         inst.emit_byte(0xC0 | 
             ((static_cast<uint8_t>(reg) & 0x7) << 3) |
@@ -254,6 +414,7 @@ public:
     
     // CIAM: LEA (Load Effective Address)
     static Instruction LEA_REG_MEM(Reg dst, Reg base, int32_t offset) {
+        if (base == Reg::RIP) return LEA_REG_RIP(dst, offset);
         Instruction inst;
         inst.mnemonic = "lea reg, [base + offset]";
     
@@ -266,10 +427,402 @@ public:
         inst.emit_byte(0x80 | 
             ((static_cast<uint8_t>(dst) & 0x7) << 3) |
             (static_cast<uint8_t>(base) & 0x7));
+        // RSP / R12 as base can only be encoded through a SIB byte
+        if ((static_cast<uint8_t>(base) & 0x7) == 4) inst.emit_byte(0x24);
      inst.emit_dword(static_cast<uint32_t>(offset));
   
         return inst;
     }
+
+    // CIAM: LEA reg, [rip + disp32] (ModR/M mod 00, r/m 101); the
+    // displacement counts from the end of the instruction
+    static Instruction LEA_REG_RIP(Reg dst, int32_t disp) {
+        Instruction inst;
+        inst.mnemonic = "lea reg, [rip + disp32]";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(dst) >> 3) & 1) << 2);
+        inst.emit_byte(0x8D);
+        inst.emit_byte(0x05 | ((static_cast<uint8_t>(dst) & 0x7) << 3));
+        inst.emit_dword(static_cast<uint32_t>(disp));
+
+        return inst;
+    }
+
+    // CIAM: LEA with a full memory operand (index, scale)
+    static Instruction LEA_REG_ADDR(Reg dst, const Mem& mem) {
+        Instruction inst;
+        inst.mnemonic = "lea reg, [mem]";
+        emitRex(inst, true, dst, mem);
+        inst.emit_byte(0x8D);
+        emitMemOperand(inst, dst, mem);
+        return inst;
+    }
+
+    // CIAM: MOV between registers
+    static Instruction MOV_REG_REG(Reg dst, Reg src) {
+        Instruction inst;
+        inst.mnemonic = "mov reg, reg";
+
+        inst.emit_byte(0x48 |
+            ((static_cast<uint8_t>(src) >> 3) & 1) << 2 |
+            ((static_cast<uint8_t>(dst) >> 3) & 1));
+        inst.emit_byte(0x89);
+        inst.emit_byte(0xC0 |
+            ((static_cast<uint8_t>(src) & 0x7) << 3) |
+            (static_cast<uint8_t>(dst) & 0x7));
+
+        return inst;
+    }
+
+    // CIAM: 64-bit load and store
+    static Instruction MOV_REG_MEM(Reg dst, const Mem& mem) {
+        Instruction inst;
+        inst.mnemonic = "mov reg, [mem]";
+        emitRex(inst, true, dst, mem);
+        inst.emit_byte(0x8B);
+        emitMemOperand(inst, dst, mem);
+        return inst;
+    }
+
+    static Instruction MOV_MEM_REG(const Mem& mem, Reg src) {
+        Instruction inst;
+        inst.mnemonic = "mov [mem], reg";
+        emitRex(inst, true, src, mem);
+        inst.emit_byte(0x89);
+        emitMemOperand(inst, src, mem);
+        return inst;
+    }
+
+    // CIAM: 16-bit load (zero-extended) and store
+    static Instruction MOVZX_REG_MEM16(Reg dst, const Mem& mem) {
+        Instruction inst;
+        inst.mnemonic = "movzx reg, word [mem]";
+        emitRex(inst, true, dst, mem);
+        inst.emit_byte(0x0F);
+        inst.emit_byte(0xB7);
+        emitMemOperand(inst, dst, mem);
+        return inst;
+    }
+
+    static Instruction MOV_MEM16_REG(const Mem& mem, Reg src) {
+        Instruction inst;
+        inst.mnemonic = "mov word [mem], reg";
+        inst.emit_byte(0x66);
+        emitRex(inst, false, src, mem);
+        inst.emit_byte(0x89);
+        emitMemOperand(inst, src, mem);
+        return inst;
+    }
+
+    // CIAM: Byte store of an immediate
+    static Instruction MOV_MEM8_IMM(const Mem& mem, uint8_t imm) {
+        Instruction inst;
+        inst.mnemonic = "mov byte [mem], imm8";
+        emitRex(inst, false, Reg::RAX, mem);
+        inst.emit_byte(0xC6);
+        emitMemOperand(inst, Reg::RAX, mem);
+        inst.emit_byte(imm);
+        return inst;
+    }
+
+    // CIAM: Unsigned RDX:RAX = RAX * src
+    static Instruction MUL_REG(Reg src) {
+        Instruction inst;
+        inst.mnemonic = "mul reg";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(src) >> 3) & 1));
+        inst.emit_byte(0xF7);
+        inst.emit_byte(0xE0 | (static_cast<uint8_t>(src) & 0x7));
+
+        return inst;
+    }
+
+    // CIAM: Logical right shift by a constant
+    static Instruction SHR_REG_IMM(Reg reg, uint8_t count) {
+        Instruction inst;
+        inst.mnemonic = "shr reg, imm8";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(reg) >> 3) & 1));
+        inst.emit_byte(0xC1);
+        inst.emit_byte(0xE8 | (static_cast<uint8_t>(reg) & 0x7));
+        inst.emit_byte(count);
+
+        return inst;
+    }
+
+    // CIAM: Copy RCX bytes from [RSI] to [RDI]
+    static Instruction REP_MOVSB() {
+        Instruction inst;
+        inst.mnemonic = "rep movsb";
+        inst.emit_byte(0xF3);
+        inst.emit_byte(0xA4);
+        return inst;
+    }
+
+    // CIAM: Arithmetic with a sign-extended imm8 (83 /n) or imm32 (81 /n)
+    static Instruction ADD_REG_IMM(Reg reg, int32_t imm) { return aluImm("add reg, imm", 0, reg, imm); }
+    static Instruction OR_REG_IMM(Reg reg, int32_t imm) { return aluImm("or reg, imm", 1, reg, imm); }
+    static Instruction AND_REG_IMM(Reg reg, int32_t imm) { return aluImm("and reg, imm", 4, reg, imm); }
+    static Instruction SUB_REG_IMM(Reg reg, int32_t imm) { return aluImm("sub reg, imm", 5, reg, imm); }
+    static Instruction XOR_REG_IMM(Reg reg, int32_t imm) { return aluImm("xor reg, imm", 6, reg, imm); }
+    static Instruction CMP_REG_IMM(Reg reg, int32_t imm) { return aluImm("cmp reg, imm", 7, reg, imm); }
+
+    // CIAM: Bitwise dst op= src
+    static Instruction AND_REG_REG(Reg dst, Reg src) { return aluRegReg("and reg, reg", 0x21, dst, src); }
+    static Instruction OR_REG_REG(Reg dst, Reg src) { return aluRegReg("or reg, reg", 0x09, dst, src); }
+    static Instruction XOR_REG_REG(Reg dst, Reg src) { return aluRegReg("xor reg, reg", 0x31, dst, src); }
+
+    // CIAM: One-operand F7 group: negate, complement, signed multiply and
+    // divide of RDX:RAX
+    static Instruction NOT_REG(Reg reg) { return unaryGroup("not reg", 0xF7, 2, reg); }
+    static Instruction NEG_REG(Reg reg) { return unaryGroup("neg reg", 0xF7, 3, reg); }
+    static Instruction IMUL_REG(Reg src) { return unaryGroup("imul reg", 0xF7, 5, src); }  // RDX:RAX = RAX * src
+    static Instruction IDIV_REG(Reg src) { return unaryGroup("idiv reg", 0xF7, 7, src); }  // RAX, RDX = RDX:RAX / src
+
+    // CIAM: Sign-extend RAX into RDX before idiv
+    static Instruction CQO() {
+        Instruction inst;
+        inst.mnemonic = "cqo";
+        inst.emit_byte(0x48);
+        inst.emit_byte(0x99);
+        return inst;
+    }
+
+    // CIAM: Shifts by a constant (C1 /n ib) or by CL (D3 /n)
+    static Instruction SHL_REG_IMM(Reg reg, uint8_t count) {
+        Instruction inst = unaryGroup("shl reg, imm8", 0xC1, 4, reg);
+        inst.emit_byte(count);
+        return inst;
+    }
+    static Instruction SAR_REG_IMM(Reg reg, uint8_t count) {
+        Instruction inst = unaryGroup("sar reg, imm8", 0xC1, 7, reg);
+        inst.emit_byte(count);
+        return inst;
+    }
+    static Instruction SHL_REG_CL(Reg reg) { return unaryGroup("shl reg, cl", 0xD3, 4, reg); }
+    static Instruction SHR_REG_CL(Reg reg) { return unaryGroup("shr reg, cl", 0xD3, 5, reg); }
+    static Instruction SAR_REG_CL(Reg reg) { return unaryGroup("sar reg, cl", 0xD3, 7, reg); }
+
+    // CIAM: dst = src * imm
+    static Instruction IMUL_REG_REG_IMM(Reg dst, Reg src, int32_t imm) {
+        Instruction inst;
+        inst.mnemonic = "imul reg, reg, imm";
+
+        bool short_ = imm >= -128 && imm <= 127;
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(dst) >> 3) & 1) << 2 |
+                       ((static_cast<uint8_t>(src) >> 3) & 1));
+        inst.emit_byte(short_ ? 0x6B : 0x69);
+        inst.emit_byte(0xC0 | ((static_cast<uint8_t>(dst) & 0x7) << 3) | (static_cast<uint8_t>(src) & 0x7));
+        if (short_) inst.emit_byte(static_cast<uint8_t>(imm));
+        else inst.emit_dword(static_cast<uint32_t>(imm));
+
+        return inst;
+    }
+
+    // CIAM: dst = base + imm in one instruction without touching the
+    // flags; a 4-byte lea for small constants
+    static Instruction LEA_REG_ADD(Reg dst, Reg base, int32_t imm) {
+        Instruction inst = LEA_REG_ADDR(dst, {base, imm});
+        inst.mnemonic = "lea reg, [reg + imm]";
+        return inst;
+    }
+
+    // CIAM: Flags from reg & reg; test x, x is the short compare with zero
+    static Instruction TEST_REG_REG(Reg left, Reg right) {
+        Instruction inst;
+        inst.mnemonic = "test reg, reg";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(right) >> 3) & 1) << 2 |
+                       ((static_cast<uint8_t>(left) >> 3) & 1));
+        inst.emit_byte(0x85);
+        inst.emit_byte(0xC0 | ((static_cast<uint8_t>(right) & 0x7) << 3) |
+                       (static_cast<uint8_t>(left) & 0x7));
+
+        return inst;
+    }
+
+    // CIAM: Low byte of reg = 1 if cc holds, else 0
+    static Instruction SETCC_REG8(Cond cc, Reg reg) {
+        Instruction inst;
+        inst.mnemonic = "setcc reg8";
+
+        // Any REX selects SPL / BPL / SIL / DIL rather than AH..BH
+        if (static_cast<uint8_t>(reg) >= 4) inst.emit_byte(0x40 | ((static_cast<uint8_t>(reg) >> 3) & 1));
+        inst.emit_byte(0x0F);
+        inst.emit_byte(0x90 | static_cast<uint8_t>(cc));
+        inst.emit_byte(0xC0 | (static_cast<uint8_t>(reg) & 0x7));
+
+        return inst;
+    }
+
+    // CIAM: Zero-extend a byte in memory into dst
+    static Instruction MOVZX_REG_MEM8(Reg dst, const Mem& mem) {
+        Instruction inst;
+        inst.mnemonic = "movzx reg, byte [mem]";
+        emitRex(inst, false, dst, mem);
+        inst.emit_byte(0x0F);
+        inst.emit_byte(0xB6);
+        emitMemOperand(inst, dst, mem);
+        return inst;
+    }
+
+    // CIAM: Zero-extend the low byte of src into dst
+    static Instruction MOVZX_REG_REG8(Reg dst, Reg src) {
+        Instruction inst;
+        inst.mnemonic = "movzx reg, reg8";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(dst) >> 3) & 1) << 2 |
+                       ((static_cast<uint8_t>(src) >> 3) & 1));
+        inst.emit_byte(0x0F);
+        inst.emit_byte(0xB6);
+        inst.emit_byte(0xC0 | ((static_cast<uint8_t>(dst) & 0x7) << 3) | (static_cast<uint8_t>(src) & 0x7));
+
+        return inst;
+    }
+
+    // CIAM: dst = src if cc holds
+    static Instruction CMOVCC_REG_REG(Cond cc, Reg dst, Reg src) {
+        Instruction inst;
+        inst.mnemonic = "cmovcc reg, reg";
+
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(dst) >> 3) & 1) << 2 |
+                       ((static_cast<uint8_t>(src) >> 3) & 1));
+        inst.emit_byte(0x0F);
+        inst.emit_byte(0x40 | static_cast<uint8_t>(cc));
+        inst.emit_byte(0xC0 | ((static_cast<uint8_t>(dst) & 0x7) << 3) | (static_cast<uint8_t>(src) & 0x7));
+
+        return inst;
+    }
+
+private:
+    // REX with W and the R / X / B extensions of `reg` and `mem`; left out
+    // when no bit is set
+    static void emitRex(Instruction& inst, bool wide, Reg reg, const Mem& mem) {
+        uint8_t rex = (wide ? 0x08 : 0) | ((static_cast<uint8_t>(reg) >> 3) & 1) << 2;
+        if (mem.index != Reg::NONE) rex |= ((static_cast<uint8_t>(mem.index) >> 3) & 1) << 1;
+        if (mem.base != Reg::RIP) rex |= (static_cast<uint8_t>(mem.base) >> 3) & 1;
+        if (rex) inst.emit_byte(0x40 | rex);
+    }
+
+    // ModR/M, SIB when needed, and the shortest displacement: none, disp8
+    // or disp32. [rip + disp32] is always the 4-byte form, so CodeSection
+    // finds its displacement as the last field unless an immediate follows.
+    static void emitMemOperand(Instruction& inst, Reg reg, const Mem& mem) {
+        uint8_t r = (static_cast<uint8_t>(reg) & 0x7) << 3;
+        if (mem.base == Reg::RIP) {
+            inst.emit_byte(0x05 | r);
+            inst.emit_dword(static_cast<uint32_t>(mem.disp));
+            return;
+        }
+        uint8_t base = static_cast<uint8_t>(mem.base) & 0x7;
+        // mod 00 with an RBP / R13 base means something else, so those
+        // always carry a displacement
+        uint8_t mod = (mem.disp == 0 && base != 5) ? 0x00 : (mem.disp >= -128 && mem.disp <= 127) ? 0x40 : 0x80;
+        if (mem.index != Reg::NONE || base == 4) {
+            uint8_t index = mem.index != Reg::NONE ? (static_cast<uint8_t>(mem.index) & 0x7) : 4;
+            uint8_t ss = mem.scale == 8 ? 3 : mem.scale == 4 ? 2 : mem.scale == 2 ? 1 : 0;
+            inst.emit_byte(mod | 0x04 | r);
+            inst.emit_byte(static_cast<uint8_t>(ss << 6 | index << 3 | base));
+        } else {
+            inst.emit_byte(mod | r | base);
+        }
+        if (mod == 0x40) inst.emit_byte(static_cast<uint8_t>(mem.disp));
+        else if (mod == 0x80) inst.emit_dword(static_cast<uint32_t>(mem.disp));
+    }
+
+    // REX.W opcode /r with src in ModR/M.reg and dst in r/m
+    static Instruction aluRegReg(const char* mnemonic, uint8_t opcode, Reg dst, Reg src) {
+        Instruction inst;
+        inst.mnemonic = mnemonic;
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(src) >> 3) & 1) << 2 | ((static_cast<uint8_t>(dst) >> 3) & 1));
+        inst.emit_byte(opcode);
+        inst.emit_byte(0xC0 | ((static_cast<uint8_t>(src) & 0x7) << 3) | (static_cast<uint8_t>(dst) & 0x7));
+        return inst;
+    }
+
+    // REX.W opcode /digit on a register
+    static Instruction unaryGroup(const char* mnemonic, uint8_t opcode, uint8_t digit, Reg reg) {
+        Instruction inst;
+        inst.mnemonic = mnemonic;
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(reg) >> 3) & 1));
+        inst.emit_byte(opcode);
+        inst.emit_byte(0xC0 | digit << 3 | (static_cast<uint8_t>(reg) & 0x7));
+        return inst;
+    }
+
+    // Group-1 arithmetic: REX.W 83 /digit ib, or 81 /digit id
+    static Instruction aluImm(const char* mnemonic, uint8_t digit, Reg reg, int32_t imm) {
+        Instruction inst;
+        inst.mnemonic = mnemonic;
+        bool short_ = imm >= -128 && imm <= 127;
+        inst.emit_byte(0x48 | ((static_cast<uint8_t>(reg) >> 3) & 1));
+        inst.emit_byte(short_ ? 0x83 : 0x81);
+        inst.emit_byte(0xC0 | digit << 3 | (static_cast<uint8_t>(reg) & 0x7));
+        if (short_) inst.emit_byte(static_cast<uint8_t>(imm));
+        else inst.emit_dword(static_cast<uint32_t>(imm));
+        return inst;
+    }
+};
+
+// CIAM MACRO: Virtual code. MachineCodeEmitter lowers each function to
+// these on unlimited virtual registers; RegisterAllocator then gives every
+// virtual register a machine register or a stack slot for its lifetime.
+enum class VOp : uint8_t {
+    Label,        // label:
+    MovImm,       // dst = imm
+    Mov,          // dst = a
+    Add,          // dst = a + b
+    Sub,          // dst = a - b
+    Mul,          // dst = a * b
+    Div,          // dst = a / b, truncating
+    Mod,          // dst = a % b, with the sign of a
+    And,          // dst = a & b
+    Or,           // dst = a | b
+    Xor,          // dst = a ^ b
+    Shl,          // dst = a << b
+    Sar,          // dst = a >> b, arithmetic
+    Neg,          // dst = -a
+    Not,          // dst = ~a
+    SetCond,      // dst = (a cond b) ? 1 : 0
+    Branch,       // if (a cond b) goto label
+    Jump,         // goto label
+    Param,        // dst = incoming argument imm
+    Call,         // dst = label(args...); clobbers the caller-saved registers
+    Input,        // dst = integer read from stdin
+    PrintNumber,  // print a and a newline
+    PrintString,  // print `length` bytes of rodata at imm
+    Return        // return a (-1: nothing); the entry function exits
+};
+
+struct VInst {
+    VOp op;
+    int dst = -1;
+    int a = -1;
+    int b = -1;
+    int64_t imm = 0;
+    uint32_t length = 0;
+    Cond cond = Cond::E;
+    bool immediate = false;  // b is unused; the right operand is imm
+    std::string label{};
+    std::vector<int> args{}; // Call
+    int line = 0;            // source line it was lowered from
+};
+
+struct VFunction {
+    std::string name;   // label of the first instruction
+    bool entry = false; // _start: ends in sys_exit rather than ret
+    std::vector<VInst> code;
+    int registers = 0;
+
+    int newRegister() { return registers++; }
+};
+
+// Where a virtual register lives: `reg`, or stack slot `slot` when spilled
+struct Location {
+    Reg reg = Reg::NONE;
+    int slot = -1;
+
+    bool spilled() const { return reg == Reg::NONE; }
 };
 
 } // namespace CIAM
@@ -278,61 +831,43 @@ public:
 // Register Allocator (CIAM-based)
 // -----------------------------------------------------------------------------
 
+// Linear scan (Poletto & Sarkar) over a function's virtual code. Liveness
+// comes from a backward dataflow pass over its basic blocks, so a value
+// used around a loop stays live through the whole loop. Each virtual
+// register gets one interval, from its first to its last live point, and
+// keeps one location for all of it. When no register is free the interval
+// that ends last is spilled.
+//
+// Follows the SysV ABI: values live across a call only get callee-saved
+// registers (RBX, R12-R15), and the prologue saves the ones used. Other
+// values prefer the caller-saved RSI, RDI and R8-R10. RAX, RCX, RDX and R11
+// are never allocated. They are scratch for reloading spilled operands, for
+// mul / div / shift operands, return values and the runtime routines.
 class RegisterAllocator {
 public:
-    RegisterAllocator() {
-        // Initialize available registers (avoid RSP, RBP for stack operations)
-      available = {
-CIAM::Reg::RAX, CIAM::Reg::RCX, CIAM::Reg::RDX, CIAM::Reg::RBX,
-        CIAM::Reg::RSI, CIAM::Reg::RDI,
-            CIAM::Reg::R8, CIAM::Reg::R9, CIAM::Reg::R10, CIAM::Reg::R11,
-            CIAM::Reg::R12, CIAM::Reg::R13, CIAM::Reg::R14, CIAM::Reg::R15
-        };
-    }
-    
-    CIAM::Reg allocate(const std::string& varName) {
-        if (varToReg.count(varName)) {
-          return varToReg[varName];
-        }
-        
-      if (available.empty()) {
-        // Spill to stack (simplified)
-    return CIAM::Reg::NONE;
-    }
-        
-CIAM::Reg reg = available.back();
-        available.pop_back();
-        varToReg[varName] = reg;
-     regToVar[reg] = varName;
-        
-        return reg;
-    }
-    
-    void free(CIAM::Reg reg) {
-        if (regToVar.count(reg)) {
-            std::string varName = regToVar[reg];
-            varToReg.erase(varName);
-            regToVar.erase(reg);
-        available.push_back(reg);
-        }
-    }
-    
-    void free(const std::string& varName) {
-        if (varToReg.count(varName)) {
-          CIAM::Reg reg = varToReg[varName];
-         free(reg);
-        }
-    }
-    
-    CIAM::Reg getReg(const std::string& varName) const {
-        auto it = varToReg.find(varName);
-        return (it != varToReg.end()) ? it->second : CIAM::Reg::NONE;
+    struct Result {
+        std::vector<CIAM::Location> locations;  // by virtual register
+        std::vector<CIAM::Reg> calleeSaved;     // used, in push order
+        int spillSlots = 0;
+        int spilled = 0;                        // virtual registers in slots
+    };
+
+    Result allocate(const CIAM::VFunction& fn) const;
+
+    static bool isCalleeSaved(CIAM::Reg reg) {
+        return reg == CIAM::Reg::RBX || reg == CIAM::Reg::R12 || reg == CIAM::Reg::R13 ||
+               reg == CIAM::Reg::R14 || reg == CIAM::Reg::R15;
     }
-    
+
 private:
-    std::vector<CIAM::Reg> available;
-    std::unordered_map<std::string, CIAM::Reg> varToReg;
-    std::unordered_map<CIAM::Reg, std::string> regToVar;
+    struct Interval {
+        int vreg;
+        int start;
+        int end;
+        bool crossesCall;
+    };
+
+    std::vector<Interval> buildIntervals(const CIAM::VFunction& fn) const;
 };
 
 // -----------------------------------------------------------------------------
@@ -344,31 +879,187 @@ public:
     MachineCodeEmitter() : labelCounter(0) {}
     
     std::vector<uint8_t> emit(NodePtr root);
+
+    // Call targets no function defined and variables nothing declared; the
+    // code emit() returned is not the program if this is not empty
+    const std::vector<std::string>& unresolvedSymbols() const { return section.unresolved; }
+
+    // Literals a register cannot hold (decimals, text outside Print); like
+    // unresolved symbols, they leave nothing worth writing out
+    const std::vector<std::string>& unsupportedLiterals() const { return unsupported; }
+
+    // String literals referenced by the code, for the read-only segment
+    const std::vector<uint8_t>& rodata() const { return section.rodata; }
+
+    // Size of the zero-filled writable memory the runtime needs
+    uint32_t bssSize() const { return section.bssSize; }
+
+    // Machine instructions emit() encoded, before jump relaxation
+    uint64_t instructionCount() const { return section.instructions; }
+
+    // Keep what writeListing() needs; call before emit()
+    void setListing(bool enabled) { section.listing = enabled; }
+
+    // Every instruction with its offset, bytes, operands and source line,
+    // under the labels that point at it; after link(), with the code's
+    // load address
+    void writeListing(std::ostream& out, uint64_t codeAddress) const;
+
+    // "start size name" per function and runtime routine, in hex: the
+    // /tmp/perf-<pid>.map format. False if `path` cannot be written
+    bool writePerfMap(const std::string& path, uint64_t codeAddress) const;
+
+    // Code with its data references patched for the given load addresses
+    const std::vector<uint8_t>& link(uint64_t codeAddress, uint64_t rodataAddress, uint64_t bssAddress) {
+        section.link(codeAddress, rodataAddress, bssAddress);
+        return section.code;
+    }
+
+    // Register allocation totals over every function
+    struct Stats {
+        int values = 0;      // virtual registers
+        int spilled = 0;
+        int spillSlots = 0;
+        int reloads = 0;     // loads of spilled operands
+        int stores = 0;      // stores of spilled results
+    };
+    const Stats& stats() const { return allocationStats; }
     
 private:
     CIAM::CodeSection section;
     RegisterAllocator regAlloc;
     int labelCounter;
+    Stats allocationStats;
+
+    // Lowering: the function being built and its variables, innermost
+    // block last. Function bodies are lowered after the entry code.
+    CIAM::VFunction* current = nullptr;
+    std::vector<std::unordered_map<std::string, int>> scopes;
+    std::vector<std::shared_ptr<FunctionDecl>> functions;
+    // Problems lowering found, reported once emission is done
+    std::vector<std::string> unknownVariables;  // once each
+    std::vector<std::string> unsupported;
+
+    // Encoding: locations for the function being encoded
+    const RegisterAllocator::Result* allocation = nullptr;
+    int savedRegisters = 0;     // callee-saved registers pushed
+    bool frameless = false;     // leaf without an rbp frame; returns with ret
+    std::string returnLabel;
+    int sourceLine = 0;         // line of the statement being lowered
+
+    // Functions and runtime routines, in code order, for the perf map
+    std::vector<std::string> symbols;
+    void beginSymbol(const std::string& name) {
+        section.emitLabel(name);
+        symbols.push_back(name);
+    }
     
+    // The leading '.' keeps these apart from function names
     std::string generateLabel(const std::string& prefix = "L") {
-        return prefix + std::to_string(labelCounter++);
+        return "." + prefix + std::to_string(labelCounter++);
+    }
+
+    void emitInst(const CIAM::Instruction& inst) { section.emit(inst); }
+
+    // Records the relocation for a jmp / jcc / call to `label`
+    void emitJump(const CIAM::Instruction& inst, const std::string& label) {
+        section.addRelocation(label);
+        emitInst(inst);
     }
+
+    // Lowering to virtual code
+    CIAM::VInst& append(CIAM::VOp op) {
+        current->code.push_back(CIAM::VInst{op});
+        current->code.back().line = sourceLine;
+        return current->code.back();
+    }
+    int lookupVariable(const std::string& name) const;
+    int declareVariable(const std::string& name);
     
     void emitNode(NodePtr node);
-    CIAM::Reg emitExpr(NodePtr expr);
+    int emitExpr(NodePtr expr);
     
   // Emit helper functions
     void emitPrint(NodePtr expr);
-    void emitFunction(const std::string& name, NodePtr body);
+    void emitFunction(std::shared_ptr<FunctionDecl> fn);
     void emitReturn(NodePtr value);
     void emitIfStmt(NodePtr condition, NodePtr thenBlock, NodePtr elseBlock);
     void emitWhileStmt(NodePtr condition, NodePtr block);
     void emitVarDecl(const std::string& name, NodePtr initializer);
+    // Branches to `label` when `condition` is `taken`; a comparison becomes
+    // one cmp + jcc rather than a 0/1 value tested again
+    void emitBranch(NodePtr condition, bool taken, const std::string& label);
+    // Signed condition for a comparison operator, false if `op` is not one
+    static bool comparison(const std::string& op, CIAM::Cond& cc);
+    // A numeric Literal small enough for an imm32 field
+    static bool constantOperand(NodePtr expr, int32_t& value);
+    // Appends `op` on `left` and `right`, a constant right operand as the
+    // immediate. A constant left one trades places when the operation
+    // allows it, mirroring a comparison's condition.
+    CIAM::VInst& appendBinary(CIAM::VOp op, NodePtr left, NodePtr right, CIAM::Cond cc = CIAM::Cond::E);
+    void emitAssign(const std::string& name, NodePtr value);
+    // The call's result register, -1 when `value` is false
+    int emitCall(std::shared_ptr<CallExpr> call, bool value);
+    void emitInput(std::shared_ptr<InputStmt> input);
+
+    // Encoding virtual code with its allocation
+    void encodeFunction(const CIAM::VFunction& fn);
+    void encodeInst(const CIAM::VInst& inst);
+    // Arithmetic with a constant right operand
+    void encodeImmediate(const CIAM::VInst& inst);
+    // Division and remainder by a constant without idiv: shifts for powers
+    // of two, a multiply by the reciprocal ("magic number") otherwise
+    void encodeDivideByConstant(const CIAM::VInst& inst);
+    // cmp or test for a SetCond / Branch, leaving the flags for its cc
+    void compare(const CIAM::VInst& inst);
+    int frameOffset(int slot) const;
+    // A register holding `vreg`: its own, or `scratch` after a reload
+    CIAM::Reg use(int vreg, CIAM::Reg scratch);
+    // Register to compute `vreg` into: its own, or `scratch` if spilled
+    CIAM::Reg target(int vreg, CIAM::Reg scratch) const;
+    // Stores `reg` to `vreg`'s slot when it is spilled
+    void store(int vreg, CIAM::Reg reg);
+
+    // SysV arguments: RDI, RSI, RDX, RCX, R8, R9, then the stack
+    static const CIAM::Reg argumentRegisters[6];
+    // Copies registers into registers as if all at once, through R11
+    // when the copies form a cycle
+    void emitParallelMove(std::vector<std::pair<CIAM::Reg, CIAM::Reg>> moves);
+    // Incoming arguments into the parameters' locations
+    void encodeParams(const std::vector<const CIAM::VInst*>& params);
+    void encodeCall(const CIAM::VInst& inst);
  
     // Platform-specific runtime calls
-    void emitPrintString(const std::string& str);
+    void emitPrintString(uint32_t offset, uint32_t length);
     void emitPrintNumber(CIAM::Reg reg);
     void emitSystemExit(int code);
+
+    // Runtime routines, emitted once after the program when it uses them.
+    // Output goes through a bss buffer flushed when full and at exit.
+    // Arguments go in RAX (and RDX), and the routines clobber only the
+    // scratch registers RAX, RCX, RDX and R11.
+    static constexpr uint32_t OUTPUT_BUFFER_SIZE = 4096;
+    bool usesOutput = false;
+    bool usesPrintNumber = false;
+    bool usesInput = false;
+    uint32_t outputCount = 0;   // bss offsets
+    uint32_t outputBuffer = 0;
+
+    void useOutput();
+    void emitRuntime();
+    void emitRuntimeWrite();        // .rt_write: RAX = bytes, RDX = length
+    void emitRuntimeFlush();        // .rt_flush
+    void emitRuntimeWriteAll();     // .rt_write_all: RSI = bytes, RDX = length; write(1) loop
+    void emitRuntimePrintNumber();  // .rt_print_i64: RAX = value, printed with a newline
+
+    // Input: stdin read through its own bss buffer
+    static constexpr uint32_t INPUT_BUFFER_SIZE = 4096;
+    uint32_t inputPosition = 0;     // bss offsets
+    uint32_t inputLength = 0;
+    uint32_t inputBuffer = 0;
+    void useInput();
+    void emitRuntimeReadByte();     // .rt_read_byte: RAX = next byte, -1 at end of input
+    void emitRuntimeReadNumber();   // .rt_read_i64: flushes output, RAX = integer read like cin >>
 };
 
 #endif // MACHINE_CODE_EMITTER_HPP
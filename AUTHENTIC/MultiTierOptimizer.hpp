@@ -6,6 +6,8 @@
 #pragma once
 
 #include "HexIR.hpp"
+#include "RuntimeHardware.hpp"
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -367,9 +369,35 @@ public:
     // Tune vectorization width
     static int suggestVectorWidth(const HardwareInfo& hw, HexIR::IRType elementType);
     
-    // Tune cache blocking
+    // Tune cache blocking: {row/column tile, depth tile} in 8-byte elements
     static std::pair<int, int> suggestCacheBlocking(const HardwareInfo& hw,
          int matrixSize);
 };
 
+// The runtime's detection (RuntimeHardware.hpp), in the tuner's types
+inline AdaptiveTuner::HardwareInfo AdaptiveTuner::detectHardware() {
+    CaseRuntime::HardwareInfo detected = CaseRuntime::detectHardware();
+    HardwareInfo hw;
+    hw.coreCount = detected.coreCount;
+    hw.threadCount = detected.threadCount;
+    hw.l1CacheSize = detected.l1CacheSize;
+    hw.l2CacheSize = detected.l2CacheSize;
+    hw.l3CacheSize = detected.l3CacheSize;
+    hw.hasSSE = detected.hasSSE;
+    hw.hasAVX = detected.hasAVX;
+    hw.hasAVX2 = detected.hasAVX2;
+    hw.hasAVX512 = detected.hasAVX512;
+    hw.vectorWidth = detected.vectorWidth;
+    return hw;
+}
+
+inline std::pair<int, int> AdaptiveTuner::suggestCacheBlocking(const HardwareInfo& hw,
+                                                              int matrixSize) {
+    CaseRuntime::HardwareInfo caches;
+    caches.l1CacheSize = hw.l1CacheSize;
+    caches.l2CacheSize = hw.l2CacheSize;
+    caches.l3CacheSize = hw.l3CacheSize;
+    return CaseRuntime::suggestCacheBlocking(caches, matrixSize);
+}
+
 } // namespace Optimization
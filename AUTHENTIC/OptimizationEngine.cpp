@@ -37,6 +37,9 @@ collectUsedSymbols(arg);
      collectUsedSymbols(bin->left);
         collectUsedSymbols(bin->right);
     }
+    else if (auto unary = std::dynamic_pointer_cast<UnaryExpr>(node)) {
+        collectUsedSymbols(unary->operand);
+    }
     // Recursively collect from all node types
 }
 
@@ -3,6 +3,7 @@
 //=============================================================================
 
 #include "Parser.hpp"
+#include <cctype>
 #include <memory>
 #include <unordered_set>
 #include <sstream>
@@ -12,13 +13,15 @@ Parser::Parser(const std::vector<Token>& t) : tokens(t), pos(0) {}
 const Token& Parser::peek() const { return tokens[pos]; }
 const Token& Parser::advance() { return tokens[pos++]; }
 
+// String literals carry their text without quotes, so a literal "," or "["
+// must never be taken for the punctuation or keyword it spells
 bool Parser::match(const std::string& kw) {
-    if (peek().lexeme == kw) { advance(); return true; }
+    if (check(kw)) { advance(); return true; }
     return false;
 }
 
 bool Parser::check(const std::string& kw) const {
-    return peek().lexeme == kw;
+    return peek().type != TokenType::String && peek().lexeme == kw;
 }
 
 bool Parser::isAtEnd() const { 
@@ -73,9 +76,16 @@ std::string Parser::tokenTypeToString(TokenType t) {
 }
 
 int Parser::precedenceOf(const std::string& op) {
-    if (op == "*" || op == "/") return 20;
+    // C's order: bitwise operators bind looser than comparisons
+    if (op == "*" || op == "/" || op == "%") return 20;
     if (op == "+" || op == "-") return 10;
-    if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") return 5;
+    if (op == "<<" || op == ">>") return 8;
+    if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") return 6;
+    if (op == "&") return 5;
+    if (op == "^") return 4;
+    if (op == "|") return 3;
+    if (op == "&&") return 2;
+    if (op == "||") return 1;
     return -1;
 }
 
@@ -89,6 +99,14 @@ NodePtr Parser::parse() {
 }
 
 NodePtr Parser::parseStatement() {
+    // Where the statement starts, for diagnostics and the AOT listing
+    int line = peek().line, column = peek().column;
+    NodePtr stmt = parseStatementNode();
+    if (stmt && stmt->line == 0) stmt->setLocation(line, column);
+    return stmt;
+}
+
+NodePtr Parser::parseStatementNode() {
     if (match("Fn")) {
         auto fnDecl = std::make_shared<FunctionDecl>();
         if (peek().type == TokenType::Identifier) {
@@ -96,6 +114,17 @@ NodePtr Parser::parseStatement() {
         }
         if (peek().type == TokenType::String) {
             fnDecl->params = advance().lexeme;
+            // "a, b" or "a b"
+            std::string current;
+            for (char c : fnDecl->params) {
+                if (c == ',' || std::isspace(static_cast<unsigned char>(c))) {
+                    if (!current.empty()) fnDecl->paramNames.push_back(current);
+                    current.clear();
+                } else {
+                    current += c;
+                }
+            }
+            if (!current.empty()) fnDecl->paramNames.push_back(current);
         }
         if (match("(")) {
             auto body = std::make_shared<Block>();
@@ -147,6 +176,7 @@ NodePtr Parser::parseStatement() {
             varDecl->initializer = parseExpression();
         }
         varDecl->type = "auto";
+        if (check("[")) matchEnd();
         return varDecl;
     }
 
@@ -155,6 +185,7 @@ NodePtr Parser::parseStatement() {
         if (!check("[") && !isAtEnd()) {
             retStmt->value = parseExpression();
         }
+        if (check("[")) matchEnd();
         return retStmt;
     }
 
@@ -195,6 +226,7 @@ NodePtr Parser::parseStatement() {
     if (match("write")) return parseWrite();
     if (match("writeln")) return parseWriteln();
     if (match("read")) return parseRead();
+    if (match("flush")) return parseFlush();
     if (match("close")) return parseClose();
     if (match("input")) return parseInput();
     if (match("serialize")) return parseSerialize();
@@ -249,7 +281,17 @@ NodePtr Parser::parseStatement() {
     if (match("sendnet")) return parseSendNet();
     if (match("receive")) return parseReceive();
 
-    return parseExpression();
+    size_t start = pos;
+    NodePtr expr = parseExpression();
+    if (pos == start) {
+        // Nothing could be parsed here; skip the token instead of looping on it
+        reportError("Unexpected token");
+        advance();
+        return nullptr;
+    }
+    // Expression used as a statement: sort nums [end]
+    if (check("[")) matchEnd();
+    return expr;
 }
 
 NodePtr Parser::parseBlock() {
@@ -264,16 +306,48 @@ NodePtr Parser::parseBlock() {
 }
 
 NodePtr Parser::parseExpression() {
+    int line = peek().line, column = peek().column;
     NodePtr lhs = parsePrimary();
-    return parseBinOpRHS(0, lhs);
+    NodePtr expr = parseBinOpRHS(0, lhs);
+    if (expr && expr->line == 0) expr->setLocation(line, column);
+    return expr;
+}
+
+// The lexer strips quotes and escapes; Literal keeps string values as C++
+// source text, quotes included
+static std::string quoteStringLiteral(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:   out += c; break;
+        }
+    }
+    return out + "\"";
 }
 
 NodePtr Parser::parsePrimary() {
-    if (peek().type == TokenType::String || peek().type == TokenType::Number) {
+    if (peek().type == TokenType::String) {
+        auto lit = std::make_shared<Literal>();
+        lit->value = quoteStringLiteral(advance().lexeme);
+        return lit;
+    }
+    if (peek().type == TokenType::Number) {
         auto lit = std::make_shared<Literal>();
         lit->value = advance().lexeme;
         return lit;
     }
+    if (peek().type == TokenType::Operator &&
+        (peek().lexeme == "-" || peek().lexeme == "!" || peek().lexeme == "~")) {
+        auto unary = std::make_shared<UnaryExpr>();
+        unary->op = advance().lexeme;
+        unary->operand = parsePrimary();
+        return unary;
+    }
     
     // Check for standard library functions
     const std::unordered_set<std::string> mathFuncs = {
@@ -288,7 +362,13 @@ NodePtr Parser::parsePrimary() {
     
     if (peek().type == TokenType::Keyword) {
         std::string kw = peek().lexeme;
-        
+
+        if (kw == "true" || kw == "false") {
+            auto lit = std::make_shared<Literal>();
+            lit->value = advance().lexeme;
+            return lit;
+        }
+
         // Math functions
         if (mathFuncs.count(kw)) {
             advance();
@@ -308,11 +388,13 @@ NodePtr Parser::parsePrimary() {
             advance();
             auto strCall = std::make_shared<StringCallExpr>();
             strCall->function = kw;
-            // Parse arguments
-            while (!check("[") && !isAtEnd() && peek().type != TokenType::EndOfFile) {
+            // Arguments follow separated by spaces or commas: substr text 0 5
+            while (!check("[") && !isAtEnd()) {
+                TokenType t = peek().type;
+                if (t != TokenType::Identifier && t != TokenType::Number && t != TokenType::String &&
+                    !check("(")) break;
                 strCall->args.push_back(parsePrimary());
                 if (check(",")) advance();
-                else break;
             }
             return strCall;
         }
@@ -326,10 +408,13 @@ NodePtr Parser::parsePrimary() {
             if (!check("[") && !isAtEnd()) {
                 collCall->collection = parsePrimary();
             }
-            // Additional arguments
-            while (!check("[") && !isAtEnd() && peek().type != TokenType::EndOfFile) {
+            // Additional arguments, separated by spaces or commas:
+            // map xs (* 2), reduce xs (+) 0
+            while (!check("[") && !isAtEnd()) {
                 if (check(",")) advance();
-                else break;
+                TokenType t = peek().type;
+                if (t != TokenType::Identifier && t != TokenType::Number && t != TokenType::String &&
+                    !check("(")) break;
                 collCall->args.push_back(parsePrimary());
             }
             return collCall;
@@ -341,7 +426,53 @@ NodePtr Parser::parsePrimary() {
         id->name = advance().lexeme;
         return id;
     }
+    // List literal; `[end]` is the statement terminator, never a list
+    if (check("[") && pos + 1 < tokens.size() &&
+        (tokens[pos + 1].type == TokenType::String || tokens[pos + 1].lexeme != "end")) {
+        advance();
+        auto list = std::make_shared<ListExpr>();
+        while (!check("]") && !isAtEnd()) {
+            size_t start = pos;
+            list->elements.push_back(parseExpression());
+            if (check(",")) advance();
+            else if (pos == start) break;
+        }
+        match("]");
+        return list;
+    }
+    // Call used as a value: let x = call f a b [end]
+    if (match("call")) {
+        auto callExpr = std::make_shared<CallExpr>();
+        if (peek().type == TokenType::Identifier) {
+            callExpr->callee = advance().lexeme;
+        }
+        while (!check("[") && !check(")") && !isAtEnd()) {
+            size_t start = pos;
+            callExpr->args.push_back(parseExpression());
+            if (check(",")) advance();
+            else if (pos == start) break;
+        }
+        return callExpr;
+    }
     if (match("(")) {
+        // Operator section: the left operand (and in `(op)` the right one
+        // too) is left open for the collection function to fill in
+        if (peek().type == TokenType::Operator && precedenceOf(peek().lexeme) >= 0) {
+            auto hole = std::make_shared<PlaceholderExpr>();
+            if (tokens[pos + 1].type != TokenType::String && tokens[pos + 1].lexeme == ")") {
+                auto bin = std::make_shared<BinaryExpr>();
+                bin->op = advance().lexeme;
+                bin->left = hole;
+                auto right = std::make_shared<PlaceholderExpr>();
+                right->slot = 1;
+                bin->right = right;
+                match(")");
+                return bin;
+            }
+            NodePtr section = parseBinOpRHS(0, hole);
+            match(")");
+            return section;
+        }
         NodePtr inner = parseExpression();
         match(")");
         return inner;
@@ -475,10 +606,23 @@ NodePtr Parser::parseStruct() {
     match("{");
     while (!check("}") && !isAtEnd()) {
         std::string type, name;
-        if (peek().type == TokenType::Identifier) type = advance().lexeme;
+        // Builtin field types (int, string, ...) are keywords
+        if (peek().type == TokenType::Identifier || peek().type == TokenType::Keyword) {
+            type = advance().lexeme;
+        }
+        // Fixed-size array field: type[N] name
+        if (!type.empty() && check("[") && pos + 2 < tokens.size()
+            && tokens[pos + 1].type == TokenType::Number && tokens[pos + 2].type != TokenType::String && tokens[pos + 2].lexeme == "]") {
+            advance();
+            type += "[" + advance().lexeme + "]";
+            advance();
+        }
         if (peek().type == TokenType::Identifier) name = advance().lexeme;
         if (!type.empty() && !name.empty()) {
             decl->fields.push_back({type, name});
+        } else if (type.empty() && name.empty()) {
+            reportError("Expected field declaration in struct", "Fields are written as: type name");
+            advance();
         }
     }
     match("}");
@@ -496,6 +640,9 @@ NodePtr Parser::parseEnum() {
     while (!check("}") && !isAtEnd()) {
         if (peek().type == TokenType::Identifier) {
             decl->values.push_back(advance().lexeme);
+        } else if (!check(",")) {
+            reportError("Expected enum value name");
+            advance();
         }
         if (check(",")) advance();
     }
@@ -513,10 +660,15 @@ NodePtr Parser::parseUnion() {
     match("{");
     while (!check("}") && !isAtEnd()) {
         std::string type, name;
-        if (peek().type == TokenType::Identifier) type = advance().lexeme;
+        if (peek().type == TokenType::Identifier || peek().type == TokenType::Keyword) {
+            type = advance().lexeme;
+        }
         if (peek().type == TokenType::Identifier) name = advance().lexeme;
         if (!type.empty() && !name.empty()) {
             decl->fields.push_back({type, name});
+        } else if (type.empty() && name.empty()) {
+            reportError("Expected field declaration in union", "Fields are written as: type name");
+            advance();
         }
     }
     match("}");
@@ -526,7 +678,7 @@ NodePtr Parser::parseUnion() {
 
 NodePtr Parser::parseTypedef() {
     auto stmt = std::make_shared<TypedefStmt>();
-    if (peek().type == TokenType::Identifier) {
+    if (peek().type == TokenType::Identifier || peek().type == TokenType::Keyword) {
         stmt->existingType = advance().lexeme;
     }
     if (peek().type == TokenType::Identifier) {
@@ -586,6 +738,15 @@ NodePtr Parser::parseRead() {
     return stmt;
 }
 
+NodePtr Parser::parseFlush() {
+    auto stmt = std::make_shared<FlushStmt>();
+    if (peek().type == TokenType::Identifier) {
+        stmt->handle = advance().lexeme;
+    }
+    matchEnd();
+    return stmt;
+}
+
 NodePtr Parser::parseClose() {
     auto stmt = std::make_shared<CloseStmt>();
     if (peek().type == TokenType::Identifier) {
@@ -614,6 +775,9 @@ NodePtr Parser::parseSerialize() {
         stmt->format = advance().lexeme;
     }
     stmt->data = parseExpression();
+    if (peek().type == TokenType::Identifier) {
+        stmt->target = advance().lexeme;
+    }
     matchEnd();
     return stmt;
 }
@@ -625,28 +789,40 @@ NodePtr Parser::parseDeserialize() {
         stmt->format = advance().lexeme;
     }
     stmt->source = parseExpression();
+    if (peek().type == TokenType::Identifier) {
+        stmt->targetType = advance().lexeme;
+    }
+    if (peek().type == TokenType::Identifier) {
+        stmt->target = advance().lexeme;
+    }
     matchEnd();
     return stmt;
 }
 
 NodePtr Parser::parseCompress() {
     auto stmt = std::make_shared<CompressStmt>();
-    stmt->algorithm = "zlib";
+    stmt->algorithm = "lz4";
     if (peek().type == TokenType::String) {
         stmt->algorithm = advance().lexeme;
     }
     stmt->data = parseExpression();
+    if (peek().type == TokenType::Identifier) {
+        stmt->target = advance().lexeme;
+    }
     matchEnd();
     return stmt;
 }
 
 NodePtr Parser::parseDecompress() {
     auto stmt = std::make_shared<DecompressStmt>();
-    stmt->algorithm = "zlib";
+    stmt->algorithm = "lz4";
     if (peek().type == TokenType::String) {
         stmt->algorithm = advance().lexeme;
     }
     stmt->data = parseExpression();
+    if (peek().type == TokenType::Identifier) {
+        stmt->target = advance().lexeme;
+    }
     matchEnd();
     return stmt;
 }
@@ -738,6 +914,11 @@ NodePtr Parser::parseMatrix() {
     if (peek().type == TokenType::Number) {
         stmt->cols = std::stoi(advance().lexeme);
     }
+    // Optional initial values: one fills the matrix, otherwise row-major
+    while (!check("[") && !isAtEnd()) {
+        stmt->elements.push_back(parseExpression());
+        if (!match(",")) break;
+    }
     matchEnd();
     return stmt;
 }
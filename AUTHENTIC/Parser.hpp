@@ -41,7 +41,8 @@ private:
     std::string tokenTypeToString(TokenType t);
 
     // Parsing methods
-    NodePtr parseStatement();
+    NodePtr parseStatement();      // parseStatementNode() with its source location
+    NodePtr parseStatementNode();
     NodePtr parseBlock();
     NodePtr parseExpression();
     NodePtr parsePrimary();
@@ -70,6 +71,7 @@ private:
     NodePtr parseWrite();
     NodePtr parseWriteln();
     NodePtr parseRead();
+    NodePtr parseFlush();
     NodePtr parseClose();
     NodePtr parseInput();
     NodePtr parseSerialize();
@@ -0,0 +1,334 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Process Runner Implementation
+//=============================================================================
+
+#include "ProcessRunner.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::vector<char*> argvOf(const CommandLine& command) {
+    std::vector<char*> argv;
+    for (auto& arg : command) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    return argv;
+}
+
+#ifdef _WIN32
+
+// No pipes or rusage here: children share the console and only the exit
+// code and wall time are reported
+struct Child {
+    size_t index;
+    intptr_t handle;
+    Clock::time_point start;
+};
+
+bool spawn(const CommandLine& command, bool, Child& child) {
+    if (command.empty()) return false;
+    std::vector<char*> argv = argvOf(command);
+    child.handle = _spawnvp(_P_NOWAIT, argv[0], argv.data());
+    return child.handle != -1;
+}
+
+void reap(Child& child, ProcessResult& result) {
+    int status = 0;
+    result.exitCode = (_cwait(&status, child.handle, 0) == -1) ? -1 : status;
+    result.wallSeconds = secondsSince(child.start);
+}
+
+#else
+
+struct Child {
+    size_t index;
+    pid_t pid;
+    // Read ends of the stdout / stderr pipes, -1 once drained (or not captured)
+    int out = -1;
+    int err = -1;
+    Clock::time_point start;
+};
+
+bool openPipe(int fds[2]) {
+    if (pipe(fds) != 0) return false;
+    // Close-on-exec, so no sibling started later holds the write end open;
+    // the dup2 onto fd 1/2 in the child clears it again
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+bool spawn(const CommandLine& command, bool capture, Child& child) {
+    if (command.empty()) return false;
+    std::vector<char*> argv = argvOf(command);
+    int outPipe[2] = {-1, -1}, errPipe[2] = {-1, -1};
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (capture) {
+        if (!openPipe(outPipe)) return false;
+        if (!openPipe(errPipe)) {
+            close(outPipe[0]);
+            close(outPipe[1]);
+            return false;
+        }
+        posix_spawn_file_actions_adddup2(&actions, outPipe[1], 1);
+        posix_spawn_file_actions_adddup2(&actions, errPipe[1], 2);
+    }
+    bool started = posix_spawnp(&child.pid, argv[0], &actions, nullptr, argv.data(), environ) == 0;
+    posix_spawn_file_actions_destroy(&actions);
+    if (capture) {
+        close(outPipe[1]);
+        close(errPipe[1]);
+        if (started) {
+            child.out = outPipe[0];
+            child.err = errPipe[0];
+        } else {
+            close(outPipe[0]);
+            close(errPipe[0]);
+        }
+    }
+    return started;
+}
+
+// Reads what is available on `fd`; closes it and sets it to -1 at end of stream
+void drain(int& fd, std::string& into) {
+    char buffer[1 << 14];
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n > 0) {
+        into.append(buffer, static_cast<size_t>(n));
+    } else if (n == 0 || errno != EINTR) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void record(int status, const struct rusage& usage, const Child& child, ProcessResult& result) {
+    result.wallSeconds = secondsSince(child.start);
+    if (WIFEXITED(status)) {
+        result.exitCode = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result.signal = WTERMSIG(status);
+        result.exitCode = 128 + result.signal;
+    }
+    result.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    result.systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#ifdef __APPLE__
+    result.maxResidentKb = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    result.maxResidentKb = usage.ru_maxrss;
+#endif
+}
+
+void reap(Child& child, ProcessResult& result) {
+    int status = 0;
+    struct rusage usage {};
+    while (wait4(child.pid, &status, 0, &usage) < 0) {
+        if (errno != EINTR) return;
+    }
+    record(status, usage, child, result);
+}
+
+// fork + exec rather than posix_spawn: the limits have to be set in the
+// child before it runs, and the hard limits lowered so it cannot raise them
+bool spawnLimited(const CommandLine& command, const ProcessLimits& limits, Child& child) {
+    if (command.empty()) return false;
+    std::vector<char*> argv = argvOf(command);
+    // Reports a failed exec: closed unread on success thanks to close-on-exec
+    int status[2];
+    if (!openPipe(status)) return false;
+    child.pid = fork();
+    if (child.pid < 0) {
+        close(status[0]);
+        close(status[1]);
+        return false;
+    }
+    if (child.pid == 0) {
+        close(status[0]);
+        struct rlimit limit;
+        if (limits.cpuSeconds > 0) {
+            limit.rlim_cur = static_cast<rlim_t>(limits.cpuSeconds);
+            limit.rlim_max = static_cast<rlim_t>(limits.cpuSeconds + 1);
+            setrlimit(RLIMIT_CPU, &limit);
+        }
+        if (limits.memoryMb > 0) {
+            limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(limits.memoryMb) << 20;
+            setrlimit(RLIMIT_AS, &limit);
+        }
+        limit.rlim_cur = limit.rlim_max = 0;
+        setrlimit(RLIMIT_CORE, &limit);
+        execvp(argv[0], argv.data());
+        int error = errno;
+        ssize_t ignored = write(status[1], &error, sizeof(error));
+        (void)ignored;
+        _exit(127);
+    }
+    close(status[1]);
+    int error = 0;
+    ssize_t n;
+    while ((n = read(status[0], &error, sizeof(error))) < 0 && errno == EINTR) {
+    }
+    close(status[0]);
+    if (n > 0) {
+        int ignored;
+        waitpid(child.pid, &ignored, 0);
+        return false;
+    }
+    return true;
+}
+
+// Waits for the child, killing it once it is past the wall-clock deadline
+void reapLimited(Child& child, const ProcessLimits& limits, ProcessResult& result) {
+    if (limits.wallSeconds <= 0) {
+        reap(child, result);
+        return;
+    }
+    int status = 0;
+    struct rusage usage {};
+    for (;;) {
+        pid_t done = wait4(child.pid, &status, WNOHANG, &usage);
+        if (done == child.pid) break;
+        if (done < 0 && errno != EINTR) return;
+        if (!result.timedOut && secondsSince(child.start) > limits.wallSeconds) {
+            kill(child.pid, SIGKILL);
+            result.timedOut = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    record(status, usage, child, result);
+}
+
+#endif
+
+std::vector<ProcessResult> run(const std::vector<CommandLine>& commands, size_t jobs, bool capture) {
+    std::vector<ProcessResult> results(commands.size());
+    std::vector<Child> running;
+    if (jobs == 0) jobs = 1;
+
+    size_t next = 0;
+    while (next < commands.size() || !running.empty()) {
+        while (next < commands.size() && running.size() < jobs) {
+            Child child{};
+            child.index = next;
+            child.start = Clock::now();
+            if (spawn(commands[next], capture, child)) {
+                results[next].started = true;
+                running.push_back(child);
+            }
+            ++next;
+        }
+        if (running.empty()) continue;
+
+#ifdef _WIN32
+        // No way to wait for "any" child here; take the oldest
+        reap(running.front(), results[running.front().index]);
+        running.erase(running.begin());
+#else
+        // Collect output from every child until one has closed both streams,
+        // then reap those; a child that is not captured is reaped directly
+        std::vector<pollfd> fds;
+        for (auto& child : running) {
+            if (child.out >= 0) fds.push_back({child.out, POLLIN, 0});
+            if (child.err >= 0) fds.push_back({child.err, POLLIN, 0});
+        }
+        if (!fds.empty() && poll(fds.data(), fds.size(), -1) > 0) {
+            for (auto& child : running) {
+                for (auto& p : fds) {
+                    if (!(p.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                    if (p.fd == child.out) drain(child.out, results[child.index].output);
+                    else if (p.fd == child.err) drain(child.err, results[child.index].errors);
+                }
+            }
+        }
+        for (size_t i = 0; i < running.size();) {
+            if (running[i].out < 0 && running[i].err < 0) {
+                reap(running[i], results[running[i].index]);
+                running.erase(running.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+#endif
+    }
+    return results;
+}
+
+} // namespace
+
+void appendFlags(CommandLine& command, const std::string& flags) {
+    std::istringstream in(flags);
+    std::string flag;
+    while (in >> flag) command.push_back(flag);
+}
+
+std::string formatCommand(const CommandLine& command) {
+    std::string text;
+    for (auto& arg : command) {
+        if (!text.empty()) text += ' ';
+        text += arg;
+    }
+    return text;
+}
+
+ProcessResult runProcess(const CommandLine& command, bool captureOutput) {
+    return run({command}, 1, captureOutput).front();
+}
+
+ProcessResult runLimited(const CommandLine& command, const ProcessLimits& limits) {
+#ifdef _WIN32
+    return runProcess(command, false);
+#else
+    if (!limits.any()) return runProcess(command, false);
+    ProcessResult result;
+    Child child{};
+    child.start = Clock::now();
+    if (!spawnLimited(command, limits, child)) return result;
+    result.started = true;
+    reapLimited(child, limits, result);
+    return result;
+#endif
+}
+
+std::vector<ProcessResult> runProcesses(const std::vector<CommandLine>& commands, size_t jobs) {
+    return run(commands, jobs, true);
+}
+
+std::string describeRun(const ProcessResult& result) {
+    if (!result.started) return "could not be started";
+    char text[160];
+    std::snprintf(text, sizeof(text), "wall %.2f s, cpu %.2f s, peak %.1f MB%s", result.wallSeconds,
+                  result.cpuSeconds(), result.maxResidentKb / 1024.0,
+                  result.timedOut ? ", killed at the wall-clock limit" : "");
+    return text;
+}
+
+size_t defaultJobCount() {
+    if (const char* env = std::getenv("CASE_JOBS")) {
+        long n = std::strtol(env, nullptr, 10);
+        if (n > 0) return static_cast<size_t>(n);
+    }
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
@@ -0,0 +1,70 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Process Runner
+//  Starts compilers and compiled programs directly (posix_spawn, _spawnvp
+//  on Windows) instead of through a shell. A run reports its exit status,
+//  what it wrote to stdout and stderr, and the wall time, CPU time and peak
+//  memory wait4() gives back; batches run with a limit on how many
+//  processes are alive at once. A program that is not trusted runs under
+//  ProcessLimits: CPU and address-space rlimits and a wall-clock deadline.
+//=============================================================================
+
+#pragma once
+#include <string>
+#include <vector>
+
+using CommandLine = std::vector<std::string>;
+
+// Zero means unlimited. Enforced on POSIX only.
+struct ProcessLimits {
+    double wallSeconds = 0.0;  // killed with SIGKILL when exceeded
+    long cpuSeconds = 0;       // RLIMIT_CPU: SIGXCPU, then SIGKILL
+    long memoryMb = 0;         // RLIMIT_AS: allocations beyond it fail
+
+    bool any() const { return wallSeconds > 0 || cpuSeconds > 0 || memoryMb > 0; }
+};
+
+struct ProcessResult {
+    // False when the program could not be started at all
+    bool started = false;
+    int exitCode = -1;
+    // Signal that ended the process, 0 when it exited
+    int signal = 0;
+    // Killed for running past ProcessLimits::wallSeconds
+    bool timedOut = false;
+    // Captured streams; empty when the child wrote to the terminal
+    std::string output;
+    std::string errors;
+    double wallSeconds = 0.0;
+    double userSeconds = 0.0;
+    double systemSeconds = 0.0;
+    long maxResidentKb = 0;
+
+    bool ok() const { return started && signal == 0 && exitCode == 0; }
+    double cpuSeconds() const { return userSeconds + systemSeconds; }
+};
+
+// Splits a flag string ("-O2 -pthread") into arguments at whitespace
+void appendFlags(CommandLine& command, const std::string& flags);
+
+// For logs: the arguments joined with spaces
+std::string formatCommand(const CommandLine& command);
+
+// Runs one command (argv[0] looked up in PATH) and waits for it. With
+// captureOutput the child's stdout and stderr are collected into the
+// result; without it the child shares the terminal, as a program run
+// interactively must.
+ProcessResult runProcess(const CommandLine& command, bool captureOutput = true);
+
+// Runs a program on the terminal under `limits`
+ProcessResult runLimited(const CommandLine& command, const ProcessLimits& limits);
+
+// Runs every command with at most `jobs` of them alive at a time, capturing
+// their output; results are in command order
+std::vector<ProcessResult> runProcesses(const std::vector<CommandLine>& commands, size_t jobs);
+
+// "wall 1.20 s, cpu 1.18 s, peak 85.3 MB" (or why it did not run)
+std::string describeRun(const ProcessResult& result);
+
+// Processors available to child jobs: CASE_JOBS if set, otherwise the
+// hardware thread count
+size_t defaultJobCount();
@@ -0,0 +1,763 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Collections
+//  The coll_* functions the collection keywords lower to.
+//
+//  map, filter and slice return lazy views instead of vectors. A view holds
+//  its source (by reference when the source is a named collection, by value
+//  when it is a temporary or another view) and pushes elements through its
+//  function when something consumes it. So
+//      reduce (filter (map xs (* 2)) (> 10)) (+) 0
+//  runs as one loop over xs with no intermediate storage. `let` turns a view
+//  into a std::vector with coll_collect; a long map over an array is filled
+//  in parallel there.
+//
+//  sort is in place: pattern-defeating quicksort (branchless block
+//  partitioning for numbers, heapsort fallback), LSD radix sort for integer
+//  keys in default order, and above PARALLEL_SORT_ELEMENTS the range is cut
+//  into one chunk per pool thread, sorted in parallel and merged pairwise.
+//=============================================================================
+
+#pragma once
+#include "RuntimeParallel.hpp"
+#include "RuntimeSimd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace CaseRuntime {
+namespace SortKernels {
+
+constexpr ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+constexpr ptrdiff_t NINTHER_THRESHOLD = 128;
+constexpr size_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+constexpr size_t PARTITION_BLOCK = 64;
+constexpr size_t RADIX_SORT_THRESHOLD = 512;
+constexpr size_t PARALLEL_SORT_ELEMENTS = size_t(1) << 16;
+
+// --- Insertion sorts -----------------------------------------------------------
+
+template <typename Iter, typename Compare>
+inline void insertionSort(Iter begin, Iter end, Compare& comp) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    if (begin == end) return;
+    for (Iter cur = begin + 1; cur != end; ++cur) {
+        Iter sift = cur, prev = cur - 1;
+        if (comp(*sift, *prev)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*prev);
+            } while (sift != begin && comp(tmp, *--prev));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// For ranges with an element to their left that is <= everything in them
+template <typename Iter, typename Compare>
+inline void unguardedInsertionSort(Iter begin, Iter end, Compare& comp) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    if (begin == end) return;
+    for (Iter cur = begin + 1; cur != end; ++cur) {
+        Iter sift = cur, prev = cur - 1;
+        if (comp(*sift, *prev)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*prev);
+            } while (comp(tmp, *--prev));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// Gives up (returns false) once more than a few elements had to move
+template <typename Iter, typename Compare>
+inline bool partialInsertionSort(Iter begin, Iter end, Compare& comp) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    if (begin == end) return true;
+    size_t moved = 0;
+    for (Iter cur = begin + 1; cur != end; ++cur) {
+        Iter sift = cur, prev = cur - 1;
+        if (comp(*sift, *prev)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*prev);
+            } while (sift != begin && comp(tmp, *--prev));
+            *sift = std::move(tmp);
+            moved += static_cast<size_t>(cur - sift);
+        }
+        if (moved > PARTIAL_INSERTION_SORT_LIMIT) return false;
+    }
+    return true;
+}
+
+template <typename Iter, typename Compare>
+inline void sort2(Iter a, Iter b, Compare& comp) {
+    if (comp(*b, *a)) std::iter_swap(a, b);
+}
+
+template <typename Iter, typename Compare>
+inline void sort3(Iter a, Iter b, Iter c, Compare& comp) {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// --- Partitioning ----------------------------------------------------------------
+
+// Pivot is *begin. Elements equal to the pivot go right. Returns the pivot's
+// final position and whether the range was already partitioned.
+template <typename Iter, typename Compare>
+inline std::pair<Iter, bool> partitionRight(Iter begin, Iter end, Compare& comp) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    T pivot(std::move(*begin));
+    Iter first = begin, last = end;
+
+    // The median-of-3 guarantees an element >= pivot to stop the first scan
+    while (comp(*++first, pivot)) {}
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivot)) {}
+    } else {
+        while (!comp(*--last, pivot)) {}
+    }
+
+    bool alreadyPartitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*++first, pivot)) {}
+        while (!comp(*--last, pivot)) {}
+    }
+
+    Iter pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, alreadyPartitioned};
+}
+
+template <typename Iter>
+inline void swapOffsets(Iter first, Iter last, const unsigned char* offsetsL, const unsigned char* offsetsR,
+                        size_t num, bool useSwaps) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    if (useSwaps) {
+        // Equal counts: the two position sets can meet in the middle, where
+        // only plain swaps stay correct
+        for (size_t i = 0; i < num; ++i) std::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+    } else if (num > 0) {
+        Iter l = first + offsetsL[0], r = last - offsetsR[0];
+        T tmp(std::move(*l));
+        *l = std::move(*r);
+        for (size_t i = 1; i < num; ++i) {
+            l = first + offsetsL[i];
+            *r = std::move(*l);
+            r = last - offsetsR[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
+    }
+}
+
+// partitionRight without data-dependent branches: both ends are scanned in
+// blocks, recording the offsets of misplaced elements, which are then swapped
+// in bulk. Worth it when comparisons are cheap (numbers).
+template <typename Iter, typename Compare>
+inline std::pair<Iter, bool> partitionRightBranchless(Iter begin, Iter end, Compare& comp) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    T pivot(std::move(*begin));
+    Iter first = begin, last = end;
+
+    while (comp(*++first, pivot)) {}
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivot)) {}
+    } else {
+        while (!comp(*--last, pivot)) {}
+    }
+
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+        std::iter_swap(first, last);
+        ++first;
+
+        alignas(64) unsigned char offsetsL[PARTITION_BLOCK];
+        alignas(64) unsigned char offsetsR[PARTITION_BLOCK];
+        Iter baseL = first, baseR = last;
+        size_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+        while (first < last) {
+            // Fill whichever offset buffers are empty, splitting what is left
+            size_t unknown = static_cast<size_t>(last - first);
+            size_t splitL = numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0;
+            size_t splitR = numR == 0 ? (unknown - splitL) : 0;
+
+            if (splitL >= PARTITION_BLOCK) {
+                for (size_t i = 0; i < PARTITION_BLOCK;) {
+                    for (int u = 0; u < 8; ++u) {
+                        offsetsL[numL] = static_cast<unsigned char>(i++);
+                        numL += !comp(*first, pivot);
+                        ++first;
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < splitL;) {
+                    offsetsL[numL] = static_cast<unsigned char>(i++);
+                    numL += !comp(*first, pivot);
+                    ++first;
+                }
+            }
+
+            if (splitR >= PARTITION_BLOCK) {
+                for (size_t i = 0; i < PARTITION_BLOCK;) {
+                    for (int u = 0; u < 8; ++u) {
+                        offsetsR[numR] = static_cast<unsigned char>(++i);
+                        numR += comp(*--last, pivot);
+                    }
+                }
+            } else {
+                for (size_t i = 0; i < splitR;) {
+                    offsetsR[numR] = static_cast<unsigned char>(++i);
+                    numR += comp(*--last, pivot);
+                }
+            }
+
+            size_t num = std::min(numL, numR);
+            swapOffsets(baseL, baseR, offsetsL + startL, offsetsR + startR, num, numL == numR);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+            if (numL == 0) {
+                startL = 0;
+                baseL = first;
+            }
+            if (numR == 0) {
+                startR = 0;
+                baseR = last;
+            }
+        }
+
+        // Leftover misplaced elements on one side go next to the boundary
+        if (numL) {
+            const unsigned char* offsets = offsetsL + startL;
+            while (numL--) std::iter_swap(baseL + offsets[numL], --last);
+            first = last;
+        }
+        if (numR) {
+            const unsigned char* offsets = offsetsR + startR;
+            while (numR--) {
+                std::iter_swap(baseR - offsets[numR], first);
+                ++first;
+            }
+        }
+    }
+
+    Iter pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, alreadyPartitioned};
+}
+
+// Elements equal to the pivot go left; used when the pivot equals the
+// element before the range, so the whole equal run is finished at once
+template <typename Iter, typename Compare>
+inline Iter partitionLeft(Iter begin, Iter end, Compare& comp) {
+    using T = typename std::iterator_traits<Iter>::value_type;
+    T pivot(std::move(*begin));
+    Iter first = begin, last = end;
+
+    while (comp(pivot, *--last)) {}
+    if (last + 1 == end) {
+        while (first < last && !comp(pivot, *++first)) {}
+    } else {
+        while (!comp(pivot, *++first)) {}
+    }
+
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(pivot, *--last)) {}
+        while (!comp(pivot, *++first)) {}
+    }
+
+    Iter pivotPos = last;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
+}
+
+// --- Pattern-defeating quicksort --------------------------------------------------
+
+template <bool Branchless, typename Iter, typename Compare>
+inline void pdqsortLoop(Iter begin, Iter end, Compare& comp, int badAllowed, bool leftmost) {
+    using Diff = typename std::iterator_traits<Iter>::difference_type;
+    for (;;) {
+        Diff size = end - begin;
+        if (size < INSERTION_SORT_THRESHOLD) {
+            if (leftmost) insertionSort(begin, end, comp);
+            else unguardedInsertionSort(begin, end, comp);
+            return;
+        }
+
+        // Median of 3, or pseudo-median of 9 (Tukey's ninther) on larger ranges
+        Diff half = size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(begin, begin + half, end - 1, comp);
+            sort3(begin + 1, begin + (half - 1), end - 2, comp);
+            sort3(begin + 2, begin + (half + 1), end - 3, comp);
+            sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+            std::iter_swap(begin, begin + half);
+        } else {
+            sort3(begin + half, begin, end - 1, comp);
+        }
+
+        // Pivot equal to the element before this range: everything equal to
+        // it belongs here and is already in place after a left partition
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = partitionLeft(begin, end, comp) + 1;
+            continue;
+        }
+
+        auto part = Branchless ? partitionRightBranchless(begin, end, comp) : partitionRight(begin, end, comp);
+        Iter pivotPos = part.first;
+        bool alreadyPartitioned = part.second;
+
+        Diff leftSize = pivotPos - begin;
+        Diff rightSize = end - (pivotPos + 1);
+        bool unbalanced = leftSize < size / 8 || rightSize < size / 8;
+
+        if (unbalanced) {
+            // Too many bad pivots: guarantee O(n log n) with heapsort
+            if (--badAllowed == 0) {
+                std::make_heap(begin, end, comp);
+                std::sort_heap(begin, end, comp);
+                return;
+            }
+            // Break up patterns that keep producing bad pivots
+            if (leftSize >= INSERTION_SORT_THRESHOLD) {
+                std::iter_swap(begin, begin + leftSize / 4);
+                std::iter_swap(pivotPos - 1, pivotPos - leftSize / 4);
+                if (leftSize > NINTHER_THRESHOLD) {
+                    std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+                    std::iter_swap(pivotPos - 2, pivotPos - (leftSize / 4 + 1));
+                    std::iter_swap(pivotPos - 3, pivotPos - (leftSize / 4 + 2));
+                }
+            }
+            if (rightSize >= INSERTION_SORT_THRESHOLD) {
+                std::iter_swap(pivotPos + 1, pivotPos + (1 + rightSize / 4));
+                std::iter_swap(end - 1, end - rightSize / 4);
+                if (rightSize > NINTHER_THRESHOLD) {
+                    std::iter_swap(pivotPos + 2, pivotPos + (2 + rightSize / 4));
+                    std::iter_swap(pivotPos + 3, pivotPos + (3 + rightSize / 4));
+                    std::iter_swap(end - 2, end - (1 + rightSize / 4));
+                    std::iter_swap(end - 3, end - (2 + rightSize / 4));
+                }
+            }
+        } else if (alreadyPartitioned && partialInsertionSort(begin, pivotPos, comp) &&
+                   partialInsertionSort(pivotPos + 1, end, comp)) {
+            // Balanced and nothing moved: probably sorted already
+            return;
+        }
+
+        // Recurse left, loop right
+        pdqsortLoop<Branchless>(begin, pivotPos, comp, badAllowed, leftmost);
+        begin = pivotPos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename Iter, typename Compare>
+inline void pdqsort(Iter begin, Iter end, Compare comp) {
+    if (end - begin < 2) return;
+    using T = typename std::iterator_traits<Iter>::value_type;
+    int logSize = 0;
+    for (auto n = end - begin; n > 1; n >>= 1) ++logSize;
+    pdqsortLoop<std::is_arithmetic<T>::value>(begin, end, comp, logSize, true);
+}
+
+// --- Radix sort -------------------------------------------------------------------
+
+template <typename T>
+constexpr bool radixSortable = std::is_integral<T>::value && !std::is_same<T, bool>::value;
+
+// LSD radix sort, one byte per pass; passes where every key has the same
+// byte are skipped. Signed keys are ordered by flipping the sign bit.
+template <typename T>
+inline void radixSort(T* data, size_t n) {
+    using U = std::make_unsigned_t<T>;
+    constexpr size_t BYTES = sizeof(T);
+    constexpr U FLIP = std::is_signed<T>::value ? static_cast<U>(U(1) << (BYTES * 8 - 1)) : U(0);
+
+    std::unique_ptr<size_t[]> counts(new size_t[BYTES * 256]());
+    for (size_t i = 0; i < n; ++i) {
+        U key = static_cast<U>(static_cast<U>(data[i]) ^ FLIP);
+        for (size_t b = 0; b < BYTES; ++b) ++counts[b * 256 + ((key >> (b * 8)) & 0xFF)];
+    }
+
+    std::unique_ptr<T[]> buffer(new T[n]);
+    T* src = data;
+    T* dst = buffer.get();
+    for (size_t b = 0; b < BYTES; ++b) {
+        size_t* count = &counts[b * 256];
+        U first = static_cast<U>(static_cast<U>(src[0]) ^ FLIP);
+        if (count[(first >> (b * 8)) & 0xFF] == n) continue;
+        size_t offset = 0;
+        for (size_t d = 0; d < 256; ++d) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            U key = static_cast<U>(static_cast<U>(src[i]) ^ FLIP);
+            dst[count[(key >> (b * 8)) & 0xFF]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != data) std::memcpy(data, src, n * sizeof(T));
+}
+
+// --- Contiguous range dispatch -------------------------------------------------------
+
+template <typename T, typename Compare>
+inline void sortChunk(T* data, size_t n, Compare comp) {
+    if constexpr (radixSortable<T> && std::is_same<Compare, std::less<>>::value) {
+        // Radix sort is blind to existing order; an already sorted run (the
+        // first inversion ends this scan on random data) stays O(n)
+        if (n >= RADIX_SORT_THRESHOLD) {
+            if (std::is_sorted(data, data + n)) return;
+            radixSort(data, n);
+            return;
+        }
+    }
+    pdqsort(data, data + n, comp);
+}
+
+// One chunk per pool thread sorted in parallel, then pairwise merge rounds
+// (each round's merges in parallel) through a scratch buffer
+template <typename T, typename Compare>
+inline void parallelSort(T* data, size_t n, Compare comp) {
+    ThreadPool& pool = ThreadPool::instance();
+    size_t chunks = pool.concurrency();
+    std::vector<size_t> bounds(chunks + 1);
+    for (size_t c = 0; c <= chunks; ++c) bounds[c] = n * c / chunks;
+    pool.run(chunks, [&](size_t c) { sortChunk(data + bounds[c], bounds[c + 1] - bounds[c], comp); });
+
+    std::vector<T> scratch(n);
+    T* src = data;
+    T* dst = scratch.data();
+    while (bounds.size() > 2) {
+        size_t runs = bounds.size() - 1;
+        std::vector<size_t> merged;
+        merged.reserve(runs / 2 + 2);
+        for (size_t r = 0; r < runs; r += 2) merged.push_back(bounds[r]);
+        merged.push_back(n);
+        pool.run((runs + 1) / 2, [&](size_t p) {
+            size_t lo = bounds[2 * p], mid = bounds[std::min(2 * p + 1, runs)], hi = bounds[std::min(2 * p + 2, runs)];
+            std::merge(std::make_move_iterator(src + lo), std::make_move_iterator(src + mid),
+                       std::make_move_iterator(src + mid), std::make_move_iterator(src + hi), dst + lo, comp);
+        });
+        bounds.swap(merged);
+        std::swap(src, dst);
+    }
+    if (src != data) {
+        parallelFor(0, n, PARALLEL_SORT_ELEMENTS, [&](size_t lo, size_t hi) {
+            std::move(src + lo, src + hi, data + lo);
+        });
+    }
+}
+
+template <typename T, typename Compare>
+inline void sortContiguous(T* data, size_t n, Compare comp) {
+    if constexpr (std::is_default_constructible<T>::value) {
+        if (n >= PARALLEL_SORT_ELEMENTS && ThreadPool::instance().concurrency() > 1) {
+            parallelSort(data, n, comp);
+            return;
+        }
+    }
+    sortChunk(data, n, comp);
+}
+
+} // namespace SortKernels
+
+// -----------------------------------------------------------------------------
+// Lazy views
+// -----------------------------------------------------------------------------
+
+namespace Collections {
+
+constexpr size_t PARALLEL_COLLECT_ELEMENTS = size_t(1) << 16;
+
+struct ViewTag {};
+
+template <typename T>
+constexpr bool isView = std::is_base_of<ViewTag, std::decay_t<T>>::value;
+
+// Named sources are held by reference, temporaries and views by value
+template <typename S>
+using Held = std::conditional_t<std::is_lvalue_reference<S>::value, S, std::decay_t<S>>;
+
+template <typename S, typename = void>
+struct ElementOf {
+    using type = std::decay_t<decltype(*std::begin(std::declval<S&>()))>;
+};
+template <typename S>
+struct ElementOf<S, std::enable_if_t<isView<S>>> {
+    using type = typename std::decay_t<S>::value_type;
+};
+
+template <typename S>
+using Element = typename ElementOf<std::remove_reference_t<S>>::type;
+
+// Push every element of a collection or view into sink
+template <typename Source, typename Sink>
+inline void each(const Source& source, Sink&& sink) {
+    if constexpr (isView<Source>) {
+        source.each(sink);
+    } else {
+        for (const auto& x : source) sink(x);
+    }
+}
+
+template <typename Source>
+inline size_t sizeOf(const Source& source) {
+    if constexpr (isView<Source>) return source.size();
+    else return static_cast<size_t>(std::distance(std::begin(source), std::end(source)));
+}
+
+template <typename Source>
+constexpr bool exactSize() {
+    if constexpr (isView<Source>) return std::decay_t<Source>::EXACT_SIZE;
+    else return true;
+}
+
+template <typename S, typename F>
+class MapView : public ViewTag {
+public:
+    using value_type = std::decay_t<std::invoke_result_t<const F&, const Element<S>&>>;
+    static constexpr bool EXACT_SIZE = exactSize<std::decay_t<S>>();
+    static constexpr bool CONTIGUOUS_SOURCE = !isView<S> && detail::IsContiguous<std::decay_t<S>>::value;
+
+    MapView(S&& source, F fn) : source(std::forward<S>(source)), fn(std::move(fn)) {}
+
+    template <typename Sink>
+    void each(Sink&& sink) const {
+        Collections::each(source, [&](const auto& x) { sink(fn(x)); });
+    }
+    size_t size() const { return sizeOf(source); }
+    const std::decay_t<S>& base() const { return source; }
+    const F& function() const { return fn; }
+
+private:
+    Held<S> source;
+    F fn;
+};
+
+template <typename V>
+struct IsMapOverArray : std::false_type {};
+template <typename S, typename F>
+struct IsMapOverArray<MapView<S, F>> : std::integral_constant<bool, MapView<S, F>::CONTIGUOUS_SOURCE> {};
+
+template <typename S, typename F>
+class FilterView : public ViewTag {
+public:
+    using value_type = Element<S>;
+    static constexpr bool EXACT_SIZE = false;
+
+    FilterView(S&& source, F pred) : source(std::forward<S>(source)), pred(std::move(pred)) {}
+
+    template <typename Sink>
+    void each(Sink&& sink) const {
+        Collections::each(source, [&](const auto& x) {
+            if (pred(x)) sink(x);
+        });
+    }
+    size_t size() const {
+        size_t n = 0;
+        each([&](const auto&) { ++n; });
+        return n;
+    }
+
+private:
+    Held<S> source;
+    F pred;
+};
+
+template <typename S>
+class SliceView : public ViewTag {
+public:
+    using value_type = Element<S>;
+    static constexpr bool EXACT_SIZE = exactSize<std::decay_t<S>>();
+
+    SliceView(S&& source, size_t start, size_t stop) : source(std::forward<S>(source)), start(start), stop(stop) {}
+
+    template <typename Sink>
+    void each(Sink&& sink) const {
+        size_t hi = std::min(stop, sizeOf(source));
+        if constexpr (detail::IsContiguous<std::decay_t<S>>::value && !isView<S>) {
+            auto* p = std::data(source);
+            for (size_t i = start; i < hi; ++i) sink(p[i]);
+        } else {
+            size_t i = 0;
+            Collections::each(source, [&](const auto& x) {
+                if (i >= start && i < hi) sink(x);
+                ++i;
+            });
+        }
+    }
+    size_t size() const {
+        size_t hi = std::min(stop, sizeOf(source));
+        return hi > start ? hi - start : 0;
+    }
+
+private:
+    Held<S> source;
+    size_t start, stop;
+};
+
+} // namespace Collections
+
+// -----------------------------------------------------------------------------
+// Operations used by generated code
+// -----------------------------------------------------------------------------
+
+// Materialize a view (what `let x = map ...` stores); anything else passes through
+template <typename S>
+inline auto coll_collect(S&& source) {
+    using Source = std::decay_t<S>;
+    if constexpr (Collections::isView<Source>) {
+        using T = typename Source::value_type;
+        std::vector<T> out;
+        if constexpr (Source::EXACT_SIZE) {
+            size_t n = source.size();
+            if constexpr (Collections::IsMapOverArray<Source>::value && std::is_default_constructible<T>::value) {
+                if (n >= Collections::PARALLEL_COLLECT_ELEMENTS) {
+                    // Each index is independent: fill slices of the result in parallel
+                    out.resize(n);
+                    const auto* in = std::data(source.base());
+                    const auto& fn = source.function();
+                    parallelFor(0, n, Collections::PARALLEL_COLLECT_ELEMENTS / 4, [&](size_t lo, size_t hi) {
+                        for (size_t i = lo; i < hi; ++i) out[i] = fn(in[i]);
+                    });
+                    return out;
+                }
+            }
+            out.reserve(n);
+        }
+        source.each([&](const auto& x) { out.push_back(x); });
+        return out;
+    } else {
+        return Source(std::forward<S>(source));
+    }
+}
+
+template <typename S, typename F>
+inline auto coll_map(S&& source, F fn) {
+    return Collections::MapView<S, F>(std::forward<S>(source), std::move(fn));
+}
+
+template <typename S, typename F>
+inline auto coll_filter(S&& source, F pred) {
+    return Collections::FilterView<S, F>(std::forward<S>(source), std::move(pred));
+}
+
+// slice xs start [stop]: elements [start, stop), clipped to the collection
+template <typename S>
+inline auto coll_slice(S&& source, long long start, long long stop = -1) {
+    size_t from = start < 0 ? 0 : static_cast<size_t>(start);
+    size_t to = stop < 0 ? static_cast<size_t>(-1) : static_cast<size_t>(stop);
+    return Collections::SliceView<S>(std::forward<S>(source), from, to);
+}
+
+// reduce xs f init: acc = f(acc, x) left to right, in one pass over any chain
+template <typename S, typename F, typename Init>
+inline auto coll_reduce(const S& source, F fn, Init init) {
+    using Acc = std::decay_t<std::invoke_result_t<F&, const Init&, const Collections::Element<S>&>>;
+    Acc acc = static_cast<Acc>(init);
+    Collections::each(source, [&](const auto& x) { acc = fn(acc, x); });
+    return acc;
+}
+
+// reduce xs f: starts from the first element (a default value when empty)
+template <typename S, typename F>
+inline auto coll_reduce(const S& source, F fn) {
+    using T = Collections::Element<S>;
+    T acc{};
+    bool first = true;
+    Collections::each(source, [&](const auto& x) {
+        if (first) {
+            acc = x;
+            first = false;
+        } else {
+            acc = fn(acc, x);
+        }
+    });
+    return acc;
+}
+
+namespace detail {
+
+template <typename C, typename Compare>
+inline void sortInPlace(C& c, Compare comp) {
+    if constexpr (IsContiguous<C>::value) {
+        SortKernels::sortContiguous(std::data(c), std::size(c), comp);
+    } else if constexpr (std::is_base_of<std::random_access_iterator_tag,
+                                         typename std::iterator_traits<decltype(std::begin(c))>::iterator_category>::value) {
+        SortKernels::pdqsort(std::begin(c), std::end(c), comp);
+    } else {
+        c.sort(comp);  // std::list
+    }
+}
+
+} // namespace detail
+
+// sort xs [compare]: a named collection is sorted in place; a view or a
+// temporary is collected into a new sorted vector
+template <typename C, typename Compare = std::less<>>
+inline decltype(auto) coll_sort(C&& c, Compare comp = Compare()) {
+    if constexpr (std::is_lvalue_reference<C>::value && !Collections::isView<C>) {
+        detail::sortInPlace(c, comp);
+        return (c);
+    } else {
+        auto out = coll_collect(std::forward<C>(c));
+        detail::sortInPlace(out, comp);
+        return out;
+    }
+}
+
+template <typename C>
+inline decltype(auto) coll_reverse(C&& c) {
+    if constexpr (std::is_lvalue_reference<C>::value && !Collections::isView<C>) {
+        std::reverse(std::begin(c), std::end(c));
+        return (c);
+    } else {
+        auto out = coll_collect(std::forward<C>(c));
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+}
+
+// pop xs: remove and return the last element
+template <typename C>
+inline auto coll_pop(C& c) {
+    auto value = std::move(c.back());
+    c.pop_back();
+    return value;
+}
+
+// shift xs: remove and return the first element
+template <typename C>
+inline auto coll_shift(C& c) {
+    auto value = std::move(c.front());
+    c.erase(c.begin());
+    return value;
+}
+
+// unshift xs v: insert at the front
+template <typename C, typename T>
+inline void coll_unshift(C& c, T&& value) {
+    c.insert(c.begin(), std::forward<T>(value));
+}
+
+} // namespace CaseRuntime
@@ -0,0 +1,556 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Streaming Compression
+//  Self-contained LZ77-family codec using the LZ4 block format.
+//
+//  Modes (selected by the `algorithm` string of compress / decompress):
+//    Fast  "lz4", "fast"                   single-probe hash table, skip ahead on misses
+//    High  "lz4hc", "hc", "high", "zlib"   hash chains + lazy matching ("best", "gzip" too)
+//  Both modes produce the same format; decompress needs no mode.
+//
+//  Block (LZ4 sequences):
+//    token      hi nibble literal length, lo nibble match length - 4 (15 = extended)
+//    [ext]      255-continued extension bytes
+//    literals
+//    offset     2 bytes little-endian (absent in the final sequence)
+//    [ext]      match length extension
+//  The last 5 bytes of a block are always literals, and the last match starts
+//  at least 12 bytes before the block end.
+//
+//  Frame (what compress() returns and what streams write):
+//    "CLZ4" | version | log2(block size) | mode
+//    per block: u32 LE (size | 0x80000000 if stored raw) + payload
+//    u32 0 end mark
+//  Blocks are independent, so neither side keeps more than one block in memory.
+//=============================================================================
+
+#pragma once
+#include "RuntimeIO.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CaseRuntime {
+namespace Compress {
+
+enum class Mode : uint8_t { Fast = 1, High = 2 };
+
+inline Mode modeFor(std::string_view algorithm) {
+    if (algorithm == "lz4hc" || algorithm == "hc" || algorithm == "high" ||
+        algorithm == "best" || algorithm == "zlib" || algorithm == "gzip") {
+        return Mode::High;
+    }
+    return Mode::Fast;
+}
+
+constexpr unsigned DEFAULT_BLOCK_LOG = 20;  // 1 MiB blocks
+constexpr unsigned MIN_BLOCK_LOG = 10;
+constexpr unsigned MAX_BLOCK_LOG = 24;
+constexpr uint32_t STORED_FLAG = 0x80000000u;
+constexpr uint8_t FRAME_VERSION = 1;
+constexpr size_t FRAME_HEADER_SIZE = 7;
+
+// Worst-case compressed size of one block (incompressible input)
+inline size_t compressBound(size_t n) { return n + n / 255 + 16; }
+
+namespace detail {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MF_LIMIT = 12;
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr unsigned FAST_HASH_LOG = 14;
+constexpr unsigned HC_HASH_LOG = 15;
+constexpr unsigned HC_MAX_ATTEMPTS = 64;
+constexpr uint32_t NO_POS = 0xFFFFFFFFu;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool HOST_LITTLE_ENDIAN = false;
+#else
+constexpr bool HOST_LITTLE_ENDIAN = true;
+#endif
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint32_t hash4(uint32_t v, unsigned bits) {
+    return (v * 2654435761u) >> (32 - bits);
+}
+
+inline void writeLE32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+inline uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Length of the common prefix of a and b, stopping at limit (end of a)
+inline size_t countMatch(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+    const uint8_t* start = a;
+#if defined(__GNUC__) || defined(__clang__)
+    if (HOST_LITTLE_ENDIAN) {
+        while (a + 8 <= limit) {
+            uint64_t x, y;
+            std::memcpy(&x, a, 8);
+            std::memcpy(&y, b, 8);
+            if (x != y) return static_cast<size_t>(a - start) + (__builtin_ctzll(x ^ y) >> 3);
+            a += 8;
+            b += 8;
+        }
+    }
+#endif
+    while (a < limit && *a == *b) { ++a; ++b; }
+    return static_cast<size_t>(a - start);
+}
+
+inline uint8_t* writeLength(uint8_t* op, size_t len) {
+    while (len >= 255) { *op++ = 255; len -= 255; }
+    *op++ = static_cast<uint8_t>(len);
+    return op;
+}
+
+// One sequence; matchLen == 0 writes the final literals-only sequence
+inline uint8_t* emitSequence(uint8_t* op, const uint8_t* literals, size_t litLen,
+                             size_t offset, size_t matchLen) {
+    uint8_t* token = op++;
+    uint8_t t = static_cast<uint8_t>((litLen >= 15 ? 15 : litLen) << 4);
+    if (litLen >= 15) op = writeLength(op, litLen - 15);
+    std::memcpy(op, literals, litLen);
+    op += litLen;
+    if (matchLen) {
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        size_t m = matchLen - MIN_MATCH;
+        t |= static_cast<uint8_t>(m >= 15 ? 15 : m);
+        if (m >= 15) op = writeLength(op, m - 15);
+    }
+    *token = t;
+    return op;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Block encoders
+// -----------------------------------------------------------------------------
+
+// Reusable match-finder tables; keep one per stream to avoid reallocating
+struct Workspace {
+    std::vector<uint32_t> fastTable;
+    std::vector<uint32_t> head;
+    std::vector<uint16_t> chain;
+};
+
+// Fast mode: one hash probe per position, step grows with consecutive misses
+inline size_t compressBlockFast(const uint8_t* src, size_t n, uint8_t* dst, Workspace& ws) {
+    using namespace detail;
+    uint8_t* op = dst;
+    size_t anchor = 0;
+    if (n >= MF_LIMIT + 1) {
+        ws.fastTable.assign(size_t(1) << FAST_HASH_LOG, 0);
+        uint32_t* table = ws.fastTable.data();
+        const size_t mfLimit = n - MF_LIMIT;
+        const uint8_t* matchLimit = src + n - LAST_LITERALS;
+        size_t ip = 0;
+
+        for (;;) {
+            size_t candidate = 0;
+            size_t attempts = 1u << 6;
+            bool found = false;
+            while (ip <= mfLimit) {
+                uint32_t seq = read32(src + ip);
+                uint32_t h = hash4(seq, FAST_HASH_LOG);
+                candidate = table[h];
+                table[h] = static_cast<uint32_t>(ip);
+                if (candidate < ip && ip - candidate <= MAX_DISTANCE && read32(src + candidate) == seq) {
+                    found = true;
+                    break;
+                }
+                ip += attempts++ >> 6;
+            }
+            if (!found) break;
+
+            while (ip > anchor && candidate > 0 && src[ip - 1] == src[candidate - 1]) {
+                --ip;
+                --candidate;
+            }
+            size_t len = MIN_MATCH + countMatch(src + ip + MIN_MATCH, src + candidate + MIN_MATCH, matchLimit);
+            op = emitSequence(op, src + anchor, ip - anchor, ip - candidate, len);
+            ip += len;
+            anchor = ip;
+            if (ip > mfLimit) break;
+            table[hash4(read32(src + ip - 2), FAST_HASH_LOG)] = static_cast<uint32_t>(ip - 2);
+        }
+    }
+    return static_cast<size_t>(emitSequence(op, src + anchor, n - anchor, 0, 0) - dst);
+}
+
+// High-ratio mode: walk up to HC_MAX_ATTEMPTS chain links, then lazily
+// prefer a longer match starting one byte later
+inline size_t compressBlockHigh(const uint8_t* src, size_t n, uint8_t* dst, Workspace& ws) {
+    using namespace detail;
+    uint8_t* op = dst;
+    size_t anchor = 0;
+    if (n >= MF_LIMIT + 1) {
+        ws.head.assign(size_t(1) << HC_HASH_LOG, NO_POS);
+        ws.chain.assign(MAX_DISTANCE + 1, 0);
+        uint32_t* head = ws.head.data();
+        uint16_t* chain = ws.chain.data();
+        const size_t mfLimit = n - MF_LIMIT;
+        const uint8_t* matchLimit = src + n - LAST_LITERALS;
+        size_t nextInsert = 0;
+
+        auto insertUpTo = [&](size_t target) {
+            for (; nextInsert < target; ++nextInsert) {
+                uint32_t h = hash4(read32(src + nextInsert), HC_HASH_LOG);
+                uint32_t prev = head[h];
+                size_t delta = (prev == NO_POS) ? 0 : nextInsert - prev;
+                chain[nextInsert & MAX_DISTANCE] = static_cast<uint16_t>(delta > MAX_DISTANCE ? 0 : delta);
+                head[h] = static_cast<uint32_t>(nextInsert);
+            }
+        };
+
+        auto findBest = [&](size_t ip, size_t& matchPos) -> size_t {
+            insertUpTo(ip);
+            size_t best = 0;
+            uint32_t seq = read32(src + ip);
+            uint32_t cand = head[hash4(seq, HC_HASH_LOG)];
+            for (unsigned attempts = HC_MAX_ATTEMPTS; cand != NO_POS && ip - cand <= MAX_DISTANCE && attempts; --attempts) {
+                // Cheap reject: the byte that would extend the current best must match
+                if (src[cand + best] == src[ip + best] && read32(src + cand) == seq) {
+                    size_t len = MIN_MATCH + countMatch(src + ip + MIN_MATCH, src + cand + MIN_MATCH, matchLimit);
+                    if (len > best) {
+                        best = len;
+                        matchPos = cand;
+                    }
+                }
+                uint16_t delta = chain[cand & MAX_DISTANCE];
+                if (delta == 0 || delta > cand) break;
+                cand -= delta;
+            }
+            return best;
+        };
+
+        size_t ip = 0;
+        while (ip <= mfLimit) {
+            size_t matchPos = 0;
+            size_t len = findBest(ip, matchPos);
+            if (len < MIN_MATCH) {
+                ++ip;
+                continue;
+            }
+            size_t nextPos = 0;
+            while (ip + 1 <= mfLimit) {
+                size_t nextLen = findBest(ip + 1, nextPos);
+                if (nextLen <= len) break;
+                ++ip;
+                len = nextLen;
+                matchPos = nextPos;
+            }
+            op = emitSequence(op, src + anchor, ip - anchor, ip - matchPos, len);
+            ip += len;
+            anchor = ip;
+        }
+    }
+    return static_cast<size_t>(emitSequence(op, src + anchor, n - anchor, 0, 0) - dst);
+}
+
+inline size_t compressBlock(const uint8_t* src, size_t n, uint8_t* dst, Mode mode, Workspace& ws) {
+    return (mode == Mode::High) ? compressBlockHigh(src, n, dst, ws) : compressBlockFast(src, n, dst, ws);
+}
+
+// -----------------------------------------------------------------------------
+// Block decoder — bounds-checked, returns false on malformed input
+// -----------------------------------------------------------------------------
+
+inline bool decompressBlock(const uint8_t* src, size_t n, uint8_t* dst, size_t capacity, size_t& produced) {
+    const uint8_t* ip = src;
+    const uint8_t* const end = src + n;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + capacity;
+
+    while (ip < end) {
+        unsigned token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return false;
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if (lit > static_cast<size_t>(end - ip) || lit > static_cast<size_t>(oend - op)) return false;
+        if (static_cast<size_t>(end - ip) >= lit + 8 && static_cast<size_t>(oend - op) >= lit + 8) {
+            // Wildcopy in 8-byte steps; the overrun is rewritten by the next sequence
+            for (size_t i = 0; i < lit; i += 8) std::memcpy(op + i, ip + i, 8);
+        } else {
+            std::memcpy(op, ip, lit);
+        }
+        op += lit;
+        ip += lit;
+        if (ip == end) break;  // Final literals-only sequence
+
+        if (end - ip < 2) return false;
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+        size_t len = token & 15;
+        if (len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return false;
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        len += detail::MIN_MATCH;
+        if (len > static_cast<size_t>(oend - op)) return false;
+
+        const uint8_t* match = op - offset;
+        if (static_cast<size_t>(oend - op) >= len + 8) {
+            // 8-byte chunks, may write up to 7 bytes past the match
+            uint8_t* copyEnd = op + len;
+            if (offset < 8) {
+                // Overlapping run: seed 8 bytes, then copy from a whole number of
+                // periods back, which is at least 8 bytes behind and keeps the pattern
+                for (size_t i = 0; i < 8; ++i) op[i] = match[i];
+                size_t distance = offset * ((8 + offset - 1) / offset);
+                for (uint8_t* p = op + 8; p < copyEnd; p += 8) std::memcpy(p, p - distance, 8);
+            } else {
+                for (size_t i = 0; i < len; i += 8) std::memcpy(op + i, match + i, 8);
+            }
+            op = copyEnd;
+        } else {
+            for (size_t i = 0; i < len; ++i) op[i] = match[i];
+            op += len;
+        }
+    }
+    produced = static_cast<size_t>(op - dst);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Streaming API
+// -----------------------------------------------------------------------------
+
+// Receives frame bytes (Compressor) or decoded bytes (Decompressor)
+using Sink = std::function<void(std::string_view)>;
+
+// Accepts input in arbitrary chunks, emits one frame block per full block
+class Compressor {
+public:
+    Compressor(Mode mode, Sink sink, unsigned blockLog = DEFAULT_BLOCK_LOG)
+        : mode(mode), sink(std::move(sink)),
+          blockSize(size_t(1) << (blockLog < MIN_BLOCK_LOG ? MIN_BLOCK_LOG :
+                                  blockLog > MAX_BLOCK_LOG ? MAX_BLOCK_LOG : blockLog)) {
+        pending.reserve(blockSize);
+        encoded.resize(4 + compressBound(blockSize));
+        uint8_t header[FRAME_HEADER_SIZE] = {'C', 'L', 'Z', '4', FRAME_VERSION, 0, static_cast<uint8_t>(mode)};
+        while ((size_t(1) << header[5]) < blockSize) ++header[5];
+        emit(header, sizeof(header));
+    }
+
+    void write(std::string_view data) {
+        while (!data.empty()) {
+            // Full blocks straight from the caller's buffer, no staging copy
+            if (pending.empty() && data.size() >= blockSize) {
+                compressAndEmit(reinterpret_cast<const uint8_t*>(data.data()), blockSize);
+                data.remove_prefix(blockSize);
+                continue;
+            }
+            size_t take = std::min(blockSize - pending.size(), data.size());
+            pending.insert(pending.end(), data.data(), data.data() + take);
+            data.remove_prefix(take);
+            if (pending.size() == blockSize) flushBlock();
+        }
+    }
+
+    // Emit the partial block and the end mark; the compressor is spent afterwards
+    void finish() {
+        if (finished) return;
+        flushBlock();
+        uint8_t endMark[4] = {0, 0, 0, 0};
+        emit(endMark, sizeof(endMark));
+        finished = true;
+    }
+
+private:
+    Mode mode;
+    Sink sink;
+    size_t blockSize;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> encoded;
+    Workspace workspace;
+    bool finished = false;
+
+    void emit(const uint8_t* p, size_t n) {
+        sink(std::string_view(reinterpret_cast<const char*>(p), n));
+    }
+
+    void flushBlock() {
+        if (pending.empty()) return;
+        compressAndEmit(pending.data(), pending.size());
+        pending.clear();
+    }
+
+    void compressAndEmit(const uint8_t* src, size_t n) {
+        size_t size = compressBlock(src, n, encoded.data() + 4, mode, workspace);
+        if (size >= n) {
+            // Incompressible: store raw
+            detail::writeLE32(encoded.data(), static_cast<uint32_t>(n) | STORED_FLAG);
+            emit(encoded.data(), 4);
+            emit(src, n);
+        } else {
+            detail::writeLE32(encoded.data(), static_cast<uint32_t>(size));
+            emit(encoded.data(), 4 + size);
+        }
+    }
+};
+
+// Accepts frame bytes in arbitrary chunks, emits decoded blocks as they complete
+class Decompressor {
+public:
+    explicit Decompressor(Sink sink) : sink(std::move(sink)) {}
+
+    // False once the input is found to be malformed
+    bool feed(std::string_view chunk) {
+        if (failed) return false;
+        if (done) return chunk.empty();
+        // Parse straight from the caller's chunk unless a partial block is waiting
+        bool staged = !pending.empty();
+        if (staged) pending.append(chunk.data(), chunk.size());
+        std::string_view buf = staged ? std::string_view(pending) : chunk;
+        size_t pos = 0;
+        while (!failed && !done) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(buf.data()) + pos;
+            size_t avail = buf.size() - pos;
+            if (blockSize == 0) {
+                if (avail < FRAME_HEADER_SIZE) break;
+                if (std::memcmp(p, "CLZ4", 4) != 0 || p[4] != FRAME_VERSION ||
+                    p[5] < MIN_BLOCK_LOG || p[5] > MAX_BLOCK_LOG) {
+                    failed = true;
+                    break;
+                }
+                blockSize = size_t(1) << p[5];
+                decoded.resize(blockSize);
+                pos += FRAME_HEADER_SIZE;
+                continue;
+            }
+            if (avail < 4) break;
+            uint32_t word = detail::readLE32(p);
+            if (word == 0) {
+                done = true;
+                pos += 4;
+                break;
+            }
+            size_t size = word & ~STORED_FLAG;
+            if (size > compressBound(blockSize)) {
+                failed = true;
+                break;
+            }
+            if (avail < 4 + size) break;
+            if (word & STORED_FLAG) {
+                if (size > blockSize) failed = true;
+                else sink(std::string_view(reinterpret_cast<const char*>(p + 4), size));
+            } else {
+                size_t produced = 0;
+                if (!decompressBlock(p + 4, size, decoded.data(), blockSize, produced)) failed = true;
+                else sink(std::string_view(reinterpret_cast<const char*>(decoded.data()), produced));
+            }
+            pos += 4 + size;
+        }
+        if (staged) pending.erase(0, pos);
+        else pending.assign(buf.data() + pos, buf.size() - pos);
+        if (done && !pending.empty()) failed = true;  // Trailing garbage
+        return !failed;
+    }
+
+    bool finished() const { return done && !failed; }
+
+private:
+    Sink sink;
+    std::string pending;
+    std::vector<uint8_t> decoded;
+    size_t blockSize = 0;
+    bool done = false;
+    bool failed = false;
+};
+
+// -----------------------------------------------------------------------------
+// Statement entry points used by CodeEmitter
+// -----------------------------------------------------------------------------
+
+// Chunk size used when pulling from mapped files; the map is touched in order,
+// so only the pages in flight need to be resident
+constexpr size_t STREAM_CHUNK = size_t(1) << DEFAULT_BLOCK_LOG;
+
+inline std::string compress(std::string_view in, Mode mode) {
+    std::string out;
+    out.reserve(FRAME_HEADER_SIZE + compressBound(in.size()) + 8);
+    Compressor c(mode, [&out](std::string_view s) { out.append(s.data(), s.size()); });
+    c.write(in);
+    c.finish();
+    return out;
+}
+
+inline std::string compress(std::string_view in, std::string_view algorithm) {
+    return compress(in, modeFor(algorithm));
+}
+
+// Empty string on malformed input
+inline std::string decompress(std::string_view in) {
+    std::string out;
+    Decompressor d([&out](std::string_view s) { out.append(s.data(), s.size()); });
+    if (!d.feed(in) || !d.finished()) out.clear();
+    return out;
+}
+
+inline std::string decompress(std::string_view in, std::string_view /*algorithm*/) {
+    return decompress(in);
+}
+
+// File handle from `open ... "w"` as the destination
+inline void compressStream(std::string_view in, BufferedWriter& out, std::string_view algorithm) {
+    Compressor c(modeFor(algorithm), [&out](std::string_view s) { out.write(s); });
+    c.write(in);
+    c.finish();
+}
+
+inline void compressStream(MappedReader& in, BufferedWriter& out, std::string_view algorithm) {
+    Compressor c(modeFor(algorithm), [&out](std::string_view s) { out.write(s); });
+    std::string_view all = in.contents();
+    for (size_t pos = 0; pos < all.size(); pos += STREAM_CHUNK) {
+        c.write(all.substr(pos, STREAM_CHUNK));
+    }
+    c.finish();
+}
+
+inline bool decompressStream(std::string_view in, BufferedWriter& out, std::string_view /*algorithm*/) {
+    Decompressor d([&out](std::string_view s) { out.write(s); });
+    return d.feed(in) && d.finished();
+}
+
+inline bool decompressStream(MappedReader& in, BufferedWriter& out, std::string_view /*algorithm*/) {
+    Decompressor d([&out](std::string_view s) { out.write(s); });
+    std::string_view all = in.contents();
+    for (size_t pos = 0; pos < all.size(); pos += STREAM_CHUNK) {
+        if (!d.feed(all.substr(pos, STREAM_CHUNK))) return false;
+    }
+    return d.finished();
+}
+
+} // namespace Compress
+} // namespace CaseRuntime
@@ -0,0 +1,75 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Hardware Detection
+//  Core count, cache sizes and SIMD support of the machine a program runs
+//  on, and the GEMM cache-blocking derived from them. Standalone so the
+//  numeric runtime headers carry nothing from the compiler into generated
+//  programs; Optimization::AdaptiveTuner answers through these functions.
+//=============================================================================
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace CaseRuntime {
+
+struct HardwareInfo {
+    int coreCount = 1;
+    int threadCount = 1;
+    size_t l1CacheSize = 32 * 1024;
+    size_t l2CacheSize = 256 * 1024;
+    size_t l3CacheSize = 8 * 1024 * 1024;
+    bool hasSSE = false;
+    bool hasAVX = false;
+    bool hasAVX2 = false;    // with FMA
+    bool hasAVX512 = false;
+    int vectorWidth = 16;    // In bytes
+};
+
+inline HardwareInfo detectHardware() {
+    HardwareInfo hw;
+    unsigned threads = std::thread::hardware_concurrency();
+    if (threads > 0) {
+        hw.threadCount = static_cast<int>(threads);
+        hw.coreCount = static_cast<int>(threads);
+    }
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (l1 > 0) hw.l1CacheSize = static_cast<size_t>(l1);
+    if (l2 > 0) hw.l2CacheSize = static_cast<size_t>(l2);
+    if (l3 > 0) hw.l3CacheSize = static_cast<size_t>(l3);
+#endif
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    hw.hasSSE = __builtin_cpu_supports("sse2");
+    hw.hasAVX = __builtin_cpu_supports("avx");
+    hw.hasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    hw.hasAVX512 = __builtin_cpu_supports("avx512f");
+    hw.vectorWidth = hw.hasAVX512 ? 64 : (hw.hasAVX ? 32 : 16);
+#endif
+    return hw;
+}
+
+// GEMM blocking: {row/column tile, depth tile} in 8-byte elements
+inline std::pair<int, int> suggestCacheBlocking(const HardwareInfo& hw, int matrixSize) {
+    // Depth tile: a k x 8 strip of the right operand fills about half of L1
+    int depth = static_cast<int>(hw.l1CacheSize / 2 / (8 * sizeof(double)));
+    depth = std::max(64, std::min(512, depth)) & ~15;
+    // Row/column tile: a tile x depth block of the left operand fills half of L2
+    int tile = static_cast<int>(hw.l2CacheSize / 2 / (static_cast<size_t>(depth) * sizeof(double)));
+    tile = std::max(16, std::min(1024, tile)) & ~15;
+    if (matrixSize > 0) {
+        int rounded = (matrixSize + 15) & ~15;
+        tile = std::min(tile, rounded);
+        depth = std::min(depth, rounded);
+    }
+    return {tile, depth};
+}
+
+} // namespace CaseRuntime
@@ -0,0 +1,397 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Buffered File I/O
+//  Included by generated C++ for open / write / writeln / read / flush / close
+//=============================================================================
+
+#pragma once
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CaseRuntime {
+
+// 1 MiB user-space buffer: one write() syscall per megabyte instead of per line
+constexpr size_t IO_BUFFER_SIZE = 1u << 20;
+
+namespace detail {
+
+#ifdef _WIN32
+inline int sysOpenWrite(const char* path) {
+    return ::_open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+inline long sysWrite(int fd, const char* p, size_t n) { return ::_write(fd, p, static_cast<unsigned>(n)); }
+inline void sysClose(int fd) { ::_close(fd); }
+#else
+inline int sysOpenWrite(const char* path) {
+    return ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+}
+inline long sysWrite(int fd, const char* p, size_t n) { return static_cast<long>(::write(fd, p, n)); }
+inline void sysClose(int fd) { ::close(fd); }
+#endif
+
+// Write the whole range, retrying on partial writes and EINTR
+inline bool writeAll(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        long w = sysWrite(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+template <typename T>
+using Decay = typename std::decay<T>::type;
+
+template <typename T>
+struct IsStringLike : std::integral_constant<bool,
+    std::is_convertible<const T&, std::string_view>::value> {};
+
+template <typename T, typename = void>
+struct IsStreamable : std::false_type {};
+template <typename T>
+struct IsStreamable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>>
+    : std::true_type {};
+
+template <typename T, typename = void>
+struct HasBeginEnd : std::false_type {};
+template <typename T>
+struct HasBeginEnd<T, std::void_t<decltype(std::begin(std::declval<const T&>())),
+                                  decltype(std::end(std::declval<const T&>()))>> : std::true_type {};
+
+// Shortest text that parses back to exactly `value` (at most 24 chars)
+inline size_t formatDouble(char* p, double value) {
+#if defined(__cpp_lib_to_chars) || (defined(_MSC_VER) && _MSC_VER >= 1924)
+    auto r = std::to_chars(p, p + 32, value);
+    return static_cast<size_t>(r.ptr - p);
+#else
+    // No shortest-form to_chars: try 15 digits, fall back to 17 which always round-trips
+    int n = std::snprintf(p, 32, "%.15g", value);
+    if (std::strtod(p, nullptr) != value) n = std::snprintf(p, 32, "%.17g", value);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+#endif
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// BufferedWriter — append-only output file ("w" mode)
+// -----------------------------------------------------------------------------
+
+class BufferedWriter {
+public:
+    BufferedWriter() = default;
+
+    explicit BufferedWriter(const std::string& path) : fd(detail::sysOpenWrite(path.c_str())), ownsFd(true) {
+        if (fd >= 0) buffer.reset(new char[IO_BUFFER_SIZE]);
+        else failed = true;
+    }
+
+    // Wrap an existing descriptor (stdout, pipes) without taking ownership
+    explicit BufferedWriter(int existingFd)
+        : fd(existingFd), ownsFd(false), buffer(new char[IO_BUFFER_SIZE]) {}
+
+    ~BufferedWriter() { close(); }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    BufferedWriter(BufferedWriter&& other) noexcept { swap(other); }
+    BufferedWriter& operator=(BufferedWriter&& other) noexcept {
+        if (this != &other) { close(); swap(other); }
+        return *this;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // False once the file failed to open, a write failed, or something was
+    // written after close(); like a stream's failbit, the write is dropped
+    bool good() const { return !failed; }
+
+    void write(std::string_view s) {
+        if (fd < 0) {
+            failed = true;
+            return;
+        }
+        if (s.size() <= IO_BUFFER_SIZE - used) {
+            std::memcpy(buffer.get() + used, s.data(), s.size());
+            used += s.size();
+            return;
+        }
+        flush();
+        // Payloads larger than the buffer go straight to the kernel (no copy)
+        if (s.size() >= IO_BUFFER_SIZE) {
+            if (!detail::writeAll(fd, s.data(), s.size())) failed = true;
+        } else {
+            std::memcpy(buffer.get(), s.data(), s.size());
+            used = s.size();
+        }
+    }
+
+    void put(char c) {
+        if (fd < 0) {
+            failed = true;
+            return;
+        }
+        if (used == IO_BUFFER_SIZE) flush();
+        buffer[used++] = c;
+    }
+
+    // Reserve n contiguous bytes in the buffer for in-place formatting
+    // (n <= 32). When closed, the bytes go to a scratch area and are dropped.
+    char* reserve(size_t n) {
+        if (fd < 0) {
+            failed = true;
+            return scratch;
+        }
+        if (IO_BUFFER_SIZE - used < n) flush();
+        return buffer.get() + used;
+    }
+    void commit(size_t n) {
+        if (fd >= 0) used += n;
+    }
+
+    void flush() {
+        if (used > 0 && fd >= 0 && !detail::writeAll(fd, buffer.get(), used)) failed = true;
+        used = 0;
+    }
+
+    void close() {
+        if (fd < 0) return;
+        flush();
+        if (ownsFd) detail::sysClose(fd);
+        fd = -1;
+        buffer.reset();
+    }
+
+private:
+    int fd = -1;
+    bool ownsFd = false;
+    bool failed = false;
+    std::unique_ptr<char[]> buffer;  // allocated only while fd is open
+    size_t used = 0;
+    char scratch[32];
+
+    void swap(BufferedWriter& other) noexcept {
+        std::swap(fd, other.fd);
+        std::swap(ownsFd, other.ownsFd);
+        std::swap(failed, other.failed);
+        std::swap(buffer, other.buffer);
+        std::swap(used, other.used);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// MappedReader — read-only input file ("r" mode), mmap-backed on POSIX
+// -----------------------------------------------------------------------------
+
+class MappedReader {
+public:
+    MappedReader() = default;
+
+    explicit MappedReader(const std::string& path) { open(path); }
+    ~MappedReader() { close(); }
+
+    MappedReader(const MappedReader&) = delete;
+    MappedReader& operator=(const MappedReader&) = delete;
+
+    bool isOpen() const { return opened; }
+    bool eof() const { return pos >= size; }
+
+    // Whole file contents; valid until close()
+    std::string_view contents() const { return std::string_view(data, size); }
+
+    // Next whitespace-delimited token (same splitting rules as operator>>)
+    std::string_view nextToken() {
+        while (pos < size && isSpace(data[pos])) ++pos;
+        size_t start = pos;
+        while (pos < size && !isSpace(data[pos])) ++pos;
+        return std::string_view(data + start, pos - start);
+    }
+
+    // Next line without its terminator
+    std::string_view nextLine() {
+        size_t start = pos;
+        const void* nl = (pos < size) ? std::memchr(data + pos, '\n', size - pos) : nullptr;
+        size_t end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - data) : size;
+        pos = nl ? end + 1 : size;
+        if (end > start && data[end - 1] == '\r') --end;
+        return std::string_view(data + start, end - start);
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (mapped) ::munmap(const_cast<char*>(data), size);
+#endif
+        mapped = false;
+        opened = false;
+        fallback.clear();
+        data = nullptr;
+        size = pos = 0;
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    bool opened = false;
+    bool mapped = false;
+    std::string fallback;  // Used where mmap is unavailable
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    void open(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        bool empty = false;
+        if (::fstat(fd, &st) == 0) {
+            empty = st.st_size == 0;
+            if (!empty) {
+                void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                    data = static_cast<const char*>(p);
+                    size = static_cast<size_t>(st.st_size);
+                    mapped = true;
+                }
+            }
+        }
+        ::close(fd);
+        if (mapped || empty) {
+            opened = true;
+            return;
+        }
+#endif
+        // Fallback: slurp the file once
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return;
+        fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = fallback.data();
+        size = fallback.size();
+        opened = true;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Value formatting into a buffered sink (BufferedWriter, the Print buffer):
+// anything with write(string_view), put(char), reserve(n) and commit(n)
+// -----------------------------------------------------------------------------
+
+// Numbers are formatted in place in the sink's buffer: integers exactly,
+// floating point as the shortest text that reads back to the same value.
+// Collections print as [a, b, c].
+template <typename Sink, typename T>
+void writeValue(Sink& w, const T& value) {
+    using V = detail::Decay<T>;
+    if constexpr (std::is_same<V, bool>::value) {
+        w.put(value ? '1' : '0');
+    } else if constexpr (std::is_same<V, char>::value) {
+        w.put(value);
+    } else if constexpr (detail::IsStringLike<V>::value) {
+        w.write(std::string_view(value));
+    } else if constexpr (std::is_integral<V>::value) {
+        char* p = w.reserve(24);
+        auto r = std::to_chars(p, p + 24, value);
+        w.commit(static_cast<size_t>(r.ptr - p));
+    } else if constexpr (std::is_floating_point<V>::value) {
+        char* p = w.reserve(32);
+        w.commit(detail::formatDouble(p, static_cast<double>(value)));
+    } else if constexpr (detail::IsStreamable<V>::value) {
+        std::ostringstream tmp;
+        tmp << value;
+        w.write(tmp.str());
+    } else if constexpr (detail::HasBeginEnd<V>::value) {
+        w.put('[');
+        bool first = true;
+        for (const auto& element : value) {
+            if (!first) w.write(", ");
+            first = false;
+            writeValue(w, element);
+        }
+        w.put(']');
+    } else {
+        static_assert(detail::IsStreamable<V>::value, "value cannot be printed");
+    }
+}
+
+template <typename T>
+bool parseValue(std::string_view token, T& out) {
+    using V = detail::Decay<T>;
+    if (token.empty()) return false;
+    if constexpr (std::is_same<V, std::string>::value) {
+        out.assign(token.data(), token.size());
+        return true;
+    } else if constexpr (std::is_same<V, char>::value) {
+        out = token[0];
+        return true;
+    } else if constexpr (std::is_same<V, bool>::value) {
+        out = token != "0" && token != "false";
+        return true;
+    } else if constexpr (std::is_integral<V>::value || std::is_floating_point<V>::value) {
+        auto r = std::from_chars(token.data(), token.data() + token.size(), out);
+        return r.ec == std::errc();
+    } else {
+        std::istringstream tmp{std::string(token)};
+        return static_cast<bool>(tmp >> out);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Statement entry points used by CodeEmitter
+// -----------------------------------------------------------------------------
+
+template <typename T>
+inline void write(BufferedWriter& w, const T& value) { writeValue(w, value); }
+
+template <typename T>
+inline void writeLine(BufferedWriter& w, const T& value) {
+    writeValue(w, value);
+    w.put('\n');
+}
+
+template <typename T>
+inline bool read(MappedReader& r, T& value) { return parseValue(r.nextToken(), value); }
+
+inline void flush(BufferedWriter& w) { w.flush(); }
+
+// "rw" handles stay on std::fstream, but still avoid std::endl
+template <typename T>
+inline void write(std::fstream& f, const T& value) { f << value; }
+
+template <typename T>
+inline void writeLine(std::fstream& f, const T& value) { f << value << '\n'; }
+
+template <typename T>
+inline bool read(std::fstream& f, T& value) { return static_cast<bool>(f >> value); }
+
+inline void flush(std::fstream& f) { f.flush(); }
+
+} // namespace CaseRuntime
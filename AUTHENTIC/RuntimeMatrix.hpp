@@ -0,0 +1,589 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Matrix
+//  Dense double matrices for the `matrix` statement: contiguous row-major
+//  storage aligned to 64 bytes, cache-blocked GEMM, transpose and elementwise
+//  kernels with AVX2/FMA and SSE2 paths picked at run time.
+//
+//  GEMM follows the packed-panel scheme: C is cut into tile x tile blocks
+//  (one thread pool task each), the depth into `depth` slices; per slice the
+//  A block and B block are packed into MR-row / NR-column strips and a
+//  register-blocked MR x NR micro-kernel runs over them. Tile sizes come from
+//  suggestCacheBlocking in RuntimeHardware.hpp.
+//=============================================================================
+
+#pragma once
+#include "RuntimeHardware.hpp"
+#include "RuntimeParallel.hpp"
+#include "RuntimeSimd.hpp"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace CaseRuntime {
+
+// -----------------------------------------------------------------------------
+// Matrix storage
+// -----------------------------------------------------------------------------
+
+class Matrix {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    Matrix() = default;
+
+    Matrix(size_t rows, size_t cols, double fill = 0.0) : Matrix(rows, cols, Uninitialized{}) {
+        std::fill(storage, storage + size(), fill);
+    }
+
+    // One value fills the matrix; otherwise values are taken in row-major order
+    // and any missing trailing elements are zero
+    Matrix(size_t rows, size_t cols, std::initializer_list<double> values)
+        : Matrix(rows, cols, values.size() == 1 ? *values.begin() : 0.0) {
+        if (values.size() > 1) {
+            std::copy_n(values.begin(), std::min(values.size(), size()), storage);
+        }
+    }
+
+    Matrix(const Matrix& other) : Matrix(other.nRows, other.nCols, Uninitialized{}) {
+        if (size()) std::memcpy(storage, other.storage, size() * sizeof(double));
+    }
+
+    Matrix(Matrix&& other) noexcept
+        : storage(other.storage), nRows(other.nRows), nCols(other.nCols) {
+        other.storage = nullptr;
+        other.nRows = other.nCols = 0;
+    }
+
+    Matrix& operator=(const Matrix& other) {
+        if (this != &other) {
+            if (size() != other.size()) {
+                Matrix copy(other);
+                swap(copy);
+            } else {
+                nRows = other.nRows;
+                nCols = other.nCols;
+                if (size()) std::memcpy(storage, other.storage, size() * sizeof(double));
+            }
+        }
+        return *this;
+    }
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~Matrix() { release(); }
+
+    static Matrix identity(size_t n) {
+        Matrix m(n, n);
+        for (size_t i = 0; i < n; ++i) m(i, i) = 1.0;
+        return m;
+    }
+
+    // Contents are unspecified; for kernels that overwrite every element
+    static Matrix uninitialized(size_t rows, size_t cols) { return Matrix(rows, cols, Uninitialized{}); }
+
+    size_t rows() const { return nRows; }
+    size_t cols() const { return nCols; }
+    size_t size() const { return nRows * nCols; }
+
+    double* data() { return storage; }
+    const double* data() const { return storage; }
+    double* row(size_t r) { return storage + r * nCols; }
+    const double* row(size_t r) const { return storage + r * nCols; }
+
+    double& operator()(size_t r, size_t c) { return storage[r * nCols + c]; }
+    double operator()(size_t r, size_t c) const { return storage[r * nCols + c]; }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(storage, other.storage);
+        std::swap(nRows, other.nRows);
+        std::swap(nCols, other.nCols);
+    }
+
+private:
+    struct Uninitialized {};
+
+    double* storage = nullptr;
+    size_t nRows = 0;
+    size_t nCols = 0;
+
+    Matrix(size_t rows, size_t cols, Uninitialized) : nRows(rows), nCols(cols) {
+        if (size()) {
+            // Round up so every row block can be read with full-width vector loads
+            size_t bytes = (size() * sizeof(double) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+            storage = static_cast<double*>(::operator new(bytes, std::align_val_t(ALIGNMENT)));
+        }
+    }
+
+    void release() {
+        if (storage) ::operator delete(storage, std::align_val_t(ALIGNMENT));
+        storage = nullptr;
+    }
+};
+
+namespace MatrixKernels {
+
+constexpr size_t MR = 6;  // Micro-tile rows (broadcast A values)
+constexpr size_t NR = 8;  // Micro-tile columns (two 4-wide AVX vectors)
+constexpr size_t SMALL_GEMM_FLOPS = 32 * 32 * 32;
+constexpr size_t PARALLEL_GEMM_FLOPS = 96 * 96 * 96;
+constexpr size_t PARALLEL_ELEMENTS = size_t(1) << 16;
+constexpr size_t TRANSPOSE_TILE = 32;
+
+// Grow-only 64-byte aligned scratch, one per thread for packed panels
+class PackBuffer {
+public:
+    ~PackBuffer() {
+        if (buffer) ::operator delete(buffer, std::align_val_t(Matrix::ALIGNMENT));
+    }
+    double* get(size_t count) {
+        if (count > capacity) {
+            if (buffer) ::operator delete(buffer, std::align_val_t(Matrix::ALIGNMENT));
+            buffer = static_cast<double*>(::operator new(count * sizeof(double), std::align_val_t(Matrix::ALIGNMENT)));
+            capacity = count;
+        }
+        return buffer;
+    }
+
+private:
+    double* buffer = nullptr;
+    size_t capacity = 0;
+};
+
+// --- Packing -----------------------------------------------------------------
+
+// A[i0.., k0..] (mc x kc) -> MR-row strips, k-major inside a strip, zero padded
+inline void packA(const double* a, size_t lda, size_t mc, size_t kc, double* out) {
+    for (size_t ir = 0; ir < mc; ir += MR) {
+        size_t rows = std::min(MR, mc - ir);
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t i = 0; i < rows; ++i) out[i] = a[(ir + i) * lda + p];
+            for (size_t i = rows; i < MR; ++i) out[i] = 0.0;
+            out += MR;
+        }
+    }
+}
+
+// B[k0.., j0..] (kc x nc) -> NR-column strips, row of NR per k, zero padded
+inline void packB(const double* b, size_t ldb, size_t kc, size_t nc, double* out) {
+    for (size_t jr = 0; jr < nc; jr += NR) {
+        size_t cols = std::min(NR, nc - jr);
+        for (size_t p = 0; p < kc; ++p) {
+            const double* src = b + p * ldb + jr;
+            if (cols == NR) {
+                std::memcpy(out, src, NR * sizeof(double));
+            } else {
+                for (size_t j = 0; j < cols; ++j) out[j] = src[j];
+                for (size_t j = cols; j < NR; ++j) out[j] = 0.0;
+            }
+            out += NR;
+        }
+    }
+}
+
+// --- Micro-kernels: c[MR x NR] (+)= a-strip * b-strip ------------------------
+
+inline void microGeneric(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool add) {
+    double acc[MR][NR] = {};
+    for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+        for (size_t i = 0; i < MR; ++i) {
+            for (size_t j = 0; j < NR; ++j) acc[i][j] += a[i] * b[j];
+        }
+    }
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t j = 0; j < NR; ++j) c[i * ldc + j] = add ? c[i * ldc + j] + acc[i][j] : acc[i][j];
+    }
+}
+
+#if defined(CASE_RUNTIME_X86)
+
+// SSE2: 12 of 16 xmm registers hold a 6 x 4 half tile; run once per half
+inline void microSse2Half(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool add) {
+    __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd(), c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+    __m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd(), c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+    __m128d c40 = _mm_setzero_pd(), c41 = _mm_setzero_pd(), c50 = _mm_setzero_pd(), c51 = _mm_setzero_pd();
+    for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+        __m128d b0 = _mm_load_pd(b);
+        __m128d b1 = _mm_load_pd(b + 2);
+        __m128d ai = _mm_load1_pd(a + 0);
+        c00 = _mm_add_pd(c00, _mm_mul_pd(ai, b0)); c01 = _mm_add_pd(c01, _mm_mul_pd(ai, b1));
+        ai = _mm_load1_pd(a + 1);
+        c10 = _mm_add_pd(c10, _mm_mul_pd(ai, b0)); c11 = _mm_add_pd(c11, _mm_mul_pd(ai, b1));
+        ai = _mm_load1_pd(a + 2);
+        c20 = _mm_add_pd(c20, _mm_mul_pd(ai, b0)); c21 = _mm_add_pd(c21, _mm_mul_pd(ai, b1));
+        ai = _mm_load1_pd(a + 3);
+        c30 = _mm_add_pd(c30, _mm_mul_pd(ai, b0)); c31 = _mm_add_pd(c31, _mm_mul_pd(ai, b1));
+        ai = _mm_load1_pd(a + 4);
+        c40 = _mm_add_pd(c40, _mm_mul_pd(ai, b0)); c41 = _mm_add_pd(c41, _mm_mul_pd(ai, b1));
+        ai = _mm_load1_pd(a + 5);
+        c50 = _mm_add_pd(c50, _mm_mul_pd(ai, b0)); c51 = _mm_add_pd(c51, _mm_mul_pd(ai, b1));
+    }
+    __m128d acc[MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+    for (size_t i = 0; i < MR; ++i) {
+        double* row = c + i * ldc;
+        if (add) {
+            acc[i][0] = _mm_add_pd(acc[i][0], _mm_loadu_pd(row));
+            acc[i][1] = _mm_add_pd(acc[i][1], _mm_loadu_pd(row + 2));
+        }
+        _mm_storeu_pd(row, acc[i][0]);
+        _mm_storeu_pd(row + 2, acc[i][1]);
+    }
+}
+
+inline void microSse2(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool add) {
+    microSse2Half(kc, a, b, c, ldc, add);
+    microSse2Half(kc, a, b + 4, c + 4, ldc, add);
+}
+
+// AVX2/FMA: 12 ymm accumulators, 2 B vectors, 1 broadcast
+CASE_TARGET_AVX2
+inline void microAvx2(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool add) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(), c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd(), c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd(), c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+        __m256d b0 = _mm256_load_pd(b);
+        __m256d b1 = _mm256_load_pd(b + 4);
+        __m256d ai = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+    }
+    __m256d acc[MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+    for (size_t i = 0; i < MR; ++i) {
+        double* row = c + i * ldc;
+        if (add) {
+            acc[i][0] = _mm256_add_pd(acc[i][0], _mm256_loadu_pd(row));
+            acc[i][1] = _mm256_add_pd(acc[i][1], _mm256_loadu_pd(row + 4));
+        }
+        _mm256_storeu_pd(row, acc[i][0]);
+        _mm256_storeu_pd(row + 4, acc[i][1]);
+    }
+}
+
+#endif // CASE_RUNTIME_X86
+
+using MicroKernel = void (*)(size_t, const double*, const double*, double*, size_t, bool);
+
+inline MicroKernel microKernel() {
+#if defined(CASE_RUNTIME_X86)
+    switch (activeIsa()) {
+    case Isa::Avx2: return microAvx2;
+    case Isa::Sse2: return microSse2;
+    default: break;
+    }
+#endif
+    return microGeneric;
+}
+
+// One C tile (mc x nc at c) over the full depth k
+inline void gemmTile(const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc,
+                     size_t mc, size_t nc, size_t k, size_t depth, bool accumulate, MicroKernel kernel) {
+    static thread_local PackBuffer packedA, packedB;
+    size_t mcPadded = (mc + MR - 1) / MR * MR;
+    size_t ncPadded = (nc + NR - 1) / NR * NR;
+    double* pa = packedA.get(mcPadded * depth);
+    double* pb = packedB.get(ncPadded * depth);
+    double edge[MR * NR];
+
+    for (size_t pc = 0; pc < k; pc += depth) {
+        size_t kc = std::min(depth, k - pc);
+        bool add = accumulate || pc > 0;
+        packB(b + pc * ldb, ldb, kc, nc, pb);
+        packA(a + pc, lda, mc, kc, pa);
+        for (size_t jr = 0; jr < nc; jr += NR) {
+            size_t cols = std::min(NR, nc - jr);
+            for (size_t ir = 0; ir < mc; ir += MR) {
+                size_t rows = std::min(MR, mc - ir);
+                double* ct = c + ir * ldc + jr;
+                const double* as = pa + ir * kc;
+                const double* bs = pb + jr * kc;
+                if (rows == MR && cols == NR) {
+                    kernel(kc, as, bs, ct, ldc, add);
+                } else {
+                    kernel(kc, as, bs, edge, NR, false);
+                    for (size_t i = 0; i < rows; ++i) {
+                        for (size_t j = 0; j < cols; ++j) {
+                            ct[i * ldc + j] = add ? ct[i * ldc + j] + edge[i * NR + j] : edge[i * NR + j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// c (m x n) = a (m x k) * b (k x n), plus c when accumulating
+inline void gemm(const double* a, const double* b, double* c, size_t m, size_t n, size_t k, bool accumulate) {
+    if (m == 0 || n == 0) return;
+    if (k == 0) {
+        if (!accumulate) std::fill(c, c + m * n, 0.0);
+        return;
+    }
+    if (m * n * k <= SMALL_GEMM_FLOPS) {
+        // Packing does not pay off; i-k-j order keeps the inner loop contiguous
+        if (!accumulate) std::fill(c, c + m * n, 0.0);
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t p = 0; p < k; ++p) {
+                double av = a[i * k + p];
+                const double* brow = b + p * n;
+                double* crow = c + i * n;
+                for (size_t j = 0; j < n; ++j) crow[j] += av * brow[j];
+            }
+        }
+        return;
+    }
+
+    static const HardwareInfo hw = detectHardware();
+    auto blocking = suggestCacheBlocking(hw, static_cast<int>(std::max({m, n, k})));
+    size_t mc = std::max(MR, static_cast<size_t>(blocking.first) / MR * MR);
+    size_t nc = std::max(NR, static_cast<size_t>(blocking.first) / NR * NR);
+    size_t depth = std::max<size_t>(1, static_cast<size_t>(blocking.second));
+    MicroKernel kernel = microKernel();
+    bool parallel = m * n * k >= PARALLEL_GEMM_FLOPS;
+    if (parallel) {
+        // Split further until every thread has a tile
+        size_t threads = ThreadPool::instance().concurrency();
+        while (((m + mc - 1) / mc) * ((n + nc - 1) / nc) < threads && mc > 8 * MR) {
+            mc = std::max(MR, mc / 2 / MR * MR);
+        }
+    }
+
+    size_t rowTiles = (m + mc - 1) / mc;
+    size_t colTiles = (n + nc - 1) / nc;
+    auto runTile = [&](size_t t) {
+        size_t i0 = (t / colTiles) * mc;
+        size_t j0 = (t % colTiles) * nc;
+        gemmTile(a + i0 * k, k, b + j0, n, c + i0 * n + j0, n,
+                 std::min(mc, m - i0), std::min(nc, n - j0), k, depth, accumulate, kernel);
+    };
+    if (parallel) {
+        ThreadPool::instance().run(rowTiles * colTiles, runTile);
+    } else {
+        for (size_t t = 0; t < rowTiles * colTiles; ++t) runTile(t);
+    }
+}
+
+// --- Transpose ----------------------------------------------------------------
+
+#if defined(CASE_RUNTIME_X86)
+CASE_TARGET_AVX2
+inline void transpose4x4Avx(const double* src, size_t lds, double* dst, size_t ldd) {
+    __m256d r0 = _mm256_loadu_pd(src);
+    __m256d r1 = _mm256_loadu_pd(src + lds);
+    __m256d r2 = _mm256_loadu_pd(src + 2 * lds);
+    __m256d r3 = _mm256_loadu_pd(src + 3 * lds);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+inline void transpose2x2Sse(const double* src, size_t lds, double* dst, size_t ldd) {
+    __m128d r0 = _mm_loadu_pd(src);
+    __m128d r1 = _mm_loadu_pd(src + lds);
+    _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+    _mm_storeu_pd(dst + ldd, _mm_unpackhi_pd(r0, r1));
+}
+#endif
+
+// dst (cols x rows) = src (rows x cols)^T for rows [r0, r1)
+inline void transposeRows(const double* src, double* dst, size_t rows, size_t cols, size_t r0, size_t r1) {
+    Isa isa = activeIsa();
+    size_t micro = (isa == Isa::Avx2) ? 4 : (isa == Isa::Sse2 ? 2 : 1);
+    for (size_t ib = r0; ib < r1; ib += TRANSPOSE_TILE) {
+        size_t ie = std::min(r1, ib + TRANSPOSE_TILE);
+        for (size_t jb = 0; jb < cols; jb += TRANSPOSE_TILE) {
+            size_t je = std::min(cols, jb + TRANSPOSE_TILE);
+            size_t i = ib;
+            for (; i + micro <= ie && micro > 1; i += micro) {
+                size_t j = jb;
+                for (; j + micro <= je; j += micro) {
+#if defined(CASE_RUNTIME_X86)
+                    if (micro == 4) transpose4x4Avx(src + i * cols + j, cols, dst + j * rows + i, rows);
+                    else transpose2x2Sse(src + i * cols + j, cols, dst + j * rows + i, rows);
+#endif
+                }
+                for (; j < je; ++j) {
+                    for (size_t ii = i; ii < i + micro; ++ii) dst[j * rows + ii] = src[ii * cols + j];
+                }
+            }
+            for (; i < ie; ++i) {
+                for (size_t j = jb; j < je; ++j) dst[j * rows + i] = src[i * cols + j];
+            }
+        }
+    }
+}
+
+// --- Elementwise ---------------------------------------------------------------
+
+enum class ElementOp { Add, Sub, Mul, Scale };
+
+template <ElementOp Op>
+inline double applyScalar(double x, double y, double s) {
+    if constexpr (Op == ElementOp::Add) return x + y;
+    else if constexpr (Op == ElementOp::Sub) return x - y;
+    else if constexpr (Op == ElementOp::Mul) return x * y;
+    else return x * s;
+}
+
+#if defined(CASE_RUNTIME_X86)
+template <ElementOp Op>
+CASE_TARGET_AVX2
+inline size_t elementwiseAvx2(const double* a, const double* b, double s, double* out, size_t n) {
+    __m256d sv = _mm256_set1_pd(s);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d x0 = _mm256_loadu_pd(a + i), x1 = _mm256_loadu_pd(a + i + 4);
+        __m256d r0, r1;
+        if constexpr (Op == ElementOp::Scale) {
+            r0 = _mm256_mul_pd(x0, sv);
+            r1 = _mm256_mul_pd(x1, sv);
+        } else {
+            __m256d y0 = _mm256_loadu_pd(b + i), y1 = _mm256_loadu_pd(b + i + 4);
+            if constexpr (Op == ElementOp::Add) { r0 = _mm256_add_pd(x0, y0); r1 = _mm256_add_pd(x1, y1); }
+            else if constexpr (Op == ElementOp::Sub) { r0 = _mm256_sub_pd(x0, y0); r1 = _mm256_sub_pd(x1, y1); }
+            else { r0 = _mm256_mul_pd(x0, y0); r1 = _mm256_mul_pd(x1, y1); }
+        }
+        _mm256_storeu_pd(out + i, r0);
+        _mm256_storeu_pd(out + i + 4, r1);
+    }
+    return i;
+}
+
+template <ElementOp Op>
+inline size_t elementwiseSse2(const double* a, const double* b, double s, double* out, size_t n) {
+    __m128d sv = _mm_set1_pd(s);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);
+        __m128d r;
+        if constexpr (Op == ElementOp::Scale) r = _mm_mul_pd(x, sv);
+        else if constexpr (Op == ElementOp::Add) r = _mm_add_pd(x, _mm_loadu_pd(b + i));
+        else if constexpr (Op == ElementOp::Sub) r = _mm_sub_pd(x, _mm_loadu_pd(b + i));
+        else r = _mm_mul_pd(x, _mm_loadu_pd(b + i));
+        _mm_storeu_pd(out + i, r);
+    }
+    return i;
+}
+#endif
+
+template <ElementOp Op>
+inline void elementwise(const double* a, const double* b, double s, double* out, size_t n) {
+    parallelFor(0, n, PARALLEL_ELEMENTS, [&](size_t lo, size_t hi) {
+        size_t done = 0;
+        const double* bp = b ? b + lo : nullptr;
+#if defined(CASE_RUNTIME_X86)
+        if (activeIsa() == Isa::Avx2) done = elementwiseAvx2<Op>(a + lo, bp, s, out + lo, hi - lo);
+        else done = elementwiseSse2<Op>(a + lo, bp, s, out + lo, hi - lo);
+#endif
+        for (size_t i = lo + done; i < hi; ++i) out[i] = applyScalar<Op>(a[i], b ? b[i] : 0.0, s);
+    });
+}
+
+} // namespace MatrixKernels
+
+// -----------------------------------------------------------------------------
+// Operations used by generated code
+// -----------------------------------------------------------------------------
+
+namespace detail {
+inline void requireShape(bool ok, const char* op, const Matrix& a, const Matrix& b) {
+    if (!ok) {
+        throw std::invalid_argument(std::string("matrix ") + op + ": incompatible shapes " +
+                                    std::to_string(a.rows()) + "x" + std::to_string(a.cols()) + " and " +
+                                    std::to_string(b.rows()) + "x" + std::to_string(b.cols()));
+    }
+}
+} // namespace detail
+
+// out = a * b; out is resized if needed and must not alias a or b
+inline void matmulInto(Matrix& out, const Matrix& a, const Matrix& b) {
+    detail::requireShape(a.cols() == b.rows(), "multiply", a, b);
+    if (out.rows() != a.rows() || out.cols() != b.cols()) out = Matrix::uninitialized(a.rows(), b.cols());
+    MatrixKernels::gemm(a.data(), b.data(), out.data(), a.rows(), b.cols(), a.cols(), false);
+}
+
+inline Matrix matmul(const Matrix& a, const Matrix& b) {
+    Matrix out;
+    matmulInto(out, a, b);
+    return out;
+}
+
+// a * b + c in one pass: c is the GEMM accumulator, no temporary product
+inline Matrix matmulAdd(const Matrix& a, const Matrix& b, const Matrix& c) {
+    detail::requireShape(a.cols() == b.rows(), "multiply", a, b);
+    detail::requireShape(c.rows() == a.rows() && c.cols() == b.cols(), "add", c, a);
+    Matrix out(c);
+    MatrixKernels::gemm(a.data(), b.data(), out.data(), a.rows(), b.cols(), a.cols(), true);
+    return out;
+}
+
+inline Matrix transpose(const Matrix& m) {
+    Matrix out = Matrix::uninitialized(m.cols(), m.rows());
+    size_t grain = std::max<size_t>(MatrixKernels::TRANSPOSE_TILE,
+                                    MatrixKernels::PARALLEL_ELEMENTS / std::max<size_t>(1, m.cols()));
+    parallelFor(0, m.rows(), grain, [&](size_t r0, size_t r1) {
+        MatrixKernels::transposeRows(m.data(), out.data(), m.rows(), m.cols(), r0, r1);
+    });
+    return out;
+}
+
+template <MatrixKernels::ElementOp Op>
+inline Matrix elementwise(const Matrix& a, const Matrix& b, const char* name) {
+    detail::requireShape(a.rows() == b.rows() && a.cols() == b.cols(), name, a, b);
+    Matrix out = Matrix::uninitialized(a.rows(), a.cols());
+    MatrixKernels::elementwise<Op>(a.data(), b.data(), 0.0, out.data(), a.size());
+    return out;
+}
+
+inline Matrix add(const Matrix& a, const Matrix& b) { return elementwise<MatrixKernels::ElementOp::Add>(a, b, "add"); }
+inline Matrix sub(const Matrix& a, const Matrix& b) { return elementwise<MatrixKernels::ElementOp::Sub>(a, b, "subtract"); }
+inline Matrix hadamard(const Matrix& a, const Matrix& b) { return elementwise<MatrixKernels::ElementOp::Mul>(a, b, "hadamard"); }
+
+inline Matrix scale(const Matrix& a, double s) {
+    Matrix out = Matrix::uninitialized(a.rows(), a.cols());
+    MatrixKernels::elementwise<MatrixKernels::ElementOp::Scale>(a.data(), nullptr, s, out.data(), a.size());
+    return out;
+}
+
+// In-place accumulate, used for `mutate m m + x`
+inline void addInto(Matrix& a, const Matrix& b) {
+    detail::requireShape(a.rows() == b.rows() && a.cols() == b.cols(), "add", a, b);
+    MatrixKernels::elementwise<MatrixKernels::ElementOp::Add>(a.data(), b.data(), 0.0, a.data(), a.size());
+}
+
+inline Matrix operator*(const Matrix& a, const Matrix& b) { return matmul(a, b); }
+inline Matrix operator+(const Matrix& a, const Matrix& b) { return add(a, b); }
+inline Matrix operator-(const Matrix& a, const Matrix& b) { return sub(a, b); }
+inline Matrix operator*(const Matrix& a, double s) { return scale(a, s); }
+inline Matrix operator*(double s, const Matrix& a) { return scale(a, s); }
+
+inline std::ostream& operator<<(std::ostream& os, const Matrix& m) {
+    for (size_t r = 0; r < m.rows(); ++r) {
+        os << (r ? "\n[" : "[");
+        for (size_t c = 0; c < m.cols(); ++c) os << (c ? " " : "") << m(r, c);
+        os << "]";
+    }
+    return os;
+}
+
+} // namespace CaseRuntime
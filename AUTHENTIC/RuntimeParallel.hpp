@@ -0,0 +1,154 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Thread Pool
+//  Shared worker pool for data-parallel runtime kernels (matrix tiles,
+//  collection chunks). Workers start on first use and live until exit.
+//
+//  CASE_THREADS=<n> overrides the worker count (1 = run everything inline).
+//=============================================================================
+
+#pragma once
+#include "RuntimeThreadOutput.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CaseRuntime {
+
+class ThreadPool {
+public:
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Threads that take part in run(): workers plus the caller
+    size_t concurrency() const { return workers.size() + 1; }
+
+    // Call task(i) for every i in [0, count) and wait for all of them.
+    // The calling thread works too; calls made from inside a task run inline.
+    // Print lines from before the call, then the workers', reach stdout
+    // before it returns.
+    void run(size_t count, const std::function<void(size_t)>& task) {
+        if (count == 0) return;
+        if (count == 1 || workers.empty() || insideTask()) {
+            for (size_t i = 0; i < count; ++i) task(i);
+            return;
+        }
+        std::lock_guard<std::mutex> serial(submitMutex);  // One job in flight
+        flushThreadOutput();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            jobSize = count;
+            next.store(0, std::memory_order_relaxed);
+            pending = count;
+            ++generation;
+        }
+        wake.notify_all();
+        size_t done = drain(task, count);
+        std::unique_lock<std::mutex> lock(mutex);
+        pending -= done;
+        // Workers holding this job must leave before it can be replaced
+        finished.wait(lock, [this] { return pending == 0 && active == 0; });
+        job = nullptr;
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobSize = 0;
+    std::atomic<size_t> next{0};
+    size_t pending = 0;
+    size_t active = 0;
+    size_t generation = 0;
+    bool stopping = false;
+
+    ThreadPool() {
+        size_t n = std::thread::hardware_concurrency();
+        if (const char* env = std::getenv("CASE_THREADS")) n = std::strtoul(env, nullptr, 10);
+        n = std::max<size_t>(n, 1);
+        workers.reserve(n - 1);
+        for (size_t i = 1; i < n; ++i) workers.emplace_back([this] { workerLoop(); });
+    }
+
+    static bool& insideTask() {
+        static thread_local bool inside = false;
+        return inside;
+    }
+
+    // Claim indices until the job is exhausted; returns how many ran here
+    size_t drain(const std::function<void(size_t)>& task, size_t count) {
+        bool& inside = insideTask();
+        inside = true;
+        size_t done = 0;
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count; ++done) {
+            task(i);
+        }
+        inside = false;
+        return done;
+    }
+
+    void workerLoop() {
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] { return stopping || (generation != seen && job); });
+            if (stopping) return;
+            seen = generation;
+            const std::function<void(size_t)>* task = job;
+            size_t count = jobSize;
+            ++active;
+            lock.unlock();
+            size_t done = drain(*task, count);
+            flushThreadOutput();
+            lock.lock();
+            pending -= done;
+            --active;
+            if (pending == 0 && active == 0) finished.notify_all();
+        }
+    }
+};
+
+// Split [begin, end) into chunks of at least `grain` and call body(lo, hi)
+// on each, across the pool. Small ranges run inline on the caller.
+template <typename Body>
+void parallelFor(size_t begin, size_t end, size_t grain, Body&& body) {
+    if (end <= begin) return;
+    size_t total = end - begin;
+    grain = std::max<size_t>(grain, 1);
+    ThreadPool& pool = ThreadPool::instance();
+    size_t chunks = std::min(total / grain, pool.concurrency() * 4);
+    if (chunks <= 1) {
+        body(begin, end);
+        return;
+    }
+    size_t step = (total + chunks - 1) / chunks;
+    chunks = (total + step - 1) / step;
+    pool.run(chunks, [&](size_t c) {
+        size_t lo = begin + c * step;
+        body(lo, std::min(end, lo + step));
+    });
+}
+
+} // namespace CaseRuntime
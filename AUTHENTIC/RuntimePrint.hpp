@@ -0,0 +1,171 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Console Output
+//  Included by generated C++ for Print (and the other statements that write
+//  to stdout: serialize / compress without a target, input prompts, flush).
+//
+//  Each thread formats into its own buffer with the RuntimeIO formatter
+//  (to_chars integers, shortest round-trip doubles) and hands it to write(2)
+//  in PRINT_BUFFER_SIZE chunks, so printing costs no locale lookups, no
+//  stream sentries and no syscall per line. A full buffer hands over its
+//  complete lines and keeps the partial one, and chunks are written under
+//  one lock, so lines from different threads never interleave (only a
+//  single line longer than the buffer is written in pieces). A thread's
+//  buffer is flushed when it exits -- for the main thread, at exit() --
+//  before it starts other threads (RuntimeThreadOutput.hpp), and on every
+//  line when stdout is a terminal.
+//=============================================================================
+
+#pragma once
+#include "RuntimeIO.hpp"
+#include "RuntimeThreadOutput.hpp"
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace CaseRuntime {
+
+// 64 KiB per printing thread: large enough that a syscall is noise, small
+// enough to stay in L2 while it fills
+constexpr size_t PRINT_BUFFER_SIZE = 1u << 16;
+
+namespace detail {
+
+inline std::mutex& stdoutLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+inline bool stdoutIsTerminal() {
+#ifdef _WIN32
+    static const bool terminal = ::_isatty(1) != 0;
+#else
+    static const bool terminal = ::isatty(1) != 0;
+#endif
+    return terminal;
+}
+
+// Set once this thread has a PrintBuffer, so flushing a thread that never
+// printed does not create one
+inline bool& hasPrintBuffer() {
+    thread_local bool has = false;
+    return has;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// PrintBuffer — one per thread, appends to stdout (fd 1)
+// -----------------------------------------------------------------------------
+
+class PrintBuffer {
+public:
+    PrintBuffer() : buffer(new char[PRINT_BUFFER_SIZE]) { detail::hasPrintBuffer() = true; }
+    ~PrintBuffer() { flush(); }
+
+    PrintBuffer(const PrintBuffer&) = delete;
+    PrintBuffer& operator=(const PrintBuffer&) = delete;
+
+    void write(std::string_view s) {
+        if (s.size() > PRINT_BUFFER_SIZE - used) spill();
+        if (s.size() <= PRINT_BUFFER_SIZE - used) {
+            std::memcpy(buffer.get() + used, s.data(), s.size());
+            used += s.size();
+            return;
+        }
+        flush();
+        if (s.size() >= PRINT_BUFFER_SIZE) {
+            std::lock_guard<std::mutex> guard(detail::stdoutLock());
+            detail::writeAll(1, s.data(), s.size());
+        } else {
+            std::memcpy(buffer.get(), s.data(), s.size());
+            used = s.size();
+        }
+    }
+
+    void put(char c) {
+        if (used == PRINT_BUFFER_SIZE) spill();
+        buffer[used++] = c;
+    }
+
+    char* reserve(size_t n) {
+        if (PRINT_BUFFER_SIZE - used < n) spill();
+        if (PRINT_BUFFER_SIZE - used < n) flush();
+        return buffer.get() + used;
+    }
+    void commit(size_t n) { used += n; }
+
+    // End of one Print: the only point a chunk is handed over early
+    void endLine() {
+        put('\n');
+        if (detail::stdoutIsTerminal()) flush();
+    }
+
+    void flush() {
+        if (used == 0) return;
+        std::lock_guard<std::mutex> guard(detail::stdoutLock());
+        detail::writeAll(1, buffer.get(), used);
+        used = 0;
+    }
+
+private:
+    // Buffer full: write out the complete lines and keep the partial one.
+    // With no line break at all there is nothing to keep it for.
+    void spill() {
+        size_t end = std::string_view(buffer.get(), used).rfind('\n');
+        if (end == std::string_view::npos) {
+            flush();
+            return;
+        }
+        ++end;
+        {
+            std::lock_guard<std::mutex> guard(detail::stdoutLock());
+            detail::writeAll(1, buffer.get(), end);
+        }
+        std::memmove(buffer.get(), buffer.get() + end, used - end);
+        used -= end;
+    }
+
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+};
+
+inline PrintBuffer& printBuffer() {
+    thread_local PrintBuffer buffer;
+    return buffer;
+}
+
+// -----------------------------------------------------------------------------
+// Statement entry points used by CodeEmitter
+// -----------------------------------------------------------------------------
+
+// Print expr
+template <typename T>
+inline void printLine(const T& value) {
+    PrintBuffer& out = printBuffer();
+    writeValue(out, value);
+    out.endLine();
+}
+
+// Output without a line break (compress to stdout, input prompts)
+template <typename T>
+inline void print(const T& value) {
+    writeValue(printBuffer(), value);
+}
+
+// flush with no handle
+inline void flushOutput() { printBuffer().flush(); }
+
+// Nothing the generated program prints goes through C stdio, so iostreams
+// need not stay in step with it; std::cin is untied because `input` flushes
+// the prompt itself. Code that starts threads flushes through the hook.
+inline bool initOutput() {
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    detail::threadOutputFlush().store([] { if (detail::hasPrintBuffer()) printBuffer().flush(); },
+                                      std::memory_order_release);
+    return true;
+}
+
+} // namespace CaseRuntime
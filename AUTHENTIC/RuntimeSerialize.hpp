@@ -0,0 +1,542 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Struct Serialization
+//  Compact binary records (varint + length prefix) with a JSON fallback.
+//
+//  CodeEmitter generates, for every `struct Name { ... }` of a program that
+//  uses serialize or deserialize (T is Name or its zero-copy NameView):
+//    caseEncodedSize(const T&)                 exact payload size
+//    caseEncode(Serial::Writer&, const T&)     fields in declaration order
+//    caseDecode(Serial::Reader&, T&)           NameView: zero-copy decode
+//    caseToJson(JsonWriter&, const T&)         JSON fallback
+//    caseFromJson(JsonReader&, Name&)
+//  The functions below find them through argument-dependent lookup.
+//
+//  Binary layout of one record:
+//    varint  payload length
+//    fields  in declaration order:
+//      bool / char          1 byte
+//      signed integers      zigzag varint
+//      unsigned integers    varint
+//      float / double       4 / 8 bytes little-endian
+//      string               varint length + bytes
+//      std::array<T, N>     N elements back to back (raw LE block for arithmetic T)
+//      nested struct        a full record (length-prefixed)
+//=============================================================================
+
+#pragma once
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace CaseRuntime {
+namespace Serial {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool HOST_LITTLE_ENDIAN = false;
+#else
+constexpr bool HOST_LITTLE_ENDIAN = true;
+#endif
+
+template <typename T>
+struct IsStdArray : std::false_type {};
+template <typename T, size_t N>
+struct IsStdArray<std::array<T, N>> : std::true_type {};
+
+template <typename T>
+struct IsStringField : std::integral_constant<bool,
+    std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value> {};
+
+// -----------------------------------------------------------------------------
+// Varint helpers
+// -----------------------------------------------------------------------------
+
+inline size_t varintSize(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; ++n; }
+    return n;
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// -----------------------------------------------------------------------------
+// Size computation (exact, so encode() allocates once)
+// -----------------------------------------------------------------------------
+
+template <typename T>
+size_t sizeOf(const T& v);
+
+template <typename T>
+size_t recordSize(const T& v) {
+    size_t payload = caseEncodedSize(v);
+    return varintSize(payload) + payload;
+}
+
+template <typename T>
+size_t sizeOf(const T& v) {
+    if constexpr (std::is_same<T, bool>::value || std::is_same<T, char>::value) {
+        return 1;
+    } else if constexpr (std::is_floating_point<T>::value) {
+        return sizeof(T);
+    } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+        return varintSize(zigzag(static_cast<int64_t>(v)));
+    } else if constexpr (std::is_integral<T>::value) {
+        return varintSize(static_cast<uint64_t>(v));
+    } else if constexpr (IsStringField<T>::value) {
+        return varintSize(v.size()) + v.size();
+    } else if constexpr (IsStdArray<T>::value) {
+        using E = typename T::value_type;
+        if constexpr (std::is_floating_point<E>::value || std::is_same<E, char>::value) {
+            return sizeof(E) * v.size();
+        } else {
+            size_t n = 0;
+            for (const auto& e : v) n += sizeOf(e);
+            return n;
+        }
+    } else {
+        return recordSize(v);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Writer — appends into a caller-owned std::string (reusable across records)
+// -----------------------------------------------------------------------------
+
+class Writer {
+public:
+    explicit Writer(char* dst) : cursor(dst) {}
+
+    char* position() const { return cursor; }
+
+    void raw(const void* p, size_t n) {
+        std::memcpy(cursor, p, n);
+        cursor += n;
+    }
+
+    void byte(uint8_t b) { *cursor++ = static_cast<char>(b); }
+
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            *cursor++ = static_cast<char>(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        *cursor++ = static_cast<char>(v);
+    }
+
+    template <typename T>
+    void fixed(T v) {
+        if (HOST_LITTLE_ENDIAN) {
+            raw(&v, sizeof(T));
+        } else {
+            unsigned char b[sizeof(T)];
+            std::memcpy(b, &v, sizeof(T));
+            for (size_t i = sizeof(T); i-- > 0;) byte(b[i]);
+        }
+    }
+
+    template <typename T>
+    void field(const T& v) {
+        if constexpr (std::is_same<T, bool>::value || std::is_same<T, char>::value) {
+            byte(static_cast<uint8_t>(v));
+        } else if constexpr (std::is_floating_point<T>::value) {
+            fixed(v);
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            varint(zigzag(static_cast<int64_t>(v)));
+        } else if constexpr (std::is_integral<T>::value) {
+            varint(static_cast<uint64_t>(v));
+        } else if constexpr (IsStringField<T>::value) {
+            varint(v.size());
+            raw(v.data(), v.size());
+        } else if constexpr (IsStdArray<T>::value) {
+            using E = typename T::value_type;
+            if constexpr ((std::is_floating_point<E>::value || std::is_same<E, char>::value)
+                          && (HOST_LITTLE_ENDIAN || sizeof(E) == 1)) {
+                raw(v.data(), sizeof(E) * v.size());
+            } else {
+                for (const auto& e : v) field(e);
+            }
+        } else {
+            varint(caseEncodedSize(v));
+            caseEncode(*this, v);
+        }
+    }
+
+private:
+    char* cursor;
+};
+
+// -----------------------------------------------------------------------------
+// Reader — bounds-checked cursor over an input buffer; strings become views
+// -----------------------------------------------------------------------------
+
+class Reader {
+public:
+    Reader(const char* begin, const char* end) : cursor(begin), limit(end) {}
+
+    bool ok() const { return !failed; }
+    const char* position() const { return cursor; }
+
+    bool varint(uint64_t& out) {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor >= limit) return fail();
+            uint8_t b = static_cast<uint8_t>(*cursor++);
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) { out = v; return true; }
+        }
+        return fail();
+    }
+
+    template <typename T>
+    bool fixed(T& out) {
+        if (static_cast<size_t>(limit - cursor) < sizeof(T)) return fail();
+        if (HOST_LITTLE_ENDIAN) {
+            std::memcpy(&out, cursor, sizeof(T));
+        } else {
+            unsigned char b[sizeof(T)];
+            for (size_t i = 0; i < sizeof(T); ++i) b[i] = static_cast<unsigned char>(cursor[sizeof(T) - 1 - i]);
+            std::memcpy(&out, b, sizeof(T));
+        }
+        cursor += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool field(T& v) {
+        if constexpr (std::is_same<T, bool>::value || std::is_same<T, char>::value) {
+            if (cursor >= limit) return fail();
+            v = static_cast<T>(*cursor++);
+            return true;
+        } else if constexpr (std::is_floating_point<T>::value) {
+            return fixed(v);
+        } else if constexpr (std::is_integral<T>::value) {
+            uint64_t raw;
+            if (!varint(raw)) return false;
+            if constexpr (std::is_signed<T>::value) v = static_cast<T>(unzigzag(raw));
+            else v = static_cast<T>(raw);
+            return true;
+        } else if constexpr (IsStringField<T>::value) {
+            uint64_t n;
+            if (!varint(n)) return false;
+            if (static_cast<uint64_t>(limit - cursor) < n) return fail();
+            v = T(cursor, static_cast<size_t>(n));  // string_view: no copy
+            cursor += n;
+            return true;
+        } else if constexpr (IsStdArray<T>::value) {
+            using E = typename T::value_type;
+            if constexpr ((std::is_floating_point<E>::value || std::is_same<E, char>::value)
+                          && (HOST_LITTLE_ENDIAN || sizeof(E) == 1)) {
+                size_t bytes = sizeof(E) * v.size();
+                if (static_cast<size_t>(limit - cursor) < bytes) return fail();
+                std::memcpy(v.data(), cursor, bytes);
+                cursor += bytes;
+                return true;
+            } else {
+                for (auto& e : v) if (!field(e)) return false;
+                return true;
+            }
+        } else {
+            uint64_t n;
+            if (!varint(n)) return false;
+            if (static_cast<uint64_t>(limit - cursor) < n) return fail();
+            Reader inner(cursor, cursor + n);
+            if (!caseDecode(inner, v)) return fail();
+            cursor += n;
+            return true;
+        }
+    }
+
+private:
+    const char* cursor;
+    const char* limit;
+    bool failed = false;
+
+    bool fail() { failed = true; return false; }
+};
+
+// -----------------------------------------------------------------------------
+// Binary entry points
+// -----------------------------------------------------------------------------
+
+// Append one record to `out`; reuse `out` across calls to avoid reallocation
+template <typename T>
+void encodeTo(std::string& out, const T& value) {
+    size_t payload = caseEncodedSize(value);
+    size_t start = out.size();
+    out.resize(start + varintSize(payload) + payload);
+    Writer w(&out[start]);
+    w.varint(payload);
+    caseEncode(w, value);
+}
+
+template <typename T>
+std::string encode(const T& value) {
+    std::string out;
+    encodeTo(out, value);
+    return out;
+}
+
+// Decode one record from the front of `in`. Returns bytes consumed, 0 on error.
+// String fields of *View types point into `in`, which must outlive them.
+template <typename T>
+size_t decode(std::string_view in, T& value) {
+    Reader r(in.data(), in.data() + in.size());
+    if (!r.field(value)) return 0;
+    return static_cast<size_t>(r.position() - in.data());
+}
+
+// -----------------------------------------------------------------------------
+// JSON fallback
+// -----------------------------------------------------------------------------
+
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& dst) : out(dst) {}
+
+    void beginObject() { out += '{'; first = true; }
+    void endObject() { out += '}'; first = false; }
+
+    void key(const char* name) {
+        if (!first) out += ',';
+        first = false;
+        out += '"';
+        out += name;
+        out += "\":";
+    }
+
+    template <typename T>
+    void value(const T& v) {
+        if constexpr (std::is_same<T, bool>::value) {
+            out += v ? "true" : "false";
+        } else if constexpr (std::is_same<T, char>::value) {
+            string(std::string_view(&v, 1));
+        } else if constexpr (std::is_integral<T>::value) {
+            char buf[24];
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, r.ptr);
+        } else if constexpr (std::is_floating_point<T>::value) {
+            char buf[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+            // Shortest round-trip form
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, r.ptr);
+#else
+            int n = std::snprintf(buf, sizeof(buf), "%.17g", static_cast<double>(v));
+            out.append(buf, static_cast<size_t>(n));
+#endif
+        } else if constexpr (IsStringField<T>::value) {
+            string(v);
+        } else if constexpr (IsStdArray<T>::value) {
+            out += '[';
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (i) out += ',';
+                value(v[i]);
+            }
+            out += ']';
+        } else {
+            caseToJson(*this, v);
+        }
+    }
+
+private:
+    std::string& out;
+    bool first = true;
+
+    void string(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        size_t run = 0;  // Unescaped characters are appended in bulk
+        for (size_t i = 0; i < s.size(); ++i) {
+            char c = s[i];
+            if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) continue;
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hex[(c >> 4) & 0xF];
+                out += hex[c & 0xF];
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out += '"';
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view in) : cursor(in.data()), limit(in.data() + in.size()) {}
+
+    bool ok() const { return !failed; }
+
+    // Iterate the keys of an object: while (j.nextKey(k)) { ... }
+    bool beginObject() { return expect('{'); }
+    bool nextKey(std::string_view& key) {
+        skipSpace();
+        if (cursor < limit && *cursor == '}') { ++cursor; return false; }
+        if (!firstMember && !expect(',')) return false;
+        firstMember = false;
+        std::string k;
+        if (!parseString(k)) return false;
+        keyStorage = std::move(k);
+        key = keyStorage;
+        return expect(':');
+    }
+
+    template <typename T>
+    bool value(T& v) {
+        skipSpace();
+        if constexpr (std::is_same<T, bool>::value) {
+            if (match("true")) { v = true; return true; }
+            if (match("false")) { v = false; return true; }
+            return fail();
+        } else if constexpr (std::is_same<T, char>::value) {
+            std::string s;
+            if (!parseString(s) || s.empty()) return fail();
+            v = s[0];
+            return true;
+        } else if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            auto r = std::from_chars(cursor, limit, v);
+            if (r.ec != std::errc()) return fail();
+            cursor = r.ptr;
+            return true;
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            return parseString(v);
+        } else if constexpr (IsStdArray<T>::value) {
+            if (!expect('[')) return false;
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (i && !expect(',')) return false;
+                if (!value(v[i])) return false;
+            }
+            return expect(']');
+        } else {
+            JsonReader inner(std::string_view(cursor, static_cast<size_t>(limit - cursor)));
+            if (!caseFromJson(inner, v)) return fail();
+            cursor = inner.cursor;
+            return true;
+        }
+    }
+
+    // Skip a value whose key the schema does not know
+    bool skipValue() {
+        skipSpace();
+        if (cursor >= limit) return fail();
+        if (*cursor == '"') { std::string s; return parseString(s); }
+        if (*cursor == '{' || *cursor == '[') {
+            int depth = 0;
+            bool inString = false;
+            for (; cursor < limit; ++cursor) {
+                char c = *cursor;
+                if (inString) {
+                    if (c == '\\') ++cursor;
+                    else if (c == '"') inString = false;
+                } else if (c == '"') inString = true;
+                else if (c == '{' || c == '[') ++depth;
+                else if ((c == '}' || c == ']') && --depth == 0) { ++cursor; return true; }
+            }
+            return fail();
+        }
+        while (cursor < limit && *cursor != ',' && *cursor != '}' && *cursor != ']') ++cursor;
+        return true;
+    }
+
+private:
+    const char* cursor;
+    const char* limit;
+    bool failed = false;
+    bool firstMember = true;
+    std::string keyStorage;
+
+    bool fail() { failed = true; return false; }
+
+    void skipSpace() {
+        while (cursor < limit && (*cursor == ' ' || *cursor == '\n' || *cursor == '\t' || *cursor == '\r')) ++cursor;
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if (cursor >= limit || *cursor != c) return fail();
+        ++cursor;
+        return true;
+    }
+
+    bool match(const char* word) {
+        size_t n = std::strlen(word);
+        if (static_cast<size_t>(limit - cursor) < n || std::memcmp(cursor, word, n) != 0) return false;
+        cursor += n;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (!expect('"')) return false;
+        out.clear();
+        while (cursor < limit && *cursor != '"') {
+            char c = *cursor++;
+            if (c != '\\') { out += c; continue; }
+            if (cursor >= limit) return fail();
+            char e = *cursor++;
+            switch (e) {
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (limit - cursor < 4) return fail();
+                unsigned code = 0;
+                auto r = std::from_chars(cursor, cursor + 4, code, 16);
+                if (r.ptr != cursor + 4) return fail();
+                cursor += 4;
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: out += e; break;
+            }
+        }
+        if (cursor >= limit) return fail();
+        ++cursor;
+        return true;
+    }
+};
+
+template <typename T>
+std::string toJson(const T& value) {
+    std::string out;
+    out.reserve(128);
+    JsonWriter j(out);
+    j.value(value);
+    return out;
+}
+
+template <typename T>
+bool fromJson(std::string_view in, T& value) {
+    JsonReader j(in);
+    return j.value(value) && j.ok();
+}
+
+} // namespace Serial
+} // namespace CaseRuntime
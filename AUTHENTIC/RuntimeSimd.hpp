@@ -0,0 +1,279 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: SIMD Dispatch & Collection Kernels
+//  Run-time ISA selection shared by the numeric runtime headers, and the
+//  in-place kernels behind `scale`, `bounds` and `mutate`.
+//
+//  A scalar target is updated exactly as before. An array, vector, list or
+//  matrix target is updated element by element in one pass: hand-written
+//  AVX2/SSE2 loops for doubles, a block loop the compiler vectorizes (built
+//  once per ISA) for other element types. Long arrays are split across the
+//  thread pool. Nested collections recurse down to their scalars.
+//=============================================================================
+
+#pragma once
+#include "RuntimeHardware.hpp"
+#include "RuntimeParallel.hpp"
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CASE_RUNTIME_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(CASE_RUNTIME_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CASE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CASE_TARGET_AVX2_NOFMA __attribute__((target("avx2")))
+#else
+#define CASE_TARGET_AVX2
+#define CASE_TARGET_AVX2_NOFMA
+#endif
+
+namespace CaseRuntime {
+
+enum class Isa { Generic, Sse2, Avx2 };
+
+inline Isa activeIsa() {
+    static const Isa isa = [] {
+#if defined(CASE_RUNTIME_X86)
+        auto hw = detectHardware();
+        if (hw.hasAVX2) return Isa::Avx2;
+        return Isa::Sse2;
+#else
+        return Isa::Generic;
+#endif
+    }();
+    return isa;
+}
+
+namespace SimdKernels {
+
+// These passes are memory bound; below this many elements waking the pool
+// costs more than it saves
+constexpr size_t PARALLEL_ELEMENTS = size_t(1) << 18;
+constexpr size_t BLOCK = 16;
+
+#if defined(CASE_RUNTIME_X86)
+CASE_TARGET_AVX2
+inline size_t scaleAvx2(double* p, size_t n, double factor) {
+    __m256d f = _mm256_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(p + i, _mm256_mul_pd(_mm256_loadu_pd(p + i), f));
+        _mm256_storeu_pd(p + i + 4, _mm256_mul_pd(_mm256_loadu_pd(p + i + 4), f));
+    }
+    return i;
+}
+
+inline size_t scaleSse2(double* p, size_t n, double factor) {
+    __m128d f = _mm_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(p + i, _mm_mul_pd(_mm_loadu_pd(p + i), f));
+        _mm_storeu_pd(p + i + 2, _mm_mul_pd(_mm_loadu_pd(p + i + 2), f));
+    }
+    return i;
+}
+
+// max(low, x) then min(high, .) passes NaN through, like the scalar
+// compare-and-assign it replaces
+CASE_TARGET_AVX2
+inline size_t clampAvx2(double* p, size_t n, double low, double high) {
+    __m256d lo = _mm256_set1_pd(low), hi = _mm256_set1_pd(high);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d x0 = _mm256_loadu_pd(p + i), x1 = _mm256_loadu_pd(p + i + 4);
+        _mm256_storeu_pd(p + i, _mm256_min_pd(hi, _mm256_max_pd(lo, x0)));
+        _mm256_storeu_pd(p + i + 4, _mm256_min_pd(hi, _mm256_max_pd(lo, x1)));
+    }
+    return i;
+}
+
+inline size_t clampSse2(double* p, size_t n, double low, double high) {
+    __m128d lo = _mm_set1_pd(low), hi = _mm_set1_pd(high);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d x0 = _mm_loadu_pd(p + i), x1 = _mm_loadu_pd(p + i + 2);
+        _mm_storeu_pd(p + i, _mm_min_pd(hi, _mm_max_pd(lo, x0)));
+        _mm_storeu_pd(p + i + 2, _mm_min_pd(hi, _mm_max_pd(lo, x1)));
+    }
+    return i;
+}
+#endif
+
+// Fixed-length inner loop: -O2's cheap vectorizer cost model only takes
+// loops whose trip count it knows
+template <typename T, typename F>
+inline void transformBlocks(T* p, size_t n, const F& f) {
+    size_t i = 0;
+    for (; i + BLOCK <= n; i += BLOCK) {
+        for (size_t k = 0; k < BLOCK; ++k) p[i + k] = static_cast<T>(f(p[i + k]));
+    }
+    for (; i < n; ++i) p[i] = static_cast<T>(f(p[i]));
+}
+
+#if defined(CASE_RUNTIME_X86)
+// Same loop built for AVX2; f inlines into it and is vectorized 256 bits wide.
+// FMA stays off so a*b+c rounds exactly as the scalar expression does.
+template <typename T, typename F>
+CASE_TARGET_AVX2_NOFMA
+inline void transformBlocksAvx2(T* p, size_t n, const F& f) {
+    size_t i = 0;
+    for (; i + BLOCK <= n; i += BLOCK) {
+        for (size_t k = 0; k < BLOCK; ++k) p[i + k] = static_cast<T>(f(p[i + k]));
+    }
+    for (; i < n; ++i) p[i] = static_cast<T>(f(p[i]));
+}
+#endif
+
+// p[i] = f(p[i]) for every element
+template <typename T, typename F>
+inline void transform(T* p, size_t n, const F& f) {
+    parallelFor(0, n, PARALLEL_ELEMENTS, [&](size_t lo, size_t hi) {
+#if defined(CASE_RUNTIME_X86)
+        if (activeIsa() == Isa::Avx2) {
+            transformBlocksAvx2(p + lo, hi - lo, f);
+            return;
+        }
+#endif
+        transformBlocks(p + lo, hi - lo, f);
+    });
+}
+
+inline void scale(double* p, size_t n, double factor) {
+    parallelFor(0, n, PARALLEL_ELEMENTS, [&](size_t lo, size_t hi) {
+        size_t done = 0;
+#if defined(CASE_RUNTIME_X86)
+        done = (activeIsa() == Isa::Avx2) ? scaleAvx2(p + lo, hi - lo, factor) : scaleSse2(p + lo, hi - lo, factor);
+#endif
+        for (size_t i = lo + done; i < hi; ++i) p[i] *= factor;
+    });
+}
+
+inline void clamp(double* p, size_t n, double low, double high) {
+    parallelFor(0, n, PARALLEL_ELEMENTS, [&](size_t lo, size_t hi) {
+        size_t done = 0;
+#if defined(CASE_RUNTIME_X86)
+        done = (activeIsa() == Isa::Avx2) ? clampAvx2(p + lo, hi - lo, low, high)
+                                          : clampSse2(p + lo, hi - lo, low, high);
+#endif
+        for (size_t i = lo + done; i < hi; ++i) {
+            if (p[i] < low) p[i] = low;
+            if (p[i] > high) p[i] = high;
+        }
+    });
+}
+
+} // namespace SimdKernels
+
+// -----------------------------------------------------------------------------
+// Target classification
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+template <typename T, typename = void>
+struct IsText : std::false_type {};
+template <typename T>
+struct IsText<T, std::void_t<typename T::traits_type>> : std::true_type {};
+
+template <typename T, typename = void>
+struct IsContiguous : std::false_type {};
+template <typename T>
+struct IsContiguous<T, std::void_t<decltype(std::data(std::declval<T&>())),
+                                   decltype(std::size(std::declval<T&>()))>> : std::true_type {};
+
+template <typename T, typename = void>
+struct IsRange : std::false_type {};
+template <typename T>
+struct IsRange<T, std::void_t<decltype(std::begin(std::declval<T&>())),
+                              decltype(std::end(std::declval<T&>()))>> : std::true_type {};
+
+// Updated per element: arrays, vectors, lists, matrices -- strings stay whole
+template <typename T>
+constexpr bool isCollection = (IsContiguous<T>::value || IsRange<T>::value) && !IsText<T>::value;
+
+template <typename T, bool = IsContiguous<T>::value>
+struct FlatElement { using type = void; };
+template <typename T>
+struct FlatElement<T, true> { using type = std::remove_pointer_t<decltype(std::data(std::declval<T&>()))>; };
+
+// Contiguous writable storage of plain numbers: the SIMD kernels apply
+template <typename T>
+constexpr bool isFlatNumeric = isCollection<T> && std::is_arithmetic_v<typename FlatElement<T>::type> &&
+                               !std::is_const_v<typename FlatElement<T>::type>;
+
+template <typename T, typename F>
+inline void forEachElement(T& target, F&& f) {
+    if constexpr (IsContiguous<T>::value) {
+        auto* p = std::data(target);
+        for (size_t i = 0, n = std::size(target); i < n; ++i) f(p[i]);
+    } else {
+        for (auto& element : target) f(element);
+    }
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Operations used by generated code
+// -----------------------------------------------------------------------------
+
+// scale target factor
+template <typename T, typename F>
+inline void scaleInPlace(T& target, const F& factor) {
+    if constexpr (detail::isFlatNumeric<T>) {
+        using E = typename detail::FlatElement<T>::type;
+        if constexpr (std::is_same_v<E, double>) {
+            SimdKernels::scale(std::data(target), std::size(target), static_cast<double>(factor));
+        } else {
+            SimdKernels::transform(std::data(target), std::size(target), [&factor](E x) { return x * factor; });
+        }
+    } else if constexpr (detail::isCollection<T>) {
+        detail::forEachElement(target, [&](auto& element) { scaleInPlace(element, factor); });
+    } else {
+        target *= factor;
+    }
+}
+
+// bounds target low high
+template <typename T, typename L, typename H>
+inline void clampInPlace(T& target, const L& low, const H& high) {
+    if constexpr (detail::isFlatNumeric<T>) {
+        using E = typename detail::FlatElement<T>::type;
+        if constexpr (std::is_same_v<E, double>) {
+            SimdKernels::clamp(std::data(target), std::size(target), static_cast<double>(low),
+                               static_cast<double>(high));
+        } else {
+            SimdKernels::transform(std::data(target), std::size(target), [&](E x) {
+                if (x < low) x = static_cast<E>(low);
+                if (x > high) x = static_cast<E>(high);
+                return x;
+            });
+        }
+    } else if constexpr (detail::isCollection<T>) {
+        detail::forEachElement(target, [&](auto& element) { clampInPlace(element, low, high); });
+    } else {
+        if (target < low) target = low;
+        if (target > high) target = high;
+    }
+}
+
+// mutate target <expr>: `f` is the expression with the target's name bound
+// to one element, so a collection is transformed elementwise. Long numeric
+// arrays are transformed in parallel; the expression must not depend on
+// evaluation order.
+template <typename T, typename F>
+inline void mutateInPlace(T& target, const F& f) {
+    if constexpr (detail::isFlatNumeric<T>) {
+        SimdKernels::transform(std::data(target), std::size(target), f);
+    } else if constexpr (detail::isCollection<T>) {
+        detail::forEachElement(target, [&](auto& element) { mutateInPlace(element, f); });
+    } else {
+        target = f(target);
+    }
+}
+
+} // namespace CaseRuntime
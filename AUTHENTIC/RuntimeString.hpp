@@ -0,0 +1,433 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Strings
+//  The str_* functions the string keywords lower to (length, substr, concat,
+//  join, split, find, replace, upper, lower, trim).
+//
+//  Inputs are taken as std::string_view, so literals, strings and views all
+//  work without copies. `split` returns views into its source; given a
+//  temporary std::string it returns owned strings instead. `upper`, `lower`
+//  and `trim` on a temporary std::string reuse its buffer. Every other result
+//  is sized once before it is written.
+//
+//  Byte scans (substring search, delimiter counting, ASCII case mapping,
+//  whitespace trimming) have AVX2 and SSE2 paths picked at run time.
+//=============================================================================
+
+#pragma once
+#include "RuntimeSimd.hpp"
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace CaseRuntime {
+namespace StringKernels {
+
+constexpr size_t NOT_FOUND = std::string_view::npos;
+
+#if defined(CASE_RUNTIME_X86)
+// Substring search: compare the needle's first and last bytes against 32
+// (16) consecutive positions at once and memcmp only where both match.
+// Needle length must be >= 2. On a miss `scanned` is where the scalar tail
+// has to resume.
+CASE_TARGET_AVX2
+inline size_t findAvx2(const char* s, size_t n, const char* needle, size_t m, size_t& scanned) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    scanned = i;
+    return NOT_FOUND;
+}
+
+inline size_t findSse2(const char* s, size_t n, const char* needle, size_t m, size_t& scanned) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    scanned = i;
+    return NOT_FOUND;
+}
+
+CASE_TARGET_AVX2
+inline size_t countByteAvx2(const char* s, size_t n, char c, size_t& scanned) {
+    const __m256i v = _mm256_set1_epi8(c);
+    size_t count = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        count += static_cast<size_t>(__builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v)))));
+    }
+    scanned = i;
+    return count;
+}
+
+inline size_t countByteSse2(const char* s, size_t n, char c, size_t& scanned) {
+    const __m128i v = _mm_set1_epi8(c);
+    size_t count = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        count += static_cast<size_t>(__builtin_popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, v)))));
+    }
+    scanned = i;
+    return count;
+}
+
+// Bytes in [from, from + 26) get bit 0x20 flipped. Adding (128 - from) moves
+// that range to the bottom of the signed byte range, so one signed compare
+// finds it; bytes >= 0x80 (UTF-8) never match.
+CASE_TARGET_AVX2
+inline size_t mapCaseAvx2(const char* src, char* dst, size_t n, char from) {
+    const __m256i shift = _mm256_set1_epi8(static_cast<char>(128 - from));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i inRange = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(x, shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(x, _mm256_and_si256(inRange, flip)));
+    }
+    return i;
+}
+
+inline size_t mapCaseSse2(const char* src, char* dst, size_t n, char from) {
+    const __m128i shift = _mm_set1_epi8(static_cast<char>(128 - from));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i inRange = _mm_cmpgt_epi8(limit, _mm_add_epi8(x, shift));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(x, _mm_and_si128(inRange, flip)));
+    }
+    return i;
+}
+
+// Whitespace mask of 16 bytes: ' ' or '\t'..'\r' (same range trick as above)
+inline uint32_t spaceMaskSse2(const char* p) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i ctrl = _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(-128 + 5)),
+                                  _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(128 - '\t'))));
+    __m128i space = _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(ctrl, space)));
+}
+
+CASE_TARGET_AVX2
+inline uint32_t spaceMaskAvx2(const char* p) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i ctrl = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 5)),
+                                     _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(128 - '\t'))));
+    __m256i space = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(ctrl, space)));
+}
+#endif
+
+inline bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// First occurrence of needle in s at or after `from`
+inline size_t find(std::string_view s, std::string_view needle, size_t from = 0) {
+    if (from > s.size()) return NOT_FOUND;
+    size_t m = needle.size();
+    if (m == 0) return from;
+    if (m > s.size() - from) return NOT_FOUND;
+    if (m == 1) {
+        const void* hit = std::memchr(s.data() + from, needle[0], s.size() - from);  // libc memchr is vectorized
+        return hit ? static_cast<size_t>(static_cast<const char*>(hit) - s.data()) : NOT_FOUND;
+    }
+    size_t scanned = 0;
+#if defined(CASE_RUNTIME_X86)
+    const char* base = s.data() + from;
+    size_t n = s.size() - from;
+    size_t hit = (activeIsa() == Isa::Avx2) ? findAvx2(base, n, needle.data(), m, scanned)
+                                            : findSse2(base, n, needle.data(), m, scanned);
+    if (hit != NOT_FOUND) return from + hit;
+#endif
+    return s.find(needle, from + scanned);
+}
+
+inline size_t countByte(std::string_view s, char c) {
+    size_t count = 0, scanned = 0;
+#if defined(CASE_RUNTIME_X86)
+    count = (activeIsa() == Isa::Avx2) ? countByteAvx2(s.data(), s.size(), c, scanned)
+                                       : countByteSse2(s.data(), s.size(), c, scanned);
+#endif
+    for (size_t i = scanned; i < s.size(); ++i) count += (s[i] == c);
+    return count;
+}
+
+// ASCII case mapping of n bytes; src may equal dst
+inline void mapCase(const char* src, char* dst, size_t n, bool toUpper) {
+    const char from = toUpper ? 'a' : 'A';
+    size_t i = 0;
+#if defined(CASE_RUNTIME_X86)
+    i = (activeIsa() == Isa::Avx2) ? mapCaseAvx2(src, dst, n, from) : mapCaseSse2(src, dst, n, from);
+#endif
+    for (; i < n; ++i) {
+        char c = src[i];
+        dst[i] = (c >= from && c < from + 26) ? static_cast<char>(c ^ 0x20) : c;
+    }
+}
+
+// [begin, end) of s without leading and trailing whitespace
+inline std::pair<size_t, size_t> trimBounds(std::string_view s) {
+    const char* p = s.data();
+    size_t begin = 0, end = s.size();
+#if defined(CASE_RUNTIME_X86)
+    const bool avx2 = activeIsa() == Isa::Avx2;
+    const size_t width = avx2 ? 32 : 16;
+    const uint32_t all = avx2 ? 0xFFFFFFFFu : 0xFFFFu;
+    while (end - begin >= width) {
+        uint32_t mask = avx2 ? spaceMaskAvx2(p + begin) : spaceMaskSse2(p + begin);
+        if (mask != all) {
+            begin += static_cast<size_t>(__builtin_ctz(~mask));
+            break;
+        }
+        begin += width;
+    }
+    while (end - begin >= width) {
+        uint32_t mask = avx2 ? spaceMaskAvx2(p + end - width) : spaceMaskSse2(p + end - width);
+        if (mask != all) {
+            uint32_t keep = ~mask & all;
+            end -= width - 1 - static_cast<size_t>(31 - __builtin_clz(keep));
+            return {begin, end};
+        }
+        end -= width;
+    }
+#endif
+    while (begin < end && isSpace(p[begin])) ++begin;
+    while (end > begin && isSpace(p[end - 1])) --end;
+    return {begin, end};
+}
+
+} // namespace StringKernels
+
+namespace detail {
+
+// Enables the overloads that take ownership of a temporary std::string
+template <typename S>
+using IfOwnedString = std::enable_if_t<std::is_same<S, std::string>::value, int>;
+
+// One concat operand as text; numbers are formatted into the local buffer
+class TextPiece {
+public:
+    template <typename T>
+    TextPiece(const T& v) {
+        if constexpr (std::is_same<T, char>::value) {
+            buf[0] = v;
+            text = std::string_view(buf, 1);
+        } else if constexpr (std::is_same<T, bool>::value) {
+            text = v ? "true" : "false";
+        } else if constexpr (std::is_integral<T>::value) {
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            text = std::string_view(buf, static_cast<size_t>(r.ptr - buf));
+        } else if constexpr (std::is_floating_point<T>::value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            text = std::string_view(buf, static_cast<size_t>(r.ptr - buf));
+#else
+            int n = std::snprintf(buf, sizeof(buf), "%g", static_cast<double>(v));
+            text = std::string_view(buf, static_cast<size_t>(n));
+#endif
+        } else {
+            text = std::string_view(v);
+        }
+    }
+    TextPiece(const TextPiece&) = delete;
+    TextPiece& operator=(const TextPiece&) = delete;
+
+    std::string_view view() const { return text; }
+
+private:
+    char buf[32];
+    std::string_view text;
+};
+
+template <typename Out, typename Emit>
+inline void splitInto(std::string_view s, std::string_view delim, Out& parts, Emit emit) {
+    if (delim.empty()) {
+        // No delimiter: whitespace-separated fields
+        size_t i = 0;
+        while (i < s.size()) {
+            while (i < s.size() && StringKernels::isSpace(s[i])) ++i;
+            size_t start = i;
+            while (i < s.size() && !StringKernels::isSpace(s[i])) ++i;
+            if (i > start) emit(parts, s.substr(start, i - start));
+        }
+        return;
+    }
+    if (delim.size() == 1) parts.reserve(StringKernels::countByte(s, delim[0]) + 1);
+    size_t start = 0;
+    for (size_t at; (at = StringKernels::find(s, delim, start)) != StringKernels::NOT_FOUND;
+         start = at + delim.size()) {
+        emit(parts, s.substr(start, at - start));
+    }
+    emit(parts, s.substr(start));
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Operations used by generated code
+// -----------------------------------------------------------------------------
+
+inline size_t str_length(std::string_view s) {
+    return s.size();
+}
+
+// substr text start length; out-of-range parts are clipped
+inline std::string str_substr(std::string_view s, long long start, long long length = -1) {
+    size_t from = start < 0 ? 0 : static_cast<size_t>(start);
+    if (from >= s.size()) return std::string();
+    size_t count = length < 0 ? std::string_view::npos : static_cast<size_t>(length);
+    return std::string(s.substr(from, count));
+}
+
+// concat a b ...: strings, characters and numbers, sized once
+template <typename... Parts>
+inline std::string str_concat(const Parts&... parts) {
+    const detail::TextPiece pieces[] = {detail::TextPiece(parts)...};
+    size_t total = 0;
+    for (const auto& p : pieces) total += p.view().size();
+    std::string out;
+    out.reserve(total);
+    for (const auto& p : pieces) out.append(p.view().data(), p.view().size());
+    return out;
+}
+
+inline std::string str_concat() {
+    return std::string();
+}
+
+// join parts separator
+template <typename Parts>
+inline std::string str_join(const Parts& parts, std::string_view separator = {}) {
+    size_t total = 0, count = 0;
+    for (const auto& p : parts) {
+        total += std::string_view(p).size();
+        ++count;
+    }
+    if (count > 1) total += separator.size() * (count - 1);
+    std::string out;
+    out.reserve(total);
+    bool first = true;
+    for (const auto& p : parts) {
+        if (!first) out.append(separator.data(), separator.size());
+        std::string_view v(p);
+        out.append(v.data(), v.size());
+        first = false;
+    }
+    return out;
+}
+
+// split text delimiter: views into `s`, which must outlive the result.
+// An empty delimiter splits on runs of whitespace.
+inline std::vector<std::string_view> str_split(std::string_view s, std::string_view delimiter = {}) {
+    std::vector<std::string_view> parts;
+    detail::splitInto(s, delimiter, parts, [](auto& out, std::string_view v) { out.push_back(v); });
+    return parts;
+}
+
+// A temporary source cannot be viewed into; its pieces are copied out
+template <typename S, detail::IfOwnedString<S> = 0>
+inline std::vector<std::string> str_split(S&& s, std::string_view delimiter = {}) {
+    std::vector<std::string> parts;
+    detail::splitInto(s, delimiter, parts, [](auto& out, std::string_view v) { out.emplace_back(v); });
+    return parts;
+}
+
+// find text needle: position of the first match, or -1
+inline long long str_find(std::string_view s, std::string_view needle) {
+    size_t at = StringKernels::find(s, needle);
+    return at == StringKernels::NOT_FOUND ? -1 : static_cast<long long>(at);
+}
+
+// replace text old new: every non-overlapping occurrence, left to right
+inline std::string str_replace(std::string_view s, std::string_view from, std::string_view to) {
+    size_t at = from.empty() ? StringKernels::NOT_FOUND : StringKernels::find(s, from);
+    if (at == StringKernels::NOT_FOUND) return std::string(s);
+
+    std::string out;
+    if (to.size() <= from.size()) {
+        out.reserve(s.size());
+    } else {
+        // Growing: count matches first so the result is sized once
+        size_t matches = 0;
+        for (size_t pos = at; pos != StringKernels::NOT_FOUND; pos = StringKernels::find(s, from, pos + from.size())) {
+            ++matches;
+        }
+        out.reserve(s.size() + matches * (to.size() - from.size()));
+    }
+    size_t start = 0;
+    for (; at != StringKernels::NOT_FOUND; at = StringKernels::find(s, from, start)) {
+        out.append(s.data() + start, at - start);
+        out.append(to.data(), to.size());
+        start = at + from.size();
+    }
+    out.append(s.data() + start, s.size() - start);
+    return out;
+}
+
+inline std::string str_upper(std::string_view s) {
+    std::string out(s.size(), '\0');
+    StringKernels::mapCase(s.data(), &out[0], s.size(), true);
+    return out;
+}
+
+template <typename S, detail::IfOwnedString<S> = 0>
+inline std::string str_upper(S&& s) {
+    StringKernels::mapCase(s.data(), &s[0], s.size(), true);
+    return std::move(s);
+}
+
+inline std::string str_lower(std::string_view s) {
+    std::string out(s.size(), '\0');
+    StringKernels::mapCase(s.data(), &out[0], s.size(), false);
+    return out;
+}
+
+template <typename S, detail::IfOwnedString<S> = 0>
+inline std::string str_lower(S&& s) {
+    StringKernels::mapCase(s.data(), &s[0], s.size(), false);
+    return std::move(s);
+}
+
+inline std::string str_trim(std::string_view s) {
+    auto bounds = StringKernels::trimBounds(s);
+    return std::string(s.substr(bounds.first, bounds.second - bounds.first));
+}
+
+template <typename S, detail::IfOwnedString<S> = 0>
+inline std::string str_trim(S&& s) {
+    auto bounds = StringKernels::trimBounds(s);
+    s.erase(bounds.second);
+    s.erase(0, bounds.first);
+    return std::move(s);
+}
+
+} // namespace CaseRuntime
@@ -0,0 +1,31 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime: Output Across Threads
+//  Print output is buffered per thread (RuntimePrint.hpp). Whatever starts
+//  other threads -- `parallel`, `thread`, `async`, the ThreadPool -- first
+//  hands the caller's buffered lines to stdout, and pool workers hand theirs
+//  over before run() returns, so piped output keeps program order. Kept
+//  apart from RuntimePrint.hpp so the thread code need not pull in the
+//  formatter.
+//=============================================================================
+
+#pragma once
+#include <atomic>
+
+namespace CaseRuntime {
+
+namespace detail {
+
+// Installed by initOutput() when the program prints; null otherwise
+inline std::atomic<void (*)()>& threadOutputFlush() {
+    static std::atomic<void (*)()> flush{nullptr};
+    return flush;
+}
+
+} // namespace detail
+
+// Writes out the calling thread's buffered Print lines
+inline void flushThreadOutput() {
+    if (auto flush = detail::threadOutputFlush().load(std::memory_order_acquire)) flush();
+}
+
+} // namespace CaseRuntime
@@ -0,0 +1,388 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Type Inference Implementation
+//
+//  Forward dataflow over the whole program, repeated until nothing widens:
+//  literals give the base types, operators combine them, `let`, `mutate`,
+//  `scale` and `bounds` widen a variable, each call widens the callee's
+//  parameters with its argument types, and `ret` widens the result. Types
+//  only grow (Int -> Float -> Other), so the loop ends after a few rounds.
+//
+//  Variables with no such source -- `input` targets, parameters of
+//  functions only ever called with those -- then take the type their uses
+//  ask for, and the flow runs again from there.
+//=============================================================================
+
+#include "TypeInference.hpp"
+#include <cctype>
+
+namespace {
+
+// More rounds than any chain of calls in a real program needs; a pass that
+// still changes after this keeps whatever is generic
+constexpr int MAX_ROUNDS = 16;
+
+bool isNumeric(InferredType t) {
+    return t == InferredType::Int || t == InferredType::Float;
+}
+
+bool isScalar(InferredType t) {
+    return t != InferredType::Unknown && t != InferredType::Other;
+}
+
+InferredType literalType(const std::string& value) {
+    if (value.empty()) return InferredType::Unknown;
+    if (value[0] == '"') return InferredType::String;
+    if (value == "true" || value == "false") return InferredType::Bool;
+    bool digits = false, fraction = false;
+    for (size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            digits = true;
+        } else if (c == '.' || c == 'e' || c == 'E') {
+            fraction = true;
+        } else if (!((c == '-' || c == '+') && (i == 0 || value[i - 1] == 'e' || value[i - 1] == 'E'))) {
+            return InferredType::Other;
+        }
+    }
+    if (!digits) return InferredType::Other;
+    return fraction ? InferredType::Float : InferredType::Int;
+}
+
+bool isComparison(const std::string& op) {
+    return op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=" || op == "&&" ||
+           op == "||";
+}
+
+} // namespace
+
+InferredType TypeInference::join(InferredType a, InferredType b) {
+    if (a == InferredType::Unknown) return b;
+    if (b == InferredType::Unknown || a == b) return a;
+    if (isNumeric(a) && isNumeric(b)) return InferredType::Float;
+    return InferredType::Other;
+}
+
+std::string TypeInference::cppType(InferredType type) {
+    switch (type) {
+        case InferredType::Bool: return "bool";
+        case InferredType::Int: return "long long";
+        case InferredType::Float: return "double";
+        case InferredType::String: return "std::string";
+        default: return "";
+    }
+}
+
+void TypeInference::widen(InferredType& slot, InferredType evidence) {
+    InferredType joined = join(slot, evidence);
+    if (joined != slot) {
+        slot = joined;
+        changed = true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Driver
+// -----------------------------------------------------------------------------
+
+void TypeInference::run(NodePtr root) {
+    functions.clear();
+    globals.clear();
+
+    std::vector<NodePtr> topLevel;
+    if (auto block = std::dynamic_pointer_cast<Block>(root)) {
+        topLevel = block->statements;
+    } else if (root) {
+        topLevel.push_back(root);
+    }
+    for (auto& stmt : topLevel) {
+        if (auto fn = std::dynamic_pointer_cast<FunctionDecl>(stmt)) {
+            Signature& sig = functions[fn->name];
+            sig.decl = fn;
+            sig.params.assign(fn->paramNames.size(), InferredType::Unknown);
+            for (auto& name : fn->paramNames) sig.locals[name].open = true;
+        }
+    }
+
+    auto pass = [&] {
+        for (auto& entry : functions) {
+            Signature& sig = entry.second;
+            const auto& names = sig.decl->paramNames;
+            for (size_t i = 0; i < names.size(); ++i) {
+                widen(sig.locals[names[i]].type, sig.params[i]);
+            }
+            if (sig.decl->body) visit(sig.decl->body, sig.locals, &sig);
+            // A parameter the body widens (mutate n n * 0.5) widens the signature
+            for (size_t i = 0; i < names.size(); ++i) {
+                widen(sig.params[i], sig.locals[names[i]].type);
+            }
+        }
+        for (auto& stmt : topLevel) {
+            if (!std::dynamic_pointer_cast<FunctionDecl>(stmt)) visit(stmt, globals, nullptr);
+        }
+    };
+    do {
+        for (int round = 0; round < MAX_ROUNDS; ++round) {
+            changed = false;
+            pass();
+            if (!changed) break;
+        }
+    } while (resolveDemands());
+
+    for (auto& entry : functions) {
+        Signature& sig = entry.second;
+        sig.decl->paramTypes.clear();
+        for (InferredType t : sig.params) sig.decl->paramTypes.push_back(cppType(t));
+        sig.decl->returnType = sig.returnsValue ? cppType(sig.result) : "void";
+        if (sig.decl->body) annotate(sig.decl->body, sig.locals);
+    }
+    for (auto& stmt : topLevel) {
+        if (!std::dynamic_pointer_cast<FunctionDecl>(stmt)) annotate(stmt, globals);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Statements
+// -----------------------------------------------------------------------------
+
+void TypeInference::visit(NodePtr node, Scope& scope, Signature* fn) {
+    if (!node) return;
+    if (auto block = std::dynamic_pointer_cast<Block>(node)) {
+        for (auto& stmt : block->statements) visit(stmt, scope, fn);
+    }
+    else if (auto varDecl = std::dynamic_pointer_cast<VarDecl>(node)) {
+        InferredType t = varDecl->initializer ? infer(varDecl->initializer, scope) : InferredType::Unknown;
+        widen(scope[varDecl->name].type, t);
+    }
+    else if (auto input = std::dynamic_pointer_cast<InputStmt>(node)) {
+        // A `let` before it fixes the type; otherwise usage decides
+        if (!scope.count(input->varName)) scope[input->varName].open = true;
+    }
+    else if (auto mutate = std::dynamic_pointer_cast<MutateStmt>(node)) {
+        auto found = scope.find(mutate->varName);
+        if (found != scope.end()) widen(found->second.type, infer(mutate->transformation, scope));
+    }
+    else if (auto scale = std::dynamic_pointer_cast<ScaleStmt>(node)) {
+        InferredType factor = scale->factor ? infer(scale->factor, scope) : InferredType::Int;
+        auto id = std::dynamic_pointer_cast<Identifier>(scale->target);
+        auto found = id ? scope.find(id->name) : scope.end();
+        if (found != scope.end() && isNumeric(found->second.type)) widen(found->second.type, factor);
+    }
+    else if (auto bounds = std::dynamic_pointer_cast<BoundsStmt>(node)) {
+        InferredType limits = join(infer(bounds->min, scope), infer(bounds->max, scope));
+        auto found = scope.find(bounds->varName);
+        if (found != scope.end() && isNumeric(found->second.type)) widen(found->second.type, limits);
+    }
+    else if (auto ret = std::dynamic_pointer_cast<ReturnStmt>(node)) {
+        InferredType t = ret->value ? infer(ret->value, scope) : InferredType::Unknown;
+        if (fn && ret->value) {
+            if (!fn->returnsValue) {
+                fn->returnsValue = true;
+                changed = true;
+            }
+            widen(fn->result, t);
+        }
+    }
+    else if (auto print = std::dynamic_pointer_cast<PrintStmt>(node)) {
+        infer(print->expr, scope);
+    }
+    else if (auto write = std::dynamic_pointer_cast<WriteStmt>(node)) {
+        infer(write->expr, scope);
+    }
+    else if (auto ifStmt = std::dynamic_pointer_cast<IfStmt>(node)) {
+        infer(ifStmt->condition, scope);
+        visit(ifStmt->thenBlock, scope, fn);
+        visit(ifStmt->elseBlock, scope, fn);
+    }
+    else if (auto whileStmt = std::dynamic_pointer_cast<WhileStmt>(node)) {
+        infer(whileStmt->condition, scope);
+        visit(whileStmt->block, scope, fn);
+    }
+    else if (auto loop = std::dynamic_pointer_cast<LoopStmt>(node)) {
+        visit(loop->block, scope, fn);
+    }
+    else if (auto switchStmt = std::dynamic_pointer_cast<SwitchStmt>(node)) {
+        infer(switchStmt->condition, scope);
+        for (auto& c : switchStmt->cases) visit(c.second, scope, fn);
+        visit(switchStmt->defaultBlock, scope, fn);
+    }
+    else if (auto thread = std::dynamic_pointer_cast<ThreadStmt>(node)) {
+        visit(thread->block, scope, fn);
+    }
+    else if (auto sync = std::dynamic_pointer_cast<SyncStmt>(node)) {
+        visit(sync->block, scope, fn);
+    }
+    else if (auto parallel = std::dynamic_pointer_cast<ParallelStmt>(node)) {
+        for (auto& task : parallel->tasks) visit(task, scope, fn);
+    }
+    // Nested Fn: a lambda that shares the enclosing scope; its `ret`s are its own
+    else if (auto nested = std::dynamic_pointer_cast<FunctionDecl>(node)) {
+        visit(nested->body, scope, nullptr);
+    }
+    else if (std::dynamic_pointer_cast<Expr>(node)) {
+        infer(node, scope);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Expressions
+// -----------------------------------------------------------------------------
+
+void TypeInference::demand(NodePtr expr, InferredType expected, Scope& scope) {
+    auto id = std::dynamic_pointer_cast<Identifier>(expr);
+    if (!id || !isScalar(expected)) return;
+    auto found = scope.find(id->name);
+    if (found != scope.end() && found->second.open) widen(found->second.demanded, expected);
+}
+
+bool TypeInference::resolveDemands() {
+    bool resolved = false;
+    auto settle = [&](Scope& scope) {
+        for (auto& entry : scope) {
+            Variable& v = entry.second;
+            if (v.open && v.type == InferredType::Unknown && v.demanded != InferredType::Unknown) {
+                v.type = v.demanded;
+                resolved = true;
+            }
+        }
+    };
+    settle(globals);
+    for (auto& entry : functions) settle(entry.second.locals);
+    return resolved;
+}
+
+InferredType TypeInference::infer(NodePtr expr, Scope& scope) {
+    if (!expr) return InferredType::Unknown;
+    if (auto lit = std::dynamic_pointer_cast<Literal>(expr)) {
+        return literalType(lit->value);
+    }
+    if (auto id = std::dynamic_pointer_cast<Identifier>(expr)) {
+        if (id->name == "true" || id->name == "false") return InferredType::Bool;
+        auto found = scope.find(id->name);
+        return found != scope.end() ? found->second.type : InferredType::Unknown;
+    }
+    if (auto bin = std::dynamic_pointer_cast<BinaryExpr>(expr)) {
+        InferredType left = infer(bin->left, scope);
+        InferredType right = infer(bin->right, scope);
+        if (isComparison(bin->op)) {
+            // num == 3 asks for a number, name == "x" for text
+            demand(bin->left, right, scope);
+            demand(bin->right, left, scope);
+            return InferredType::Bool;
+        }
+        // A value used in arithmetic is a number; decimals are not cut off,
+        // except by the operators C++ only has for integers
+        bool integral = bin->op == "%" || bin->op == "&" || bin->op == "|" || bin->op == "^" ||
+                        bin->op == "<<" || bin->op == ">>";
+        InferredType wanted = integral ? InferredType::Int : InferredType::Float;
+        if (isNumeric(right)) demand(bin->left, wanted, scope);
+        if (isNumeric(left)) demand(bin->right, wanted, scope);
+        if (left == InferredType::Unknown || right == InferredType::Unknown) return InferredType::Unknown;
+        if (bin->op == "+" && left == InferredType::String && right == InferredType::String) {
+            return InferredType::String;
+        }
+        if (isNumeric(left) && isNumeric(right)) {
+            if (integral) return InferredType::Int;
+            return join(left, right);
+        }
+        return InferredType::Other;
+    }
+    if (auto unary = std::dynamic_pointer_cast<UnaryExpr>(expr)) {
+        InferredType operand = infer(unary->operand, scope);
+        if (unary->op == "!") return InferredType::Bool;
+        if (unary->op == "~") {
+            demand(unary->operand, InferredType::Int, scope);
+            return InferredType::Int;
+        }
+        if (operand == InferredType::Unknown) demand(unary->operand, InferredType::Float, scope);
+        return operand;
+    }
+    if (auto call = std::dynamic_pointer_cast<CallExpr>(expr)) {
+        auto found = functions.find(call->callee);
+        for (size_t i = 0; i < call->args.size(); ++i) {
+            InferredType arg = infer(call->args[i], scope);
+            if (found == functions.end() || i >= found->second.params.size()) continue;
+            widen(found->second.params[i], arg);
+            demand(call->args[i], found->second.params[i], scope);
+        }
+        if (found == functions.end()) return InferredType::Other;
+        return found->second.returnsValue ? found->second.result : InferredType::Unknown;
+    }
+    if (auto math = std::dynamic_pointer_cast<MathCallExpr>(expr)) {
+        InferredType args = InferredType::Unknown;
+        for (auto& arg : math->args) {
+            args = join(args, infer(arg, scope));
+            demand(arg, InferredType::Float, scope);
+        }
+        // std::abs/min/max keep the argument type; the rest return double
+        if (math->function == "abs" || math->function == "min" || math->function == "max") return args;
+        return InferredType::Float;
+    }
+    if (auto str = std::dynamic_pointer_cast<StringCallExpr>(expr)) {
+        for (auto& arg : str->args) infer(arg, scope);
+        if (str->function == "length" || str->function == "find") return InferredType::Int;
+        if (str->function == "split") return InferredType::Other;
+        return InferredType::String;
+    }
+    if (auto coll = std::dynamic_pointer_cast<CollectionCallExpr>(expr)) {
+        infer(coll->collection, scope);
+        for (auto& arg : coll->args) infer(arg, scope);
+        return coll->function == "size" ? InferredType::Int : InferredType::Other;
+    }
+    if (auto list = std::dynamic_pointer_cast<ListExpr>(expr)) {
+        // Text literals become std::string (not const char*) and mixed
+        // integers and decimals widen to double
+        InferredType elements = InferredType::Unknown;
+        for (auto& element : list->elements) elements = join(elements, infer(element, scope));
+        list->elementType = cppType(elements);
+        return InferredType::Other;
+    }
+    if (std::dynamic_pointer_cast<PlaceholderExpr>(expr)) {
+        return InferredType::Unknown;
+    }
+    return InferredType::Other;
+}
+
+// -----------------------------------------------------------------------------
+// Writing the results back
+// -----------------------------------------------------------------------------
+
+void TypeInference::annotate(NodePtr node, Scope& scope) {
+    if (!node) return;
+    if (auto block = std::dynamic_pointer_cast<Block>(node)) {
+        for (auto& stmt : block->statements) annotate(stmt, scope);
+    }
+    else if (auto varDecl = std::dynamic_pointer_cast<VarDecl>(node)) {
+        std::string type = cppType(scope[varDecl->name].type);
+        varDecl->type = type.empty() ? "auto" : type;
+    }
+    else if (auto input = std::dynamic_pointer_cast<InputStmt>(node)) {
+        std::string type = cppType(scope[input->varName].type);
+        input->type = type.empty() ? "std::string" : type;
+    }
+    else if (auto ifStmt = std::dynamic_pointer_cast<IfStmt>(node)) {
+        annotate(ifStmt->thenBlock, scope);
+        annotate(ifStmt->elseBlock, scope);
+    }
+    else if (auto whileStmt = std::dynamic_pointer_cast<WhileStmt>(node)) {
+        annotate(whileStmt->block, scope);
+    }
+    else if (auto loop = std::dynamic_pointer_cast<LoopStmt>(node)) {
+        annotate(loop->block, scope);
+    }
+    else if (auto switchStmt = std::dynamic_pointer_cast<SwitchStmt>(node)) {
+        for (auto& c : switchStmt->cases) annotate(c.second, scope);
+        annotate(switchStmt->defaultBlock, scope);
+    }
+    else if (auto thread = std::dynamic_pointer_cast<ThreadStmt>(node)) {
+        annotate(thread->block, scope);
+    }
+    else if (auto sync = std::dynamic_pointer_cast<SyncStmt>(node)) {
+        annotate(sync->block, scope);
+    }
+    else if (auto parallel = std::dynamic_pointer_cast<ParallelStmt>(node)) {
+        for (auto& task : parallel->tasks) annotate(task, scope);
+    }
+    else if (auto nested = std::dynamic_pointer_cast<FunctionDecl>(node)) {
+        annotate(nested->body, scope);
+    }
+}
@@ -0,0 +1,59 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Type Inference
+//  Gives `let` variables, `input` targets and function signatures concrete
+//  C++ types so the emitted code is not `auto` and templates everywhere.
+//=============================================================================
+
+#pragma once
+#include "AST.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// What is known about a value. Unknown is "no evidence yet"; Other means
+// evidence that fits none of the scalar types (collections, matrices,
+// conflicting uses) and keeps the declaration generic.
+enum class InferredType { Unknown, Bool, Int, Float, String, Other };
+
+class TypeInference {
+public:
+    // Annotates the tree in place: VarDecl::type, InputStmt::type,
+    // FunctionDecl::paramTypes and FunctionDecl::returnType
+    void run(NodePtr root);
+
+    static InferredType join(InferredType a, InferredType b);
+    static std::string cppType(InferredType type);
+
+private:
+    struct Variable {
+        InferredType type = InferredType::Unknown;
+        // `input` targets and parameters: when nothing assigns them a type
+        // (no `let`, no typed call site) the uses decide -- `demanded` is
+        // what they ask for, e.g. Float for `celsius * 9`
+        bool open = false;
+        InferredType demanded = InferredType::Unknown;
+    };
+    using Scope = std::unordered_map<std::string, Variable>;
+
+    struct Signature {
+        std::shared_ptr<FunctionDecl> decl;
+        std::vector<InferredType> params;
+        InferredType result = InferredType::Unknown;
+        bool returnsValue = false;
+        Scope locals;
+    };
+
+    std::unordered_map<std::string, Signature> functions;
+    Scope globals;
+    // Set whenever a join widens something; the pass repeats until it stays false
+    bool changed = false;
+
+    void widen(InferredType& slot, InferredType evidence);
+    void visit(NodePtr node, Scope& scope, Signature* fn);
+    InferredType infer(NodePtr expr, Scope& scope);
+    // A use that needs `expected`: recorded on an open variable
+    void demand(NodePtr expr, InferredType expected, Scope& scope);
+    // Give open variables nobody assigned a type what their uses demand
+    bool resolveDemands();
+    void annotate(NodePtr node, Scope& scope);
+};
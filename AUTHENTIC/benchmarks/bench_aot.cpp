@@ -0,0 +1,91 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Benchmark: AOT vs Transpiled C++
+//  Builds one .case program (default factorial.case) twice, with
+//  --ciam-aot and through the transpiled C++ (--native), then runs each
+//  binary N times (default 200) and reports build time, binary size and
+//  the mean run. The two outputs must match. Run it from AUTHENTIC, where
+//  the runtime headers the C++ build includes live, with stdin at
+//  /dev/null so any `input` reads end of input.
+//
+//  Build: g++ -std=c++17 -O2 -I.. bench_aot.cpp ../ProcessRunner.cpp -o bench_aot
+//  Run:   benchmarks/bench_aot ./transpiler [program.case] [runs] < /dev/null
+//=============================================================================
+
+#include "ProcessRunner.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+
+struct Build {
+    const char* name;
+    std::string binary;
+    ProcessResult compile{};
+    long bytes = 0;
+    double runSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    long peakKb = 0;
+    std::string output{};
+};
+
+static long fileSize(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : -1;
+}
+
+static bool measure(Build& build, int runs) {
+    for (int i = 0; i < runs; ++i) {
+        ProcessResult run = runProcess({"./" + build.binary});
+        if (!run.ok()) {
+            std::fprintf(stderr, "  %s: run failed (%s)\n", build.name, describeRun(run).c_str());
+            return false;
+        }
+        build.runSeconds += run.wallSeconds;
+        build.cpuSeconds += run.cpuSeconds();
+        if (run.maxResidentKb > build.peakKb) build.peakKb = run.maxResidentKb;
+        build.output = run.output;
+    }
+    build.runSeconds /= runs;
+    build.cpuSeconds /= runs;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <transpiler> [program.case] [runs]\n", argv[0]);
+        return 2;
+    }
+    const std::string transpiler = argv[1];
+    const std::string program = (argc > 2) ? argv[2] : "factorial.case";
+    const int runs = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 200;
+
+    std::string base = program.substr(0, program.rfind('.'));
+    base = base.substr(base.find_last_of('/') + 1);
+
+    Build builds[2] = {{"aot", base + "_aot"}, {"c++", base}};
+    builds[0].compile = runProcess({transpiler, program, "--ciam-aot", "--no-run"});
+    builds[1].compile = runProcess({transpiler, program, "--native", "--no-run"});
+
+    std::fprintf(stderr, "C.A.S.E. AOT benchmark: %s, %d runs each\n", program.c_str(), runs);
+    for (Build& build : builds) {
+        build.bytes = fileSize(build.binary);
+        if (!build.compile.ok() || build.bytes < 0) {
+            std::fprintf(stderr, "  %s: build failed\n%s", build.name, build.compile.errors.c_str());
+            return 1;
+        }
+        if (!measure(build, runs)) return 1;
+        std::fprintf(stderr, "  %-4s build %6.3f s  binary %8ld bytes  run %8.3f ms (cpu %.3f ms, peak %.1f MB)\n",
+                     build.name, build.compile.wallSeconds, build.bytes, build.runSeconds * 1e3,
+                     build.cpuSeconds * 1e3, build.peakKb / 1024.0);
+    }
+    std::fprintf(stderr, "  aot: builds %.1fx faster, runs %.1fx faster, %.0f%% of the size\n",
+                 builds[1].compile.wallSeconds / builds[0].compile.wallSeconds,
+                 builds[1].runSeconds / builds[0].runSeconds, 100.0 * builds[0].bytes / builds[1].bytes);
+
+    if (builds[0].output != builds[1].output) {
+        std::fprintf(stderr, "  outputs differ\n");
+        return 1;
+    }
+    return 0;
+}
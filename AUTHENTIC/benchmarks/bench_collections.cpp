@@ -0,0 +1,109 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime Benchmark: Collections
+//  coll_sort against std::sort on N million (default 4) random ints and
+//  doubles, and a map/filter/reduce pipeline run through the lazy views
+//  against the same pipeline built from intermediate vectors. Results of
+//  both versions are compared.
+//
+//  Build: g++ -std=c++17 -O2 -I.. bench_collections.cpp -o bench_collections -pthread
+//  Run:   ./bench_collections [millions]
+//=============================================================================
+
+#include "RuntimeCollections.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace CaseRuntime;
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Fn>
+static double timeIt(int reps, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) fn();
+    return seconds(start) / reps;
+}
+
+static void report(const char* name, double naive, double runtime, bool ok) {
+    std::printf("  %-10s naive %9.2f ms  runtime %9.2f ms  %5.1fx  %s\n", name, naive * 1e3, runtime * 1e3,
+                naive / runtime, ok ? "ok" : "MISMATCH");
+}
+
+template <typename T>
+static bool sortCase(const char* name, const std::vector<T>& data) {
+    std::vector<T> a, b;
+    double naive = 0, rt = 0;
+    for (int r = 0; r < 3; ++r) {
+        a = data;
+        b = data;
+        naive += timeIt(1, [&] { std::sort(a.begin(), a.end()); });
+        rt += timeIt(1, [&] { coll_sort(b); });
+    }
+    bool ok = a == b;
+    report(name, naive / 3, rt / 3, ok);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    size_t millions = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 4;
+    const size_t n = millions * 1000000;
+    bool allOk = true;
+
+    std::mt19937_64 rng(42);
+    std::vector<long long> ints(n);
+    std::vector<double> doubles(n);
+    for (auto& v : ints) v = static_cast<long long>(rng() >> 1) - (1LL << 61);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    for (auto& v : doubles) v = dist(rng);
+
+    std::printf("C.A.S.E. runtime collection benchmark: %zu M elements, %zu threads\n", millions,
+                ThreadPool::instance().concurrency());
+
+    allOk &= sortCase("sort int", ints);
+    allOk &= sortCase("sort f64", doubles);
+
+    {
+        std::vector<long long> sorted = ints;
+        std::sort(sorted.begin(), sorted.end());
+        allOk &= sortCase("sorted", sorted);
+    }
+
+    // reduce (filter (map xs (* 3)) (% 2 == 0)) (+) 0
+    {
+        long long a = 0, b = 0;
+        double naive = timeIt(5, [&] {
+            std::vector<long long> mapped;
+            for (long long x : ints) mapped.push_back(x * 3);
+            std::vector<long long> kept;
+            for (long long x : mapped)
+                if (x % 2 == 0) kept.push_back(x);
+            a = 0;
+            for (long long x : kept) a += x;
+        });
+        double rt = timeIt(5, [&] {
+            b = coll_reduce(coll_filter(coll_map(ints, [](long long x) { return x * 3; }),
+                                        [](long long x) { return x % 2 == 0; }),
+                            [](long long acc, long long x) { return acc + x; }, 0LL);
+        });
+        report("pipeline", naive, rt, a == b);
+        allOk &= a == b;
+    }
+    // let ys = map xs (* 0.5 + 1)
+    {
+        std::vector<double> a, b;
+        double naive = timeIt(5, [&] {
+            a.clear();
+            for (double x : doubles) a.push_back(x * 0.5 + 1);
+        });
+        double rt = timeIt(5, [&] { b = coll_collect(coll_map(doubles, [](double x) { return x * 0.5 + 1; })); });
+        report("collect", naive, rt, a == b);
+        allOk &= a == b;
+    }
+    return allOk ? 0 : 1;
+}
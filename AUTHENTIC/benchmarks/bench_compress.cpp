@@ -0,0 +1,142 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime Benchmark: Compression
+//  Compresses and decompresses N MB (default 64) of log-style text and of
+//  random bytes in both modes, in one shot and through the chunked stream API,
+//  and verifies every round trip.
+//
+//  Build: g++ -std=c++17 -O2 -I.. bench_compress.cpp -o bench_compress
+//  Run:   ./bench_compress [megabytes] [path]
+//=============================================================================
+
+#include "RuntimeCompress.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+using namespace CaseRuntime;
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double mbps(size_t bytes, double secs) {
+    return bytes / (1024.0 * 1024.0) / secs;
+}
+
+static std::string makeText(size_t bytes) {
+    static const char* words[] = {
+        "sensor", "reading", "value", "status", "ok", "warning", "pressure", "temperature",
+        "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "request", "handled",
+        "latency", "ms", "cache", "miss", "hit", "thread", "queue", "flush", "buffer", "error"};
+    std::mt19937 rng(42);
+    std::string out;
+    out.reserve(bytes + 128);
+    for (size_t line = 0; out.size() < bytes; ++line) {
+        out += "2024-01-01T00:00:";
+        out += std::to_string(line % 60);
+        out += " [";
+        out += std::to_string(rng() % 16);
+        out += "]";
+        for (int w = 0; w < 8; ++w) {
+            out += ' ';
+            out += words[rng() % (sizeof(words) / sizeof(words[0]))];
+        }
+        out += " id=";
+        out += std::to_string(rng() % 100000);
+        out += '\n';
+    }
+    out.resize(bytes);
+    return out;
+}
+
+static std::string makeRandom(size_t bytes) {
+    std::mt19937_64 rng(7);
+    std::string out(bytes, '\0');
+    for (size_t i = 0; i + 8 <= bytes; i += 8) {
+        uint64_t v = rng();
+        std::memcpy(&out[i], &v, 8);
+    }
+    return out;
+}
+
+static bool run(const char* corpus, const std::string& input, Compress::Mode mode) {
+    const char* modeName = (mode == Compress::Mode::High) ? "high" : "fast";
+
+    auto start = std::chrono::steady_clock::now();
+    std::string packed = Compress::compress(input, mode);
+    double compressSecs = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    std::string unpacked = Compress::decompress(packed);
+    double decompressSecs = seconds(start);
+
+    bool ok = unpacked == input;
+    std::printf("  %-7s %-5s ratio %6.3f  compress %8.1f MB/s  decompress %8.1f MB/s  %s\n",
+                corpus, modeName, static_cast<double>(input.size()) / packed.size(),
+                mbps(input.size(), compressSecs), mbps(input.size(), decompressSecs),
+                ok ? "ok" : "ROUND TRIP FAILED");
+
+    // Chunked API with awkward chunk sizes must produce the same frame and data
+    std::string streamed;
+    Compress::Compressor c(mode, [&](std::string_view s) { streamed.append(s.data(), s.size()); });
+    for (size_t pos = 0, step = 1; pos < input.size(); pos += step, step = step * 3 + 7) {
+        c.write(std::string_view(input).substr(pos, step));
+    }
+    c.finish();
+    std::string restored;
+    Compress::Decompressor d([&](std::string_view s) { restored.append(s.data(), s.size()); });
+    for (size_t pos = 0, step = 1; pos < streamed.size(); pos += step, step = step % 9973 + 13) {
+        d.feed(std::string_view(streamed).substr(pos, step));
+    }
+    bool streamOk = streamed == packed && d.finished() && restored == input;
+    if (!streamOk) std::printf("    chunked stream round trip FAILED\n");
+    return ok && streamOk;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 64;
+    std::string path = (argc > 2) ? argv[2] : "bench_compress.tmp";
+    const size_t bytes = megabytes * 1024 * 1024;
+
+    std::printf("C.A.S.E. runtime compression benchmark: %zu MB per corpus\n", megabytes);
+
+    std::string text = makeText(bytes);
+    std::string random = makeRandom(bytes);
+    bool ok = true;
+    ok &= run("text", text, Compress::Mode::Fast);
+    ok &= run("text", text, Compress::Mode::High);
+    ok &= run("random", random, Compress::Mode::Fast);
+    ok &= run("random", random, Compress::Mode::High);
+
+    // File handles: mapped input -> buffered output, as `compress "lz4" src dst` lowers
+    {
+        { BufferedWriter w(path); w.write(text); }
+        std::string packedPath = path + ".clz";
+        auto start = std::chrono::steady_clock::now();
+        {
+            MappedReader in(path);
+            BufferedWriter out(packedPath);
+            Compress::compressStream(in, out, "lz4");
+        }
+        double secs = seconds(start);
+        start = std::chrono::steady_clock::now();
+        bool fileOk;
+        {
+            MappedReader in(packedPath);
+            BufferedWriter out(path);
+            fileOk = Compress::decompressStream(in, out, "lz4");
+        }
+        double dsecs = seconds(start);
+        MappedReader check(path);
+        fileOk = fileOk && check.contents() == text;
+        std::printf("  file    fast  compress %8.1f MB/s  decompress %8.1f MB/s  %s\n",
+                    mbps(bytes, secs), mbps(bytes, dsecs), fileOk ? "ok" : "ROUND TRIP FAILED");
+        ok &= fileOk;
+        std::remove(packedPath.c_str());
+        std::remove(path.c_str());
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime Benchmark: File I/O
+//  Writes and reads N bytes of lines (default 1 GB) through the generated-code
+//  runtime and through the old std::fstream + std::endl lowering.
+//
+//  Build: g++ -std=c++17 -O2 -I.. bench_io.cpp -o bench_io
+//  Run:   ./bench_io [megabytes] [path]
+//=============================================================================
+
+#include "RuntimeIO.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, size_t bytes, double secs) {
+    std::printf("  %-28s %8.3f s  %9.1f MB/s\n", name, secs, bytes / (1024.0 * 1024.0) / secs);
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    std::string path = (argc > 2) ? argv[2] : "bench_io.tmp";
+    const size_t target = megabytes * 1024 * 1024;
+
+    // ~64-byte log-style lines: "line <n> ....\n"
+    const std::string payload = " the quick brown fox jumps over the lazy dog 0123456789";
+    size_t lines = 0;
+    size_t bytes = 0;
+
+    std::printf("C.A.S.E. runtime I/O benchmark: %zu MB of lines\n", megabytes);
+
+    // Legacy lowering: std::fstream + std::endl (flush per line)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::fstream f(path, std::ios::out);
+        size_t written = 0;
+        for (size_t i = 0; written < target; ++i) {
+            f << i << payload << std::endl;
+            written += std::to_string(i).size() + payload.size() + 1;
+        }
+        f.close();
+        report("write fstream+endl", written, seconds(start));
+    }
+
+    // Runtime lowering: BufferedWriter + writeLine
+    {
+        auto start = std::chrono::steady_clock::now();
+        CaseRuntime::BufferedWriter f(path);
+        size_t written = 0;
+        for (size_t i = 0; written < target; ++i) {
+            CaseRuntime::write(f, i);
+            CaseRuntime::writeLine(f, payload);
+            written += std::to_string(i).size() + payload.size() + 1;
+            ++lines;
+        }
+        f.close();
+        bytes = written;
+        report("write BufferedWriter", written, seconds(start));
+    }
+
+    // Legacy read: std::fstream >> token
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::fstream f(path, std::ios::in);
+        std::string token;
+        size_t tokens = 0;
+        while (f >> token) ++tokens;
+        report("read fstream >>", bytes, seconds(start));
+        std::printf("    (%zu tokens)\n", tokens);
+    }
+
+    // Runtime read: MappedReader token scan
+    {
+        auto start = std::chrono::steady_clock::now();
+        CaseRuntime::MappedReader f(path);
+        std::string token;
+        size_t tokens = 0;
+        while (CaseRuntime::read(f, token)) ++tokens;
+        report("read MappedReader", bytes, seconds(start));
+        std::printf("    (%zu tokens)\n", tokens);
+    }
+
+    // Runtime read: MappedReader line scan (zero-copy views)
+    {
+        auto start = std::chrono::steady_clock::now();
+        CaseRuntime::MappedReader f(path);
+        size_t count = 0;
+        while (!f.eof()) {
+            f.nextLine();
+            ++count;
+        }
+        report("readline MappedReader", bytes, seconds(start));
+        std::printf("    (%zu lines, expected %zu)\n", count, lines);
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
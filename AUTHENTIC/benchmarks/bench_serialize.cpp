@@ -0,0 +1,179 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime Benchmark: Serialization
+//  Encodes and decodes N records (default 1M) with the struct codecs that
+//  CodeEmitter generates, against a raw memcpy baseline and the JSON path.
+//
+//  Build: g++ -std=c++17 -O2 -I.. bench_serialize.cpp -o bench_serialize
+//  Run:   ./bench_serialize [records]
+//=============================================================================
+
+#include "RuntimeSerialize.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// --- What CodeEmitter generates for:
+//     struct Reading { string sensor  int seq  double value  int[4] samples }
+struct Reading {
+  std::string sensor;
+  int seq;
+  double value;
+  std::array<int, 4> samples;
+};
+struct ReadingView {
+  std::string_view sensor;
+  int seq;
+  double value;
+  std::array<int, 4> samples;
+};
+inline size_t caseEncodedSize(const Reading& v) {
+  return 0 + CaseRuntime::Serial::sizeOf(v.sensor) + CaseRuntime::Serial::sizeOf(v.seq) + CaseRuntime::Serial::sizeOf(v.value) + CaseRuntime::Serial::sizeOf(v.samples);
+}
+inline void caseEncode(CaseRuntime::Serial::Writer& w, const Reading& v) {
+  w.field(v.sensor);
+  w.field(v.seq);
+  w.field(v.value);
+  w.field(v.samples);
+}
+inline bool caseDecode(CaseRuntime::Serial::Reader& r, Reading& v) {
+  return true && r.field(v.sensor) && r.field(v.seq) && r.field(v.value) && r.field(v.samples);
+}
+inline bool caseDecode(CaseRuntime::Serial::Reader& r, ReadingView& v) {
+  return true && r.field(v.sensor) && r.field(v.seq) && r.field(v.value) && r.field(v.samples);
+}
+inline void caseToJson(CaseRuntime::Serial::JsonWriter& j, const Reading& v) {
+  j.beginObject();
+  j.key("sensor"); j.value(v.sensor);
+  j.key("seq"); j.value(v.seq);
+  j.key("value"); j.value(v.value);
+  j.key("samples"); j.value(v.samples);
+  j.endObject();
+}
+inline bool caseFromJson(CaseRuntime::Serial::JsonReader& j, Reading& v) {
+  if (!j.beginObject()) return false;
+  std::string_view k;
+  while (j.nextKey(k)) {
+    bool ok = (k == "sensor") ? j.value(v.sensor) : (k == "seq") ? j.value(v.seq) : (k == "value") ? j.value(v.value) : (k == "samples") ? j.value(v.samples) : j.skipValue();
+    if (!ok) return false;
+  }
+  return j.ok();
+}
+// --- end of generated code
+
+// Fixed-layout baseline: what a raw memcpy of the record costs
+struct RawReading {
+  char sensor[16];
+  int seq;
+  double value;
+  int samples[4];
+};
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, size_t records, size_t bytes, double secs) {
+    std::printf("  %-26s %8.3f s  %7.2f M rec/s  %9.1f MB/s\n",
+                name, secs, records / 1e6 / secs, bytes / (1024.0 * 1024.0) / secs);
+}
+
+int main(int argc, char** argv) {
+    size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::vector<Reading> records(count);
+    for (size_t i = 0; i < count; ++i) {
+        Reading& r = records[i];
+        r.sensor = "sensor-" + std::to_string(i % 64);
+        r.seq = static_cast<int>(i);
+        r.value = static_cast<double>(i) * 0.25;
+        r.samples = {static_cast<int>(i & 0xff), -3, 1000, static_cast<int>(i % 7)};
+    }
+
+    std::printf("C.A.S.E. runtime serialization benchmark: %zu records\n", count);
+
+    // Baseline: memcpy of fixed-layout records
+    {
+        std::vector<RawReading> raw(count);
+        for (size_t i = 0; i < count; ++i) {
+            std::memset(&raw[i], 0, sizeof(RawReading));
+            std::memcpy(raw[i].sensor, records[i].sensor.data(), records[i].sensor.size());
+            raw[i].seq = records[i].seq;
+            raw[i].value = records[i].value;
+            std::memcpy(raw[i].samples, records[i].samples.data(), sizeof(raw[i].samples));
+        }
+        std::string out(count * sizeof(RawReading), '\0');
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(&out[i * sizeof(RawReading)], &raw[i], sizeof(RawReading));
+        }
+        report("memcpy (fixed layout)", count, out.size(), seconds(start));
+    }
+
+    // Binary encode into one reused buffer
+    std::string buffer;
+    {
+        buffer.reserve(count * 48);
+        auto start = std::chrono::steady_clock::now();
+        for (const Reading& r : records) CaseRuntime::Serial::encodeTo(buffer, r);
+        report("binary encode", count, buffer.size(), seconds(start));
+        std::printf("    (%.1f bytes/record vs %zu raw)\n",
+                    static_cast<double>(buffer.size()) / count, sizeof(RawReading));
+    }
+
+    // Binary decode, zero-copy views
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::string_view in(buffer);
+        size_t decoded = 0;
+        long long checksum = 0;
+        ReadingView v{};
+        while (!in.empty()) {
+            size_t used = CaseRuntime::Serial::decode(in, v);
+            if (used == 0) break;
+            in.remove_prefix(used);
+            checksum += v.seq + static_cast<long long>(v.sensor.size());
+            ++decoded;
+        }
+        report("binary decode (view)", decoded, buffer.size(), seconds(start));
+        std::printf("    (checksum %lld)\n", checksum);
+    }
+
+    // Binary decode, owning copies
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::string_view in(buffer);
+        size_t decoded = 0;
+        Reading v{};
+        while (!in.empty()) {
+            size_t used = CaseRuntime::Serial::decode(in, v);
+            if (used == 0) break;
+            in.remove_prefix(used);
+            ++decoded;
+        }
+        report("binary decode (owning)", decoded, buffer.size(), seconds(start));
+    }
+
+    // JSON fallback
+    {
+        std::vector<std::string> docs;
+        docs.reserve(count);
+        size_t bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const Reading& r : records) {
+            docs.push_back(CaseRuntime::Serial::toJson(r));
+            bytes += docs.back().size();
+        }
+        report("json encode", count, bytes, seconds(start));
+
+        start = std::chrono::steady_clock::now();
+        size_t decoded = 0;
+        Reading v{};
+        for (const std::string& d : docs) decoded += CaseRuntime::Serial::fromJson(d, v) ? 1 : 0;
+        report("json decode", decoded, bytes, seconds(start));
+    }
+
+    return 0;
+}
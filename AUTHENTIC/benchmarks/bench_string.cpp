@@ -0,0 +1,171 @@
+//=============================================================================
+//  Violet Aura Creations — C.A.S.E. Runtime Benchmark: Strings
+//  Each str_* function against the straightforward std::string version a
+//  generated program would otherwise use (split into owned strings, += joins,
+//  std::string::find, replace by substr appends, per-char toupper,
+//  find_first_not_of trims), on N MB (default 64) of comma-separated log
+//  text. Results of both versions are compared.
+//
+//  Build: g++ -std=c++17 -O2 -I.. bench_string.cpp -o bench_string
+//  Run:   ./bench_string [megabytes]
+//=============================================================================
+
+#include "RuntimeString.hpp"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace CaseRuntime;
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double mbps(size_t bytes, double secs) {
+    return bytes / (1024.0 * 1024.0) / secs;
+}
+
+static std::string makeText(size_t bytes) {
+    static const char* words[] = {
+        "sensor", "reading", "value", "status", "ok", "warning", "pressure", "temperature",
+        "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "request", "handled",
+        "latency", "ms", "cache", "miss", "hit", "thread", "queue", "flush", "buffer", "error"};
+    std::mt19937 rng(42);
+    std::string out;
+    out.reserve(bytes + 64);
+    while (out.size() < bytes) {
+        out += words[rng() % (sizeof(words) / sizeof(words[0]))];
+        out += (rng() % 8 == 0) ? "\n" : ",";
+    }
+    out.resize(bytes);
+    out += "needle-in-haystack";
+    return out;
+}
+
+// --- Naive versions ----------------------------------------------------------
+
+static std::vector<std::string> naiveSplit(const std::string& s, const std::string& delim) {
+    std::vector<std::string> parts;
+    size_t start = 0, at;
+    while ((at = s.find(delim, start)) != std::string::npos) {
+        parts.push_back(s.substr(start, at - start));
+        start = at + delim.size();
+    }
+    parts.push_back(s.substr(start));
+    return parts;
+}
+
+template <typename Parts>
+static std::string naiveJoin(const Parts& parts, const std::string& sep) {
+    std::string out;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (i > 0) out += sep;
+        out += std::string(parts[i]);
+    }
+    return out;
+}
+
+static std::string naiveReplace(const std::string& s, const std::string& from, const std::string& to) {
+    std::string out;
+    size_t start = 0;
+    for (size_t at; (at = s.find(from, start)) != std::string::npos; start = at + from.size()) {
+        out += s.substr(start, at - start);
+        out += to;
+    }
+    out += s.substr(start);
+    return out;
+}
+
+static std::string naiveUpper(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return s;
+}
+
+static std::string naiveTrim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\n\r\v\f");
+    if (b == std::string::npos) return std::string();
+    return s.substr(b, s.find_last_not_of(" \t\n\r\v\f") - b + 1);
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename Fn>
+static double timeIt(int reps, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) fn();
+    return seconds(start) / reps;
+}
+
+static void report(const char* name, size_t bytes, double naive, double runtime, bool ok) {
+    std::printf("  %-8s naive %8.1f MB/s  runtime %8.1f MB/s  %5.1fx  %s\n", name, mbps(bytes, naive),
+                mbps(bytes, runtime), naive / runtime, ok ? "ok" : "MISMATCH");
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const std::string text = makeText(megabytes * 1024 * 1024);
+    const size_t bytes = text.size();
+    bool allOk = true;
+
+    std::printf("C.A.S.E. runtime string benchmark: %zu MB\n", megabytes);
+
+    {
+        std::vector<std::string> a;
+        std::vector<std::string_view> b;
+        double naive = timeIt(3, [&] { a = naiveSplit(text, ","); });
+        double rt = timeIt(3, [&] { b = str_split(text, ","); });
+        bool ok = a.size() == b.size() && a.back() == b.back() && a[a.size() / 2] == b[b.size() / 2];
+        report("split", bytes, naive, rt, ok);
+        allOk &= ok;
+
+        std::string ja, jb;
+        naive = timeIt(3, [&] { ja = naiveJoin(b, ";"); });
+        rt = timeIt(3, [&] { jb = str_join(b, ";"); });
+        report("join", bytes, naive, rt, ja == jb);
+        allOk &= ja == jb;
+    }
+    {
+        size_t a = 0;
+        long long b = 0;
+        double naive = timeIt(5, [&] { a = text.find("needle-in"); });
+        double rt = timeIt(5, [&] { b = str_find(text, "needle-in"); });
+        bool ok = static_cast<long long>(a) == b;
+        report("find", bytes, naive, rt, ok);
+        allOk &= ok;
+    }
+    {
+        std::string a, b;
+        double naive = timeIt(3, [&] { a = naiveReplace(text, "ms,", "milliseconds,"); });
+        double rt = timeIt(3, [&] { b = str_replace(text, "ms,", "milliseconds,"); });
+        report("replace", bytes, naive, rt, a == b);
+        allOk &= a == b;
+    }
+    {
+        std::string a, b;
+        double naive = timeIt(3, [&] { a = naiveUpper(text); });
+        double rt = timeIt(3, [&] { b = str_upper(text); });
+        report("upper", bytes, naive, rt, a == b);
+        allOk &= a == b;
+    }
+    {
+        std::string padded = std::string(4096, ' ') + "x" + std::string(4096, '\t');
+        std::string a, b;
+        double naive = timeIt(20000, [&] { a = naiveTrim(padded); });
+        double rt = timeIt(20000, [&] { b = str_trim(padded); });
+        report("trim", padded.size(), naive, rt, a == b);
+        allOk &= a == b;
+    }
+    {
+        std::string first(40, 'a'), second(40, 'b');
+        std::string a, b;
+        double naive = timeIt(1000000, [&] { a = first + ":" + second + ":" + std::to_string(12345); });
+        double rt = timeIt(1000000, [&] { b = str_concat(first, ":", second, ":", 12345); });
+        report("concat", first.size() + second.size() + 7, naive, rt, a == b);
+        allOk &= a == b;
+    }
+    return allOk ? 0 : 1;
+}
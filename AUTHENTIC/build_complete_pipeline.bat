@@ -1,20 +1,20 @@
 @echo off
 REM CASE Complete Pipeline - Build Test
-REM Tests C++14 compilation with fixes
+REM Tests C++17 compilation with fixes
 
 echo ========================================
 echo CASE Complete Pipeline - Build Test
 echo ========================================
 echo.
 
-echo [INFO] Compiling with C++14 standard...
+echo [INFO] Compiling with C++17 standard...
 echo.
 
 REM Don't include CompletePipeline.hpp as a source file - it's a header
 REM Don't include NativeCompiler.cpp if NativeCompiler.hpp doesn't exist
 
-echo [1/7] Compiling Parser.cpp...
-g++ -std=c++14 -O2 -c Parser.cpp -o Parser.o 2>&1
+echo [1/9] Compiling Parser.cpp...
+g++ -std=c++17 -O2 -c Parser.cpp -o Parser.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] Parser.cpp failed
     exit /b 1
@@ -22,8 +22,8 @@ if %ERRORLEVEL% NEQ 0 (
 echo [OK] Parser.o created
 
 echo.
-echo [2/7] Compiling CodeEmitter.cpp...
-g++ -std=c++14 -O2 -c CodeEmitter.cpp -o CodeEmitter.o 2>&1
+echo [2/9] Compiling CodeEmitter.cpp...
+g++ -std=c++17 -O2 -c CodeEmitter.cpp -o CodeEmitter.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] CodeEmitter.cpp failed
     exit /b 1
@@ -31,8 +31,26 @@ if %ERRORLEVEL% NEQ 0 (
 echo [OK] CodeEmitter.o created
 
 echo.
-echo [3/7] Compiling MachineCodeEmitter.cpp...
-g++ -std=c++14 -O2 -c MachineCodeEmitter.cpp -o MachineCodeEmitter.o 2>&1
+echo [3/9] Compiling TypeInference.cpp...
+g++ -std=c++17 -O2 -c TypeInference.cpp -o TypeInference.o 2>&1
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERROR] TypeInference.cpp failed
+    exit /b 1
+)
+echo [OK] TypeInference.o created
+
+echo.
+echo [4/9] Compiling ProcessRunner.cpp...
+g++ -std=c++17 -O2 -c ProcessRunner.cpp -o ProcessRunner.o 2>&1
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERROR] ProcessRunner.cpp failed
+    exit /b 1
+)
+echo [OK] ProcessRunner.o created
+
+echo.
+echo [5/9] Compiling MachineCodeEmitter.cpp...
+g++ -std=c++17 -O2 -c MachineCodeEmitter.cpp -o MachineCodeEmitter.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] MachineCodeEmitter.cpp failed
     exit /b 1
@@ -40,8 +58,8 @@ if %ERRORLEVEL% NEQ 0 (
 echo [OK] MachineCodeEmitter.o created
 
 echo.
-echo [4/7] Compiling CIAMCompiler.cpp...
-g++ -std=c++14 -O2 -c CIAMCompiler.cpp -o CIAMCompiler.o 2>&1
+echo [6/9] Compiling CIAMCompiler.cpp...
+g++ -std=c++17 -O2 -c CIAMCompiler.cpp -o CIAMCompiler.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] CIAMCompiler.cpp failed
     exit /b 1
@@ -49,8 +67,8 @@ if %ERRORLEVEL% NEQ 0 (
 echo [OK] CIAMCompiler.o created
 
 echo.
-echo [5/7] Compiling OptimizationEngine.cpp...
-g++ -std=c++14 -O2 -c OptimizationEngine.cpp -o OptimizationEngine.o 2>&1
+echo [7/9] Compiling OptimizationEngine.cpp...
+g++ -std=c++17 -O2 -c OptimizationEngine.cpp -o OptimizationEngine.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] OptimizationEngine.cpp failed
     exit /b 1
@@ -58,8 +76,8 @@ if %ERRORLEVEL% NEQ 0 (
 echo [OK] OptimizationEngine.o created
 
 echo.
-echo [6/7] Compiling intelligence.cpp...
-g++ -std=c++14 -O2 -c intelligence.cpp -o intelligence.o 2>&1
+echo [8/9] Compiling intelligence.cpp...
+g++ -std=c++17 -O2 -c intelligence.cpp -o intelligence.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] intelligence.cpp failed
     exit /b 1
@@ -67,8 +85,8 @@ if %ERRORLEVEL% NEQ 0 (
 echo [OK] intelligence.o created
 
 echo.
-echo [7/7] Compiling ActiveTranspiler_Modular.cpp...
-g++ -std=c++14 -O2 -c ActiveTranspiler_Modular.cpp -o ActiveTranspiler_Modular.o 2>&1
+echo [9/9] Compiling ActiveTranspiler_Modular.cpp...
+g++ -std=c++17 -O2 -c ActiveTranspiler_Modular.cpp -o ActiveTranspiler_Modular.o 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] ActiveTranspiler_Modular.cpp failed
     exit /b 1
@@ -79,7 +97,7 @@ echo.
 echo ========================================
 echo Linking executable...
 echo ========================================
-g++ -std=c++14 -O2 Parser.o CodeEmitter.o MachineCodeEmitter.o CIAMCompiler.o OptimizationEngine.o intelligence.o ActiveTranspiler_Modular.o -o case_complete.exe 2>&1
+g++ -std=c++17 -O2 Parser.o CodeEmitter.o TypeInference.o ProcessRunner.o MachineCodeEmitter.o CIAMCompiler.o OptimizationEngine.o intelligence.o ActiveTranspiler_Modular.o -o case_complete.exe 2>&1
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] Linking failed
     exit /b 1
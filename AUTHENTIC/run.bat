@@ -6,6 +6,7 @@ REM ============================================================================
 setlocal enabledelayedexpansion
 
 set TRANSPILER=transpiler.exe
+if "%CASE_RUNTIME_DIR%"=="" set CASE_RUNTIME_DIR=%~dp0.
 set INPUT_FILE=%1
 set COMPILER=clang++
 set STD=c++17
@@ -98,7 +99,7 @@ if %VERBOSE%==1 (
     echo [Step 2] Compiling C++ to native code...
 )
 
-%COMPILER% -std=%STD% -%OPT% compiler.cpp -o %OUTPUT% 2> compile_errors.txt
+%COMPILER% -std=%STD% -%OPT% -I"%CASE_RUNTIME_DIR%" compiler.cpp -o %OUTPUT% 2> compile_errors.txt
 if errorlevel 1 (
     echo.
     echo [Error] C++ compilation failed!
@@ -4,6 +4,7 @@
 # ============================================================================
 
 TRANSPILER="./transpiler"
+RUNTIME_DIR="${CASE_RUNTIME_DIR:-$(cd "$(dirname "$0")" && pwd)}"
 COMPILER="clang++"
 STD="c++17"
 OPT="O2"
@@ -122,7 +123,7 @@ if [ $VERBOSE -eq 1 ]; then
     echo -e "${CYAN}[Step 2]${NC} Compiling C++ to native code..."
 fi
 
-$COMPILER -std=$STD -$OPT compiler.cpp -o $OUTPUT 2> compile_errors.txt
+$COMPILER -std=$STD -$OPT -I"$RUNTIME_DIR" compiler.cpp -o $OUTPUT 2> compile_errors.txt
 if [ $? -ne 0 ]; then
     echo ""
     echo -e "${RED}[Error]${NC} C++ compilation failed!"
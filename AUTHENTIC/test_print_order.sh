@@ -0,0 +1,24 @@
+#!/bin/bash
+# ============================================================================
+# C.A.S.E. Transpiler - Print order test
+# Builds test_print_order.case and runs it with stdout piped, where Print
+# output is buffered per thread, then checks the lines kept program order.
+# Usage: ./test_print_order.sh [compiler]   (default: clang++)
+# ============================================================================
+
+cd "$(dirname "$0")" || exit 1
+COMPILER="${1:-clang++}"
+
+./transpiler test_print_order.case --emit-only > /dev/null || exit 1
+$COMPILER -std=c++17 -O2 -I. compiler.cpp -o test_print_order -pthread || exit 1
+
+expected=$( { echo "first"; echo "worker 1"; seq 1 20000; echo "worker 2"; echo "last"; } )
+actual=$(./test_print_order | cat)
+
+if [ "$actual" == "$expected" ]; then
+    echo "PASS: Print order kept through a pipe"
+    exit 0
+fi
+echo "FAIL: Print order lost through a pipe"
+diff <(echo "$expected") <(echo "$actual") | head -20
+exit 1